@@ -0,0 +1,410 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "ax_algorithm_sdk.h"
+
+/**
+ * 按句柄统计 SDK 调用性能：
+ * 用 algorithm_stats::track/detect/get_body_attr/get_face_feature 代替对应的 SDK 接口，
+ * 统计每类调用的次数、耗时、每帧目标数，以及按 ax_error_code_e 分类的失败次数。
+ * 这里不加锁，也不串行化调用；多个线程共用一个句柄时由调用方串行化(例如 param_snapshot::bound_handle)，
+ * 调用方通过 add_queue_wait 上报等待句柄锁的时间。
+ * 每个线程缓存句柄到统计对象的映射，只在第一次遇到某个句柄或 remove_stats 之后查一次全局表；计数全部为原子操作，可以常开。
+ */
+namespace algorithm_stats
+{
+    typedef enum _stage_e
+    {
+        stage_detect = 0,
+        stage_track,
+        stage_body_attr,
+        stage_face_feature,
+        stage_queue_wait, // 调用方等待句柄锁的时间，由 add_queue_wait 上报，每次上报计一次
+        stage_end
+    } stage_e;
+
+    enum
+    {
+        // -1, 0x10000 ~ 0x10003, 0x20000 ~ 0x20009, 其他
+        n_error_slots = 16,
+    };
+
+    typedef struct _stage_stats_t
+    {
+        unsigned long long calls;
+        double total_ms;
+        double max_ms;
+    } stage_stats_t;
+
+    typedef struct _count_stats_t
+    {
+        unsigned long long frames;  // 成功的 track/detect 调用次数
+        unsigned long long objects;
+        unsigned long long failures[n_error_slots];
+    } count_stats_t;
+
+    typedef struct _stats_t
+    {
+        /**
+         * total: reset 以来的累计值
+         * window: 上一次 get_stats 以来的值
+         */
+        stage_stats_t total[stage_end];
+        stage_stats_t window[stage_end];
+        count_stats_t total_counts;
+        count_stats_t window_counts;
+    } stats_t;
+
+    static inline int error_slot(int code)
+    {
+        if (code == ax_error_code_fail)
+        {
+            return 0;
+        }
+        if (code >= ax_error_code_init_fail && code <= ax_error_code_init_model_fail)
+        {
+            return 1 + code - ax_error_code_init_fail;
+        }
+        if (code >= ax_error_code_run_fail && code <= ax_error_code_run_no_implement)
+        {
+            return 5 + code - ax_error_code_run_fail;
+        }
+        return n_error_slots - 1;
+    }
+
+    static inline int slot_error_code(int slot)
+    {
+        if (slot == 0)
+        {
+            return ax_error_code_fail;
+        }
+        if (slot < 5)
+        {
+            return ax_error_code_init_fail + slot - 1;
+        }
+        if (slot < n_error_slots - 1)
+        {
+            return ax_error_code_run_fail + slot - 5;
+        }
+        return ax_error_code_fail;
+    }
+
+    namespace detail
+    {
+        struct counter_t
+        {
+            std::atomic<unsigned long long> calls{0};
+            std::atomic<unsigned long long> ns{0};
+            std::atomic<unsigned long long> max_ns{0};
+
+            void add(unsigned long long v)
+            {
+                calls.fetch_add(1, std::memory_order_relaxed);
+                ns.fetch_add(v, std::memory_order_relaxed);
+                unsigned long long cur = max_ns.load(std::memory_order_relaxed);
+                while (v > cur && !max_ns.compare_exchange_weak(cur, v, std::memory_order_relaxed))
+                {
+                }
+            }
+
+            // 把计数转移到 dst，本计数清零
+            void move_to(counter_t &dst)
+            {
+                dst.calls.fetch_add(calls.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+                dst.ns.fetch_add(ns.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+                unsigned long long v = max_ns.exchange(0, std::memory_order_relaxed);
+                unsigned long long cur = dst.max_ns.load(std::memory_order_relaxed);
+                while (v > cur && !dst.max_ns.compare_exchange_weak(cur, v, std::memory_order_relaxed))
+                {
+                }
+            }
+
+            stage_stats_t take()
+            {
+                stage_stats_t s;
+                s.calls = calls.exchange(0, std::memory_order_relaxed);
+                s.total_ms = ns.exchange(0, std::memory_order_relaxed) / 1e6;
+                s.max_ms = max_ns.exchange(0, std::memory_order_relaxed) / 1e6;
+                return s;
+            }
+        };
+
+        struct handle_stats_t
+        {
+            counter_t window[stage_end];
+            std::atomic<unsigned long long> frames{0};
+            std::atomic<unsigned long long> objects{0};
+            std::atomic<unsigned long long> failures[n_error_slots];
+
+            // get_stats 把窗口累加到这里
+            std::mutex total_mutex;
+            stage_stats_t total[stage_end];
+            count_stats_t total_counts;
+
+            handle_stats_t()
+            {
+                for (auto &f : failures)
+                {
+                    f.store(0);
+                }
+                memset(total, 0, sizeof(total));
+                memset(&total_counts, 0, sizeof(total_counts));
+            }
+
+            count_stats_t take_counts()
+            {
+                count_stats_t c;
+                c.frames = frames.exchange(0, std::memory_order_relaxed);
+                c.objects = objects.exchange(0, std::memory_order_relaxed);
+                for (int i = 0; i < n_error_slots; i++)
+                {
+                    c.failures[i] = failures[i].exchange(0, std::memory_order_relaxed);
+                }
+                return c;
+            }
+        };
+
+        static std::mutex g_registry_mutex;
+        static std::unordered_map<ax_algorithm_handle_t, std::shared_ptr<handle_stats_t>> g_registry;
+        // remove_stats 时加一，各线程据此丢弃缓存
+        static std::atomic<unsigned int> g_registry_generation{0};
+
+        static handle_stats_t &get(ax_algorithm_handle_t handle)
+        {
+            // 缓存持有 shared_ptr，remove_stats 与其他线程的调用并发时对象不会提前释放
+            struct cache_t
+            {
+                unsigned int generation = 0;
+                std::unordered_map<ax_algorithm_handle_t, std::shared_ptr<handle_stats_t>> map;
+            };
+            thread_local cache_t cache;
+            unsigned int generation = g_registry_generation.load(std::memory_order_acquire);
+            if (generation != cache.generation)
+            {
+                cache.map.clear();
+                cache.generation = generation;
+            }
+            auto it = cache.map.find(handle);
+            if (it != cache.map.end())
+            {
+                return *it->second;
+            }
+
+            std::lock_guard<std::mutex> lock(g_registry_mutex);
+            auto &p = g_registry[handle];
+            if (!p)
+            {
+                p = std::make_shared<handle_stats_t>();
+            }
+            cache.map[handle] = p;
+            return *p;
+        }
+
+        static inline unsigned long long now_ns()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        template <typename F>
+        static int call(ax_algorithm_handle_t handle, stage_e stage, const ax_result_t *result, F fn)
+        {
+            handle_stats_t &hs = get(handle);
+            unsigned long long t0 = now_ns();
+            int ret = fn();
+            unsigned long long t1 = now_ns();
+
+            hs.window[stage].add(t1 - t0);
+            if (ret != ax_error_code_success)
+            {
+                hs.failures[error_slot(ret)].fetch_add(1, std::memory_order_relaxed);
+            }
+            else if (result != nullptr)
+            {
+                hs.frames.fetch_add(1, std::memory_order_relaxed);
+                hs.objects.fetch_add(result->n_objects, std::memory_order_relaxed);
+            }
+            return ret;
+        }
+    }
+
+    static int detect(ax_algorithm_handle_t handle, ax_image_t *image, ax_result_t *result)
+    {
+        return detail::call(handle, stage_detect, result, [&]()
+                            { return ax_algorithm_detect(handle, image, result); });
+    }
+
+    static int track(ax_algorithm_handle_t handle, ax_image_t *image, ax_result_t *result)
+    {
+        return detail::call(handle, stage_track, result, [&]()
+                            { return ax_algorithm_track(handle, image, result); });
+    }
+
+    static int get_body_attr(ax_algorithm_handle_t handle, ax_image_t *image, ax_bbox_t *bbox, ax_body_attr_t *body_attr)
+    {
+        return detail::call(handle, stage_body_attr, nullptr, [&]()
+                            { return ax_algorithm_get_body_attr(handle, image, bbox, body_attr); });
+    }
+
+    static int get_face_feature(ax_algorithm_handle_t handle, ax_image_t *image, ax_result_t *result, int idx, float feature[AX_ALGORITHM_FACE_FEATURE_LEN])
+    {
+        return detail::call(handle, stage_face_feature, nullptr, [&]()
+                            { return ax_algorithm_get_face_feature(handle, image, result, idx, feature); });
+    }
+
+    /**
+     * @brief: 上报一次等待句柄锁的时间，由串行化同一句柄调用的封装在拿到锁后调用
+     * @param[in] handle: 算法句柄
+     * @param[in] wait_ns: 等待时间(纳秒)
+     */
+    static void add_queue_wait(ax_algorithm_handle_t handle, unsigned long long wait_ns)
+    {
+        detail::get(handle).window[stage_queue_wait].add(wait_ns);
+    }
+
+    /**
+     * @brief: 获取句柄的统计信息，同时开始新的统计窗口
+     * @param[in] handle: 算法句柄
+     * @param[out] stats: 统计信息
+     */
+    static void get_stats(ax_algorithm_handle_t handle, stats_t *stats)
+    {
+        detail::handle_stats_t &hs = detail::get(handle);
+        std::lock_guard<std::mutex> lock(hs.total_mutex);
+        for (int s = 0; s < stage_end; s++)
+        {
+            stage_stats_t w = hs.window[s].take();
+            stage_stats_t &t = hs.total[s];
+            t.calls += w.calls;
+            t.total_ms += w.total_ms;
+            t.max_ms = w.max_ms > t.max_ms ? w.max_ms : t.max_ms;
+            stats->window[s] = w;
+            stats->total[s] = t;
+        }
+        count_stats_t w = hs.take_counts();
+        count_stats_t &t = hs.total_counts;
+        t.frames += w.frames;
+        t.objects += w.objects;
+        for (int i = 0; i < n_error_slots; i++)
+        {
+            t.failures[i] += w.failures[i];
+        }
+        stats->window_counts = w;
+        stats->total_counts = t;
+    }
+
+    /**
+     * @brief: 清零句柄的统计信息
+     */
+    static void reset_stats(ax_algorithm_handle_t handle)
+    {
+        detail::handle_stats_t &hs = detail::get(handle);
+        std::lock_guard<std::mutex> lock(hs.total_mutex);
+        for (int s = 0; s < stage_end; s++)
+        {
+            hs.window[s].take();
+        }
+        hs.take_counts();
+        memset(hs.total, 0, sizeof(hs.total));
+        memset(&hs.total_counts, 0, sizeof(hs.total_counts));
+    }
+
+    /**
+     * @brief: 句柄释放(ax_algorithm_deinit)后调用，删除其统计信息
+     */
+    static void remove_stats(ax_algorithm_handle_t handle)
+    {
+        std::lock_guard<std::mutex> lock(detail::g_registry_mutex);
+        detail::g_registry.erase(handle);
+        detail::g_registry_generation.fetch_add(1, std::memory_order_release);
+    }
+
+    /**
+     * @brief: 把 from 的统计并入 to 并删除 from，句柄被替换(例如 hot_reload 切换)后调用，统计不会清零
+     * @param[in] from: 被替换的句柄，之后不能再有调用
+     * @param[in] to: 新句柄
+     */
+    static void move_stats(ax_algorithm_handle_t from, ax_algorithm_handle_t to)
+    {
+        if (from == to)
+        {
+            return;
+        }
+        detail::handle_stats_t &src = detail::get(from);
+        detail::handle_stats_t &dst = detail::get(to);
+        for (int s = 0; s < stage_end; s++)
+        {
+            src.window[s].move_to(dst.window[s]);
+        }
+        count_stats_t w = src.take_counts();
+        dst.frames.fetch_add(w.frames, std::memory_order_relaxed);
+        dst.objects.fetch_add(w.objects, std::memory_order_relaxed);
+        for (int i = 0; i < n_error_slots; i++)
+        {
+            dst.failures[i].fetch_add(w.failures[i], std::memory_order_relaxed);
+        }
+
+        stage_stats_t total[stage_end];
+        count_stats_t total_counts;
+        {
+            std::lock_guard<std::mutex> lock(src.total_mutex);
+            memcpy(total, src.total, sizeof(total));
+            total_counts = src.total_counts;
+        }
+        {
+            std::lock_guard<std::mutex> lock(dst.total_mutex);
+            for (int s = 0; s < stage_end; s++)
+            {
+                stage_stats_t &t = dst.total[s];
+                t.calls += total[s].calls;
+                t.total_ms += total[s].total_ms;
+                t.max_ms = total[s].max_ms > t.max_ms ? total[s].max_ms : t.max_ms;
+            }
+            dst.total_counts.frames += total_counts.frames;
+            dst.total_counts.objects += total_counts.objects;
+            for (int i = 0; i < n_error_slots; i++)
+            {
+                dst.total_counts.failures[i] += total_counts.failures[i];
+            }
+        }
+        remove_stats(from);
+    }
+
+    static void print_stats(const stats_t &stats)
+    {
+        static const char *names[stage_end] = {"detect", "track", "body_attr", "face_feature", "queue_wait"};
+        for (int s = 0; s < stage_end; s++)
+        {
+            const stage_stats_t &t = stats.total[s];
+            const stage_stats_t &w = stats.window[s];
+            if (t.calls == 0)
+            {
+                continue;
+            }
+            printf("%-12s total: %8llu calls avg %7.2f ms max %7.2f ms | window: %6llu calls avg %7.2f ms max %7.2f ms\n",
+                   names[s], t.calls, t.total_ms / t.calls, t.max_ms,
+                   w.calls, w.calls ? w.total_ms / w.calls : 0, w.max_ms);
+        }
+        const count_stats_t &t = stats.total_counts;
+        const count_stats_t &w = stats.window_counts;
+        printf("frames       total: %8llu objects/frame %5.2f | window: %6llu objects/frame %5.2f\n",
+               t.frames, t.frames ? (double)t.objects / t.frames : 0,
+               w.frames, w.frames ? (double)w.objects / w.frames : 0);
+        for (int i = 0; i < n_error_slots; i++)
+        {
+            if (t.failures[i] && i == n_error_slots - 1)
+            {
+                printf("error other: %llu (window %llu)\n", t.failures[i], w.failures[i]);
+            }
+            else if (t.failures[i])
+            {
+                printf("error 0x%x: %llu (window %llu)\n", slot_error_code(i), t.failures[i], w.failures[i]);
+            }
+        }
+    }
+}
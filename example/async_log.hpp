@@ -0,0 +1,832 @@
+#pragma once
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "ax_algorithm_sdk.h"
+
+/**
+ * 异步日志：
+ * - ASYNC_LOG(level, fmt, ...) 只把格式串指针和原始参数(字符串复制)写入本线程的无锁单生产者环形缓冲区，
+ *   格式化推迟到后台线程；缓冲区满时丢弃并计数，记录线程不会阻塞
+ * - ASYNC_LOG_RATE(level, per_sec, fmt, ...) 按调用点限速，每秒最多 per_sec 条，被抑制的条数附在下一条输出上
+ * - 后台线程把记录格式化为文本输出、写二进制文件(async_log::decode 还原为文本)，或交给 hook
+ *   (收到未格式化的 record_t，需要时自己调用 async_log::format)
+ * 未调用 async_log::start 时同步格式化输出到 stdout，与 printf 行为一致。
+ * SDK 内部日志没有回调接口，无法接入这里；set_level 同时设置 ax_algorithm_set_log_level。
+ */
+namespace async_log
+{
+    enum
+    {
+        max_args = 32,
+        max_record_bytes = 2048, // 超出的字符串参数被截断
+    };
+
+    // 参数类型：i 有符号整数，u 无符号整数，d 浮点，s 字符串，p 指针
+    typedef union _arg_t
+    {
+        long long i;
+        unsigned long long u;
+        double d;
+        const char *s;
+        const void *p;
+    } arg_t;
+
+    // 解码后的一条记录，hook 中只在回调期间有效
+    typedef struct _record_t
+    {
+        int level;
+        const char *file;
+        int line;
+        const char *fmt;
+        long long ts_us; // 系统时间
+        int tid;
+        unsigned int suppressed; // 本条之前被限速抑制的条数
+        int n_args;
+        char types[max_args];
+        arg_t args[max_args];
+    } record_t;
+
+    typedef std::function<void(const record_t &)> hook_t;
+
+    typedef struct _options_t
+    {
+        /**
+         * text: 文本输出，为空时不输出文本
+         * prefix: 文本前加时间、级别、调用点和线程号
+         * binary_path: 非空时写二进制记录
+         * hook: 非空时每条记录调用一次，运行在后台线程
+         * flush_ms: 后台线程的周期
+         */
+        FILE *text;
+        bool prefix;
+        std::string binary_path;
+        hook_t hook;
+        int flush_ms;
+    } options_t;
+
+    static options_t get_default_options()
+    {
+        options_t options;
+        options.text = stdout;
+        options.prefix = false;
+        options.flush_ms = 50;
+        return options;
+    }
+
+    // 调用点，由 ASYNC_LOG 宏静态创建
+    struct site_t
+    {
+        site_t(int level, const char *file, int line, const char *fmt, int per_sec)
+            : level(level), file(file), line(line), fmt(fmt), per_sec(per_sec) {}
+
+        int level;
+        const char *file;
+        int line;
+        const char *fmt;
+        int per_sec; // <= 0 不限速
+        std::atomic<long long> window_ms{0};
+        std::atomic<int> window_count{0};
+        std::atomic<unsigned int> suppressed{0};
+        int id = -1; // 二进制文件中的编号，只由后台线程使用
+    };
+
+    namespace detail
+    {
+        enum
+        {
+            ring_size = 1 << 18,
+            magic_size = 8,
+        };
+        static const char magic[magic_size] = {'A', 'X', 'A', 'L', 'O', 'G', 0, 0};
+
+        static inline long long wall_us()
+        {
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+
+        static inline long long steady_ms()
+        {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        // 环形缓冲区中一条记录的头部，之后是 types[n_args](补齐到 8 字节)、args[n_args] 和字符串
+        struct header_t
+        {
+            unsigned int size;
+            unsigned int suppressed;
+            const site_t *site;
+            long long ts_us;
+            int n_args;
+        };
+
+        static inline size_t args_offset(int n_args)
+        {
+            return sizeof(header_t) + ((n_args + 7) & ~7);
+        }
+
+        // 把参数按类型打包到 buf，字符串复制到尾部，args 中记录相对偏移
+        struct packer_t
+        {
+            packer_t(char *buf, int capacity)
+                : buf(buf), strings(args_offset(capacity) + sizeof(arg_t) * capacity), capacity(capacity),
+                  types(buf + sizeof(header_t)), args((arg_t *)(buf + args_offset(capacity))) {}
+
+            char *buf;
+            size_t strings; // 字符串区的写入位置
+            int n_args = 0;
+            int capacity;
+            char *types;
+            arg_t *args;
+
+            void put(char type, arg_t arg)
+            {
+                if (n_args < capacity)
+                {
+                    types[n_args] = type;
+                    args[n_args++] = arg;
+                }
+            }
+
+            void put_str(const char *s)
+            {
+                if (n_args >= capacity)
+                {
+                    return;
+                }
+                arg_t a;
+                if (strings >= max_record_bytes)
+                {
+                    // 没有空间，指向上一个字符串的结尾，输出空串
+                    a.u = max_record_bytes - 1;
+                    put('s', a);
+                    return;
+                }
+                size_t len = s ? strlen(s) : 6;
+                size_t room = max_record_bytes - strings - 1;
+                len = len < room ? len : room;
+                memcpy(buf + strings, s ? s : "(null)", len);
+                buf[strings + len] = 0;
+                a.u = strings;
+                strings += len + 1;
+                put('s', a);
+            }
+
+            template <typename T>
+            typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type add(T v)
+            {
+                arg_t a;
+                a.i = v;
+                put('i', a);
+            }
+            template <typename T>
+            typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type add(T v)
+            {
+                arg_t a;
+                a.u = v;
+                put('u', a);
+            }
+            template <typename T>
+            typename std::enable_if<std::is_floating_point<T>::value>::type add(T v)
+            {
+                arg_t a;
+                a.d = v;
+                put('d', a);
+            }
+            template <typename T>
+            typename std::enable_if<std::is_enum<T>::value>::type add(T v)
+            {
+                add((long long)v);
+            }
+            void add(const char *s) { put_str(s); }
+            void add(char *s) { put_str(s); }
+            void add(const std::string &s) { put_str(s.c_str()); }
+            void add(const void *p)
+            {
+                arg_t a;
+                a.p = p;
+                put('p', a);
+            }
+
+            void pack() {}
+            template <typename T, typename... Rest>
+            void pack(const T &v, const Rest &...rest)
+            {
+                add(v);
+                pack(rest...);
+            }
+        };
+
+        struct ring_t
+        {
+            ring_t() : tid((int)syscall(SYS_gettid)), head(0), tail(0), dropped(0) {}
+
+            // 返回写入后已用的字节数，缓冲区满时返回 0
+            unsigned int push(const char *data, unsigned int size)
+            {
+                unsigned int h = head.load(std::memory_order_relaxed);
+                if (ring_size - (h - tail.load(std::memory_order_acquire)) < size)
+                {
+                    dropped.fetch_add(1, std::memory_order_relaxed);
+                    return 0;
+                }
+                copy_in(h, data, size);
+                head.store(h + size, std::memory_order_release);
+                return h + size - tail.load(std::memory_order_relaxed);
+            }
+
+            // fn(const char *data) 的 data 只在回调期间有效
+            template <typename F>
+            void drain(F fn)
+            {
+                unsigned int t = tail.load(std::memory_order_relaxed);
+                unsigned int h = head.load(std::memory_order_acquire);
+                alignas(8) char buf[max_record_bytes];
+                while (t != h)
+                {
+                    unsigned int size;
+                    copy_out(t, (char *)&size, sizeof(size));
+                    copy_out(t, buf, size);
+                    fn(buf);
+                    t += size;
+                }
+                tail.store(t, std::memory_order_release);
+            }
+
+            void copy_in(unsigned int pos, const char *data, unsigned int size)
+            {
+                unsigned int off = pos & (ring_size - 1);
+                unsigned int first = size < ring_size - off ? size : ring_size - off;
+                memcpy(bytes + off, data, first);
+                memcpy(bytes, data + first, size - first);
+            }
+
+            void copy_out(unsigned int pos, char *data, unsigned int size)
+            {
+                unsigned int off = pos & (ring_size - 1);
+                unsigned int first = size < ring_size - off ? size : ring_size - off;
+                memcpy(data, bytes + off, first);
+                memcpy(data + first, bytes, size - first);
+            }
+
+            int tid;
+            std::atomic<unsigned int> head;
+            std::atomic<unsigned int> tail;
+            std::atomic<unsigned long long> dropped;
+            char bytes[ring_size];
+        };
+
+        // 解析打包后的字节为 record_t，字符串参数指回 data
+        static void unpack(const char *data, int tid, record_t *r)
+        {
+            header_t hdr;
+            memcpy(&hdr, data, sizeof(hdr));
+            r->level = hdr.site->level;
+            r->file = hdr.site->file;
+            r->line = hdr.site->line;
+            r->fmt = hdr.site->fmt;
+            r->ts_us = hdr.ts_us;
+            r->tid = tid;
+            r->suppressed = hdr.suppressed;
+            r->n_args = hdr.n_args;
+            memcpy(r->types, data + sizeof(hdr), hdr.n_args);
+            memcpy(r->args, data + args_offset(hdr.n_args), hdr.n_args * sizeof(arg_t));
+            for (int i = 0; i < r->n_args; i++)
+            {
+                if (r->types[i] == 's')
+                {
+                    r->args[i].s = data + r->args[i].u;
+                }
+            }
+        }
+
+        struct logger_t
+        {
+            std::atomic<bool> enabled{false};
+            std::atomic<int> level{ax_log_all};
+            std::mutex mutex; // 保护 rings 和输出
+            std::vector<std::shared_ptr<ring_t>> rings;
+            options_t options = get_default_options();
+            FILE *bin = nullptr;
+            std::vector<site_t *> bin_sites;
+            std::thread flusher;
+            std::mutex wake_mutex;
+            std::condition_variable wake;
+            std::atomic<bool> wake_pending{false}; // 某个缓冲区超过一半时提前唤醒后台线程，每轮只唤醒一次
+            bool stop = false;
+
+            // 没有调用 async_log::stop 就退出时写出剩余记录
+            ~logger_t()
+            {
+                if (!flusher.joinable())
+                {
+                    return;
+                }
+                {
+                    std::lock_guard<std::mutex> wake_lock(wake_mutex);
+                    stop = true;
+                }
+                wake.notify_all();
+                flusher.join();
+                std::lock_guard<std::mutex> lock(mutex);
+                enabled.store(false);
+                flush_locked();
+                if (bin != nullptr)
+                {
+                    fclose(bin);
+                }
+            }
+
+            void flush_locked();
+        };
+
+        static logger_t &logger()
+        {
+            static logger_t l;
+            return l;
+        }
+
+        static ring_t *local_ring()
+        {
+            thread_local std::shared_ptr<ring_t> ring;
+            if (!ring)
+            {
+                ring = std::make_shared<ring_t>();
+                logger_t &l = logger();
+                std::lock_guard<std::mutex> lock(l.mutex);
+                l.rings.push_back(ring);
+            }
+            return ring.get();
+        }
+    }
+
+    static const char *level_name(int level)
+    {
+        static const char *names[] = {"EMERG", "ALERT", "CRIT", "ERROR", "WARN", "NOTICE", "INFO", "DEBUG"};
+        return level >= 0 && level < 8 ? names[level] : "LOG";
+    }
+
+    /**
+     * @brief: 按 fmt 格式化记录的参数；参数按记录的实际类型输出，忽略 fmt 中的长度修饰符
+     * @param[in] prefix: 前面加时间、级别、调用点和线程号
+     */
+    static void format(const record_t &r, std::string &out, bool prefix = false)
+    {
+        out.clear();
+        char buf[512];
+        if (prefix)
+        {
+            time_t sec = r.ts_us / 1000000;
+            struct tm tm;
+            localtime_r(&sec, &tm);
+            const char *file = strrchr(r.file, '/');
+            snprintf(buf, sizeof(buf), "%02d:%02d:%02d.%06lld %-6s %s:%d [%d] ", tm.tm_hour, tm.tm_min, tm.tm_sec,
+                     r.ts_us % 1000000, level_name(r.level), file ? file + 1 : r.file, r.line, r.tid);
+            out += buf;
+        }
+
+        int arg = 0;
+        for (const char *p = r.fmt; *p;)
+        {
+            if (*p != '%')
+            {
+                const char *q = strchr(p, '%');
+                size_t n = q ? q - p : strlen(p);
+                out.append(p, n);
+                p += n;
+                continue;
+            }
+            if (p[1] == '%')
+            {
+                out += '%';
+                p += 2;
+                continue;
+            }
+            // 标志、宽度、精度
+            char spec[32] = "%";
+            size_t n = 1;
+            const char *q = p + 1;
+            while (*q && strchr("-+ #0123456789.", *q) && n < sizeof(spec) - 4)
+            {
+                spec[n++] = *q++;
+            }
+            while (*q && strchr("hlLqjzt", *q))
+            {
+                q++;
+            }
+            char conv = *q;
+            if (conv == 0)
+            {
+                out.append(p);
+                break;
+            }
+            p = q + 1;
+            if (arg >= r.n_args)
+            {
+                out += "(missing)";
+                continue;
+            }
+            char type = r.types[arg];
+            const arg_t &a = r.args[arg++];
+            if (strchr("diouxXc", conv))
+            {
+                if (conv == 'c')
+                {
+                    spec[n++] = 'c';
+                    spec[n] = 0;
+                    snprintf(buf, sizeof(buf), spec, (int)(type == 'd' ? (long long)a.d : a.i));
+                }
+                else
+                {
+                    spec[n++] = 'l';
+                    spec[n++] = 'l';
+                    spec[n++] = conv;
+                    spec[n] = 0;
+                    snprintf(buf, sizeof(buf), spec, type == 'd' ? (long long)a.d : a.i);
+                }
+            }
+            else if (strchr("eEfFgGaA", conv))
+            {
+                spec[n++] = conv;
+                spec[n] = 0;
+                snprintf(buf, sizeof(buf), spec, type == 'd' ? a.d : type == 'u' ? (double)a.u : (double)a.i);
+            }
+            else if (conv == 's')
+            {
+                spec[n++] = 's';
+                spec[n] = 0;
+                if (type == 's')
+                {
+                    // 宽度、精度交给 snprintf，长字符串直接追加
+                    if (n == 2)
+                    {
+                        out += a.s;
+                        continue;
+                    }
+                    snprintf(buf, sizeof(buf), spec, a.s);
+                }
+                else
+                {
+                    snprintf(buf, sizeof(buf), "%lld", a.i);
+                }
+            }
+            else
+            {
+                snprintf(buf, sizeof(buf), "%p", a.p);
+            }
+            out += buf;
+        }
+        if (r.suppressed > 0)
+        {
+            snprintf(buf, sizeof(buf), " [%u suppressed]", r.suppressed);
+            // 保持行尾的换行
+            if (!out.empty() && out.back() == '\n')
+            {
+                out.insert(out.size() - 1, buf);
+            }
+            else
+            {
+                out += buf;
+            }
+        }
+    }
+
+    namespace detail
+    {
+        static void write_binary(FILE *fp, std::vector<site_t *> &sites, const char *data, int tid)
+        {
+            header_t hdr;
+            memcpy(&hdr, data, sizeof(hdr));
+            site_t *site = const_cast<site_t *>(hdr.site);
+            if (site->id < 0)
+            {
+                site->id = sites.size();
+                sites.push_back(site);
+                unsigned char kind = 1;
+                unsigned short file_len = strlen(site->file), fmt_len = strlen(site->fmt);
+                fwrite(&kind, 1, 1, fp);
+                fwrite(&site->id, sizeof(int), 1, fp);
+                fwrite(&site->level, sizeof(int), 1, fp);
+                fwrite(&site->line, sizeof(int), 1, fp);
+                fwrite(&file_len, sizeof(file_len), 1, fp);
+                fwrite(site->file, 1, file_len, fp);
+                fwrite(&fmt_len, sizeof(fmt_len), 1, fp);
+                fwrite(site->fmt, 1, fmt_len, fp);
+            }
+            unsigned char kind = 2;
+            fwrite(&kind, 1, 1, fp);
+            fwrite(&site->id, sizeof(int), 1, fp);
+            fwrite(&tid, sizeof(int), 1, fp);
+            // 记录本身与指针无关：site 换成编号，字符串是相对偏移
+            fwrite(data, 1, hdr.size, fp);
+        }
+
+        inline void logger_t::flush_locked()
+        {
+            record_t r;
+            std::string text;
+            for (auto &ring : rings)
+            {
+                ring->drain([&](const char *data)
+                            {
+                    if (bin != nullptr)
+                    {
+                        write_binary(bin, bin_sites, data, ring->tid);
+                    }
+                    if (options.text == nullptr && !options.hook)
+                    {
+                        return;
+                    }
+                    unpack(data, ring->tid, &r);
+                    if (options.hook)
+                    {
+                        options.hook(r);
+                    }
+                    if (options.text != nullptr)
+                    {
+                        format(r, text, options.prefix);
+                        fwrite(text.data(), 1, text.size(), options.text);
+                    } });
+            }
+            if (options.text != nullptr)
+            {
+                fflush(options.text);
+            }
+            if (bin != nullptr)
+            {
+                fflush(bin);
+            }
+        }
+    }
+
+    /**
+     * @brief: 设置输出级别，同时设置 SDK 的日志级别
+     */
+    static void set_level(ax_log_level_e level)
+    {
+        detail::logger().level.store(level, std::memory_order_relaxed);
+        ax_algorithm_set_log_level(level);
+    }
+
+    static inline bool level_enabled(int level)
+    {
+        return level <= detail::logger().level.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief: 开始异步输出
+     * @return 0 成功，非零表示失败。
+     */
+    static int start(const options_t &options = get_default_options())
+    {
+        detail::logger_t &l = detail::logger();
+        std::lock_guard<std::mutex> lock(l.mutex);
+        if (l.enabled.load())
+        {
+            return ax_error_code_fail;
+        }
+        l.options = options;
+        if (!options.binary_path.empty())
+        {
+            l.bin = fopen(options.binary_path.c_str(), "wb");
+            if (l.bin == nullptr)
+            {
+                return ax_error_code_fail;
+            }
+            fwrite(detail::magic, 1, detail::magic_size, l.bin);
+            for (auto site : l.bin_sites)
+            {
+                site->id = -1;
+            }
+            l.bin_sites.clear();
+        }
+        l.stop = false;
+        int flush_ms = options.flush_ms > 0 ? options.flush_ms : 50;
+        l.flusher = std::thread([&l, flush_ms]()
+                                {
+            std::unique_lock<std::mutex> wake_lock(l.wake_mutex);
+            while (!l.stop)
+            {
+                l.wake.wait_for(wake_lock, std::chrono::milliseconds(flush_ms));
+                l.wake_pending.store(false, std::memory_order_relaxed);
+                std::lock_guard<std::mutex> lock(l.mutex);
+                l.flush_locked();
+            } });
+        l.enabled.store(true);
+        return ax_error_code_success;
+    }
+
+    /**
+     * @brief: 停止异步输出，写出剩余记录；之后的日志恢复同步输出
+     * @return 因缓冲区满丢弃的记录数
+     */
+    static unsigned long long stop()
+    {
+        detail::logger_t &l = detail::logger();
+        {
+            std::lock_guard<std::mutex> wake_lock(l.wake_mutex);
+            l.stop = true;
+        }
+        l.wake.notify_all();
+        if (l.flusher.joinable())
+        {
+            l.flusher.join();
+        }
+
+        std::lock_guard<std::mutex> lock(l.mutex);
+        l.enabled.store(false);
+        l.flush_locked();
+        if (l.bin != nullptr)
+        {
+            fclose(l.bin);
+            l.bin = nullptr;
+        }
+        unsigned long long dropped = 0;
+        for (auto &ring : l.rings)
+        {
+            dropped += ring->dropped.exchange(0);
+        }
+        return dropped;
+    }
+
+    // 限速判断，返回 false 表示本条被抑制
+    static inline bool admit(site_t &site)
+    {
+        if (site.per_sec <= 0)
+        {
+            return true;
+        }
+        long long now = detail::steady_ms();
+        long long start = site.window_ms.load(std::memory_order_relaxed);
+        if (now - start >= 1000 && site.window_ms.compare_exchange_strong(start, now, std::memory_order_relaxed))
+        {
+            site.window_count.store(0, std::memory_order_relaxed);
+        }
+        if (site.window_count.fetch_add(1, std::memory_order_relaxed) < site.per_sec)
+        {
+            return true;
+        }
+        site.suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    template <typename... Args>
+    static void write(site_t &site, const Args &...args)
+    {
+        const int n_args = sizeof...(Args) < (size_t)max_args ? (int)sizeof...(Args) : (int)max_args;
+        alignas(8) char buf[max_record_bytes];
+        detail::header_t hdr;
+        detail::packer_t packer(buf, n_args);
+        packer.pack(args...);
+
+        hdr.size = packer.strings;
+        hdr.suppressed = site.suppressed.exchange(0, std::memory_order_relaxed);
+        hdr.site = &site;
+        hdr.ts_us = detail::wall_us();
+        hdr.n_args = packer.n_args;
+        memcpy(buf, &hdr, sizeof(hdr));
+
+        detail::logger_t &l = detail::logger();
+        if (l.enabled.load(std::memory_order_acquire))
+        {
+            unsigned int used = detail::local_ring()->push(buf, hdr.size);
+            if ((used == 0 || used > detail::ring_size / 2) && !l.wake_pending.exchange(true, std::memory_order_relaxed))
+            {
+                l.wake.notify_one();
+            }
+            return;
+        }
+        record_t r;
+        detail::unpack(buf, (int)syscall(SYS_gettid), &r);
+        std::string text;
+        format(r, text);
+        fwrite(text.data(), 1, text.size(), stdout);
+    }
+
+    /**
+     * @brief: 把二进制日志文件还原为文本
+     * @return 记录条数，文件格式错误返回 -1
+     */
+    static long long decode(const std::string &path, FILE *out, bool prefix = true)
+    {
+        FILE *fp = fopen(path.c_str(), "rb");
+        if (fp == nullptr)
+        {
+            return -1;
+        }
+        char magic[detail::magic_size];
+        if (fread(magic, 1, sizeof(magic), fp) != sizeof(magic) || memcmp(magic, detail::magic, sizeof(magic)) != 0)
+        {
+            fclose(fp);
+            return -1;
+        }
+        struct decoded_site_t
+        {
+            int level;
+            int line;
+            std::string file;
+            std::string fmt;
+        };
+        std::vector<decoded_site_t> sites;
+        long long n = 0;
+        std::string text;
+        unsigned char kind;
+        while (fread(&kind, 1, 1, fp) == 1)
+        {
+            int id;
+            if (fread(&id, sizeof(id), 1, fp) != 1 || id < 0)
+            {
+                break;
+            }
+            if (kind == 1)
+            {
+                decoded_site_t s;
+                unsigned short len;
+                bool ok = fread(&s.level, sizeof(int), 1, fp) == 1 && fread(&s.line, sizeof(int), 1, fp) == 1 && fread(&len, sizeof(len), 1, fp) == 1;
+                s.file.resize(len);
+                ok = ok && fread(&s.file[0], 1, len, fp) == len && fread(&len, sizeof(len), 1, fp) == 1;
+                s.fmt.resize(len);
+                ok = ok && fread(&s.fmt[0], 1, len, fp) == len;
+                if (!ok)
+                {
+                    break;
+                }
+                sites.resize(std::max(sites.size(), (size_t)id + 1));
+                sites[id] = s;
+                continue;
+            }
+            int tid;
+            detail::header_t hdr;
+            alignas(8) char data[max_record_bytes];
+            if (kind != 2 || (size_t)id >= sites.size() || fread(&tid, sizeof(tid), 1, fp) != 1 ||
+                fread(&hdr, sizeof(hdr), 1, fp) != 1 || hdr.size < sizeof(hdr) || hdr.size > max_record_bytes ||
+                hdr.n_args < 0 || hdr.n_args > max_args)
+            {
+                break;
+            }
+            memcpy(data, &hdr, sizeof(hdr));
+            if (fread(data + sizeof(hdr), 1, hdr.size - sizeof(hdr), fp) != hdr.size - sizeof(hdr))
+            {
+                break;
+            }
+            // 指针换成本地还原的调用点
+            site_t site(sites[id].level, sites[id].file.c_str(), sites[id].line, sites[id].fmt.c_str(), 0);
+            hdr.site = &site;
+            memcpy(data, &hdr, sizeof(hdr));
+            record_t r;
+            detail::unpack(data, tid, &r);
+            for (int i = 0; i < r.n_args; i++)
+            {
+                if (r.types[i] == 's' && (r.args[i].s < data || r.args[i].s >= data + hdr.size))
+                {
+                    r.types[i] = 'p';
+                }
+            }
+            format(r, text, prefix);
+            fwrite(text.data(), 1, text.size(), out);
+            n++;
+        }
+        fclose(fp);
+        return n;
+    }
+}
+
+/**
+ * 记录一条日志，fmt 必须是字符串字面量
+ * ASYNC_LOG(ax_log_info, "track_id: %d\n", box.track_id);
+ * if (0) printf 不会执行，只让编译器按 -Wformat 检查 fmt 与参数
+ */
+#define ASYNC_LOG_RATE(level, per_sec, fmt, ...)                                                    \
+    do                                                                                              \
+    {                                                                                               \
+        if (0)                                                                                      \
+        {                                                                                           \
+            printf(fmt, ##__VA_ARGS__);                                                             \
+        }                                                                                           \
+        if (async_log::level_enabled(level))                                                        \
+        {                                                                                           \
+            static async_log::site_t async_log_site_(level, __FILE__, __LINE__, fmt, per_sec);      \
+            if (async_log::admit(async_log_site_))                                                  \
+            {                                                                                       \
+                async_log::write(async_log_site_, ##__VA_ARGS__);                                   \
+            }                                                                                       \
+        }                                                                                           \
+    } while (0)
+
+#define ASYNC_LOG(level, fmt, ...) ASYNC_LOG_RATE(level, 0, fmt, ##__VA_ARGS__)
@@ -0,0 +1,131 @@
+#pragma once
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <chrono>
+#include <string>
+#include <vector>
+
+/**
+ * 性能测试公共工具：计时、延迟分位数统计、进程 CPU 占用
+ */
+namespace bench_utils
+{
+    static inline double now_us()
+    {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    typedef struct _summary_t
+    {
+        size_t count;
+        double mean, min, p50, p90, p99, max; // 单位 us
+    } summary_t;
+
+    /**
+     * 保存每次采样的耗时，统计时排序求分位数
+     */
+    class latency_recorder
+    {
+    public:
+        void reserve(size_t n)
+        {
+            samples_.reserve(n);
+        }
+
+        void add(double us)
+        {
+            samples_.push_back(us);
+        }
+
+        void clear()
+        {
+            samples_.clear();
+        }
+
+        size_t count() const
+        {
+            return samples_.size();
+        }
+
+        void merge(const latency_recorder &other)
+        {
+            samples_.insert(samples_.end(), other.samples_.begin(), other.samples_.end());
+        }
+
+        summary_t summarize() const
+        {
+            summary_t s = summary_t();
+            s.count = samples_.size();
+            if (s.count == 0)
+            {
+                return s;
+            }
+            std::vector<double> sorted(samples_);
+            std::sort(sorted.begin(), sorted.end());
+            double sum = 0;
+            for (double v : sorted)
+            {
+                sum += v;
+            }
+            s.mean = sum / s.count;
+            s.min = sorted.front();
+            s.max = sorted.back();
+            s.p50 = percentile(sorted, 0.50);
+            s.p90 = percentile(sorted, 0.90);
+            s.p99 = percentile(sorted, 0.99);
+            return s;
+        }
+
+    private:
+        static double percentile(const std::vector<double> &sorted, double q)
+        {
+            size_t idx = (size_t)(q * (sorted.size() - 1) + 0.5);
+            return sorted[idx];
+        }
+
+        std::vector<double> samples_;
+    };
+
+    /**
+     * 进程 CPU 占用，100 表示占满一个核
+     */
+    class cpu_meter
+    {
+    public:
+        cpu_meter()
+        {
+            start();
+        }
+
+        void start()
+        {
+            wall_start_ = now_us();
+            cpu_start_ = cpu_us();
+        }
+
+        double usage() const
+        {
+            double wall = now_us() - wall_start_;
+            return wall > 0 ? (cpu_us() - cpu_start_) * 100.0 / wall : 0;
+        }
+
+    private:
+        static double cpu_us()
+        {
+            struct rusage ru;
+            getrusage(RUSAGE_SELF, &ru);
+            return (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1e6 + ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+        }
+
+        double wall_start_;
+        double cpu_start_;
+    };
+
+    static void print_summary(const std::string &name, const summary_t &s)
+    {
+        printf("%-16s count: %6zu mean: %9.1f p50: %9.1f p90: %9.1f p99: %9.1f max: %9.1f us\n",
+               name.c_str(), s.count, s.mean, s.p50, s.p90, s.p99, s.max);
+    }
+}
@@ -0,0 +1,217 @@
+#pragma once
+#include <cstddef>
+#include <cstring>
+#include <unordered_map>
+
+#include "ax_algorithm_sdk.h"
+#include "track_events.hpp"
+
+/**
+ * 按 track_id 缓存人体属性：
+ * 每个轨迹保存最近 history_len 次属性网络输出，逐个属性取众数作为平滑结果；
+ * 连续 converge_count 次平滑结果不变后认为收敛，停止调用 ax_algorithm_get_body_attr，
+ * 之后只在 recheck_interval 帧周期复核，或人体框外观(IoU/宽高比)变化过大时重新推理。
+ */
+namespace body_attr_cache
+{
+    // ax_body_attr_t 中除 track_id 外的属性个数(连续的 unsigned char)，每个属性的最大取值个数，最大投票窗口
+    enum
+    {
+        n_attrs = offsetof(ax_body_attr_t, orientation) + 1 - offsetof(ax_body_attr_t, isHuman),
+        max_labels = 16,
+        max_history = 16,
+    };
+
+    typedef struct _param_t
+    {
+        /**
+         * history_len: 投票窗口长度，不超过 16
+         * converge_count: 平滑结果连续不变多少次认为收敛
+         * recheck_interval: 收敛后每隔多少帧复核一次
+         * appearance_iou: 人体框与上次推理时 IoU 低于该值时重新推理
+         * lost_frames: track_id 连续多少帧未更新后丢弃
+         */
+        int history_len;
+        int converge_count;
+        int recheck_interval;
+        float appearance_iou;
+        int lost_frames;
+    } param_t;
+
+    static param_t get_default_param()
+    {
+        param_t param;
+        param.history_len = 8;
+        param.converge_count = 5;
+        param.recheck_interval = 100;
+        param.appearance_iou = 0.3f;
+        param.lost_frames = 100;
+        return param;
+    }
+
+    static inline unsigned char *attrs(ax_body_attr_t *attr)
+    {
+        return &attr->isHuman;
+    }
+
+    class cache
+    {
+    public:
+        cache() : param_(get_default_param()), frame_(0) {}
+        explicit cache(const param_t &param) : param_(param), frame_(0) {}
+
+        void set_param(const param_t &param)
+        {
+            param_ = param;
+            tracks_.clear();
+        }
+
+        /**
+         * @brief: 每帧开始时调用一次，用于计算复核周期和清理消失的轨迹
+         */
+        void next_frame()
+        {
+            frame_++;
+            for (auto it = tracks_.begin(); it != tracks_.end();)
+            {
+                if (frame_ - it->second.last_frame > param_.lost_frames)
+                {
+                    it = tracks_.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+
+        /**
+         * @brief: 获取平滑后的人体属性，必要时才调用属性网络
+         * @param[in] handle: ax_model_type_person_attr 算法句柄
+         * @param[in] image: 图像数据
+         * @param[in] bbox: 人体框
+         * @param[in,out] body_attr: 输入 track_id，输出平滑后的属性；track_id 为 0 时直接推理不缓存
+         * @param[out] inferred: 可选，1 表示本次调用了属性网络
+         * @return 0 成功，非零表示失败。
+         */
+        int get(ax_algorithm_handle_t handle, ax_image_t *image, ax_bbox_t *bbox, ax_body_attr_t *body_attr, int *inferred = nullptr)
+        {
+            if (inferred)
+            {
+                *inferred = 0;
+            }
+            if (body_attr->track_id == 0)
+            {
+                if (inferred)
+                {
+                    *inferred = 1;
+                }
+                return ax_algorithm_get_body_attr(handle, image, bbox, body_attr);
+            }
+
+            track_t &t = tracks_[body_attr->track_id];
+            t.last_frame = frame_;
+            if (t.converged && frame_ - t.infer_frame < param_.recheck_interval && !appearance_changed(t, *bbox))
+            {
+                unsigned long int track_id = body_attr->track_id;
+                *body_attr = t.smoothed;
+                body_attr->track_id = track_id;
+                return ax_error_code_success;
+            }
+
+            ax_body_attr_t raw = *body_attr;
+            int ret = ax_algorithm_get_body_attr(handle, image, bbox, &raw);
+            if (inferred)
+            {
+                *inferred = 1;
+            }
+            if (ret != ax_error_code_success)
+            {
+                return ret;
+            }
+
+            t.infer_frame = frame_;
+            t.bbox = *bbox;
+            vote(t, raw);
+            *body_attr = t.smoothed;
+            body_attr->track_id = raw.track_id;
+            return ax_error_code_success;
+        }
+
+        bool is_converged(unsigned long int track_id) const
+        {
+            auto it = tracks_.find(track_id);
+            return it != tracks_.end() && it->second.converged;
+        }
+
+    private:
+        struct track_t
+        {
+            track_t() : n_history(0), head(0), stable(0), converged(false), last_frame(0), infer_frame(0)
+            {
+                memset(&smoothed, 0, sizeof(ax_body_attr_t));
+                memset(&bbox, 0, sizeof(ax_bbox_t));
+            }
+            unsigned char history[max_history][n_attrs];
+            int n_history;
+            int head;
+            int stable;
+            bool converged;
+            ax_body_attr_t smoothed;
+            ax_bbox_t bbox;
+            long long last_frame;
+            long long infer_frame;
+        };
+
+        bool appearance_changed(const track_t &t, const ax_bbox_t &bbox) const
+        {
+            if (track_events::iou(t.bbox, bbox) < param_.appearance_iou)
+            {
+                return true;
+            }
+            // 宽高比变化(如蹲下、转身)同样视为外观变化
+            float r0 = t.bbox.h > 0 ? t.bbox.w / t.bbox.h : 0;
+            float r1 = bbox.h > 0 ? bbox.w / bbox.h : 0;
+            return r0 > 0 && (r1 / r0 > 1.5f || r1 / r0 < 1 / 1.5f);
+        }
+
+        void vote(track_t &t, ax_body_attr_t &raw)
+        {
+            int len = param_.history_len < 1 ? 1 : (param_.history_len > max_history ? max_history : param_.history_len);
+            memcpy(t.history[t.head], attrs(&raw), n_attrs);
+            t.head = (t.head + 1) % len;
+            t.n_history = t.n_history < len ? t.n_history + 1 : len;
+
+            ax_body_attr_t smoothed = raw;
+            unsigned char *out = attrs(&smoothed);
+            for (int a = 0; a < n_attrs; a++)
+            {
+                int count[max_labels] = {0};
+                int best = 0;
+                for (int h = 0; h < t.n_history; h++)
+                {
+                    unsigned char lab = t.history[h][a];
+                    // "Uncertain" (0) 不参与投票
+                    if (lab == 0 || lab >= max_labels)
+                    {
+                        continue;
+                    }
+                    if (++count[lab] > count[best])
+                    {
+                        best = lab;
+                    }
+                }
+                out[a] = (unsigned char)best;
+            }
+
+            bool same = t.n_history > 1 && memcmp(attrs(&smoothed), attrs(&t.smoothed), n_attrs) == 0;
+            t.stable = same ? t.stable + 1 : 0;
+            t.converged = t.stable >= param_.converge_count;
+            t.smoothed = smoothed;
+        }
+
+        param_t param_;
+        long long frame_;
+        std::unordered_map<unsigned long int, track_t> tracks_;
+    };
+}
@@ -0,0 +1,213 @@
+#pragma once
+#include <cstring>
+
+#include "ax_algorithm_sdk.h"
+
+/**
+ * ax_model_type_fire_smoke 的自适应调度：
+ * 空闲时每 base_interval 帧推理一次；一旦出现火或烟(fire_smoke_info.label 0/1，"其他"不算)，切换到逐帧推理，
+ * 直到连续 active_hold 帧没有检测结果再回到低频。
+ * 同一 fire_smoke_info.label 在最近 persist_n 次推理中至少出现 persist_k 次才上报，抑制偶发误报。
+ */
+namespace fire_smoke_scheduler
+{
+    enum
+    {
+        max_labels = 8,
+    };
+
+    typedef struct _param_t
+    {
+        /**
+         * base_interval: 空闲时的推理间隔(帧)，1 表示逐帧
+         * active_hold: 最后一次检测到烟火后保持逐帧推理的帧数
+         * persist_k, persist_n: 最近 persist_n(<=32) 次推理中出现 persist_k 次才上报
+         */
+        int base_interval;
+        int active_hold;
+        int persist_k;
+        int persist_n;
+    } param_t;
+
+    static param_t get_default_param()
+    {
+        param_t param;
+        param.base_interval = 25;
+        param.active_hold = 75;
+        param.persist_k = 3;
+        param.persist_n = 5;
+        return param;
+    }
+
+    // fire_smoke_info.label: 0 火，1 烟，2 其他
+    static inline bool is_fire_or_smoke(int label)
+    {
+        return label == 0 || label == 1;
+    }
+
+    static inline int popcount(unsigned int v)
+    {
+        return __builtin_popcount(v);
+    }
+
+    class scheduler
+    {
+    public:
+        scheduler() : param_(get_default_param())
+        {
+            reset();
+        }
+
+        explicit scheduler(const param_t &param) : param_(param)
+        {
+            reset();
+        }
+
+        void set_param(const param_t &param)
+        {
+            param_ = param;
+            reset();
+        }
+
+        void reset()
+        {
+            frames_since_infer_ = -1;
+            frames_since_detect_ = -1;
+            memset(history_, 0, sizeof(history_));
+            memset(&reported_, 0, sizeof(ax_result_t));
+            reported_.model_type = ax_model_type_fire_smoke;
+        }
+
+        /**
+         * @brief: 当前是否处于逐帧推理状态
+         */
+        bool active() const
+        {
+            return frames_since_detect_ >= 0 && frames_since_detect_ < param_.active_hold;
+        }
+
+        /**
+         * @brief: 当前帧是否需要推理，每帧调用一次
+         */
+        bool need_inference()
+        {
+            if (frames_since_detect_ >= 0)
+            {
+                frames_since_detect_++;
+            }
+            if (frames_since_infer_ < 0 || active() || frames_since_infer_ + 1 >= param_.base_interval)
+            {
+                return true;
+            }
+            frames_since_infer_++;
+            return false;
+        }
+
+        /**
+         * @brief: 推理后调用，更新持续性统计，result 中只保留满足 K-of-N 的目标
+         */
+        void update(ax_result_t *result)
+        {
+            frames_since_infer_ = 0;
+
+            unsigned int seen = 0;
+            bool escalate = false;
+            for (int i = 0; i < result->n_objects; i++)
+            {
+                int label = result->objects[i].fire_smoke_info.label;
+                if (label >= 0 && label < max_labels)
+                {
+                    seen |= 1u << label;
+                }
+                escalate = escalate || is_fire_or_smoke(label);
+            }
+            if (escalate)
+            {
+                frames_since_detect_ = 0;
+            }
+
+            int n = param_.persist_n < 1 ? 1 : (param_.persist_n > 32 ? 32 : param_.persist_n);
+            unsigned int window = n == 32 ? 0xffffffffu : ((1u << n) - 1);
+            unsigned int confirmed = 0;
+            for (int label = 0; label < max_labels; label++)
+            {
+                history_[label] = ((history_[label] << 1) | ((seen >> label) & 1)) & window;
+                if (popcount(history_[label]) >= param_.persist_k)
+                {
+                    confirmed |= 1u << label;
+                }
+            }
+
+            int n_objects = 0;
+            for (int i = 0; i < result->n_objects; i++)
+            {
+                int label = result->objects[i].fire_smoke_info.label;
+                if (label >= 0 && label < max_labels && (confirmed >> label) & 1)
+                {
+                    if (n_objects != i)
+                    {
+                        result->objects[n_objects] = result->objects[i];
+                    }
+                    n_objects++;
+                }
+            }
+            result->n_objects = n_objects;
+            reported_ = *result;
+        }
+
+        /**
+         * @brief: 最近一次上报的结果，跳过推理的帧返回该结果
+         */
+        const ax_result_t &last_result() const
+        {
+            return reported_;
+        }
+
+    private:
+        param_t param_;
+        int frames_since_infer_;
+        int frames_since_detect_;
+        unsigned int history_[max_labels];
+        ax_result_t reported_;
+    };
+
+    /**
+     * @brief: 按调度策略调用 ax_algorithm_track
+     * @param[in] handle: ax_model_type_fire_smoke 算法句柄
+     * @param[in] s: 每路视频一个 scheduler
+     * @param[in] image: 图像数据
+     * @param[out] result: 满足持续性要求的烟火结果
+     * @param[in] track_fn: 替代 ax_algorithm_track 的函数，例如 algorithm_stats::track
+     * @param[out] skipped: 可选，1 表示本帧跳过了推理
+     * @return 0 成功，非零表示失败。
+     */
+    template <typename F>
+    static int track(ax_algorithm_handle_t handle, scheduler &s, ax_image_t *image, ax_result_t *result, F track_fn, int *skipped = nullptr)
+    {
+        if (!s.need_inference())
+        {
+            *result = s.last_result();
+            if (skipped)
+            {
+                *skipped = 1;
+            }
+            return ax_error_code_success;
+        }
+
+        if (skipped)
+        {
+            *skipped = 0;
+        }
+        int ret = track_fn(handle, image, result);
+        if (ret == ax_error_code_success)
+        {
+            s.update(result);
+        }
+        return ret;
+    }
+
+    static int track(ax_algorithm_handle_t handle, scheduler &s, ax_image_t *image, ax_result_t *result, int *skipped = nullptr)
+    {
+        return track(handle, s, image, result, ax_algorithm_track, skipped);
+    }
+}
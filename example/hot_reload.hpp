@@ -0,0 +1,376 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "ax_algorithm_sdk.h"
+
+/**
+ * 不停流地替换模型文件：
+ * - reload() 在后台线程用新模型文件 ax_algorithm_init 一个新句柄，参数取当前句柄的 ax_algorithm_get_param，
+ *   加载期间推理继续使用旧句柄
+ * - 新句柄就绪后，下一次 track/detect 调用开始前切换，旧句柄交给后台线程 ax_algorithm_deinit，切换不等待
+ * - SDK 的跟踪状态在句柄内部，无法迁移；切换后新句柄的 track_id 重新编号，这里按 IoU 和类别
+ *   与切换前最后一帧的输出匹配，沿用旧的 track_id，没有匹配上的分配新编号，输出的 track_id 保持连续；
+ *   只有切换后 handover_frames 帧内出现的新轨迹参与匹配，之后出现的轨迹都分配新编号
+ * 加载期间两个模型同时占用内存；一个 reloader 只能由一个线程调用 track/detect。
+ */
+namespace hot_reload
+{
+    typedef enum _state_e
+    {
+        state_idle = 0,
+        state_loading,
+        state_ready,  // 新句柄已加载，等待下一次调用时切换
+        state_failed, // 上一次加载失败，可以再次 reload
+    } state_e;
+
+    typedef struct _param_t
+    {
+        /**
+         * match_iou: 切换后新轨迹与切换前目标的最小 IoU
+         * handover_frames: 切换后多少帧内出现的新轨迹与切换前目标匹配，跟踪器确认新轨迹需要几帧
+         * lost_frames: 映射表中连续多少帧未出现的 track_id 被清理
+         */
+        float match_iou;
+        int handover_frames;
+        int lost_frames;
+    } param_t;
+
+    static param_t get_default_param()
+    {
+        param_t param;
+        param.match_iou = 0.3f;
+        param.handover_frames = 5;
+        param.lost_frames = 300;
+        return param;
+    }
+
+    class reloader
+    {
+    public:
+        reloader() : param_(get_default_param()) {}
+        explicit reloader(const param_t &param) : param_(param) {}
+        ~reloader() { deinit(); }
+
+        reloader(const reloader &) = delete;
+        reloader &operator=(const reloader &) = delete;
+
+        /**
+         * @brief: 同 ax_algorithm_init
+         * @return 0 成功，非零表示失败。
+         */
+        int init(const ax_algorithm_init_t &init_info)
+        {
+            init_info_ = init_info;
+            int ret = ax_algorithm_init(&init_info_, &handle_);
+            if (ret != ax_error_code_success)
+            {
+                handle_ = nullptr;
+            }
+            return ret;
+        }
+
+        void deinit()
+        {
+            join(loader_);
+            {
+                std::lock_guard<std::mutex> lock(retire_mutex_);
+                retire_stop_ = true;
+            }
+            retire_cv_.notify_one();
+            join(retire_);
+            retire_stop_ = false;
+            if (state_ == state_ready)
+            {
+                ax_algorithm_deinit(pending_);
+            }
+            state_ = state_idle;
+            if (handle_ != nullptr)
+            {
+                ax_algorithm_deinit(handle_);
+                handle_ = nullptr;
+            }
+        }
+
+        /**
+         * @brief: 后台加载新的模型文件，立即返回
+         * @param[in] model_file: 新模型文件，可以与当前路径相同(文件内容已更新)
+         * @return 0 已开始加载；正在加载或等待切换时返回 ax_error_code_fail
+         */
+        int reload(const std::string &model_file)
+        {
+            int state = state_;
+            if (handle_ == nullptr || state == state_loading || state == state_ready)
+            {
+                return ax_error_code_fail;
+            }
+            join(loader_);
+            ax_algorithm_init_t info = init_info_;
+            snprintf(info.model_file, sizeof(info.model_file), "%s", model_file.c_str());
+            info.param = ax_algorithm_get_param(handle_);
+            state_ = state_loading;
+            loader_ = std::thread([this, info]() mutable
+                                  {
+                ax_algorithm_handle_t handle = nullptr;
+                int64_t t0 = now_us();
+                int ret = ax_algorithm_init(&info, &handle);
+                load_us_ = now_us() - t0;
+                if (ret != ax_error_code_success)
+                {
+                    load_error_ = ret;
+                    state_ = state_failed;
+                    return;
+                }
+                pending_info_ = info;
+                pending_ = handle;
+                state_ = state_ready; });
+            return ax_error_code_success;
+        }
+
+        typedef std::function<void(ax_algorithm_handle_t old_handle, ax_algorithm_handle_t new_handle)> switch_callback_t;
+
+        /**
+         * @brief: 设置切换回调，在调用 track/detect 的线程上执行，此时新句柄还没有被调用，旧句柄还没有释放，
+         *         例如用 algorithm_stats::move_stats 把旧句柄的统计并入新句柄
+         */
+        void set_switch_callback(const switch_callback_t &callback) { on_switch_ = callback; }
+
+        state_e state() const { return (state_e)state_.load(); }
+        int load_error() const { return load_error_; }
+        long long load_us() const { return load_us_; }
+        int generation() const { return generation_; }
+        ax_algorithm_handle_t handle() const { return handle_; }
+
+        /**
+         * @brief: 同 ax_algorithm_track，track_id 经过重映射
+         * @param[in] track_fn: 替代 ax_algorithm_track 的函数，例如 algorithm_stats::track
+         */
+        template <typename F>
+        int track(ax_image_t *image, ax_result_t *result, F track_fn)
+        {
+            switch_if_ready();
+            int ret = track_fn(handle_, image, result);
+            if (ret == ax_error_code_success)
+            {
+                remap(result);
+            }
+            return ret;
+        }
+
+        int track(ax_image_t *image, ax_result_t *result)
+        {
+            return track(image, result, ax_algorithm_track);
+        }
+
+        int detect(ax_image_t *image, ax_result_t *result)
+        {
+            switch_if_ready();
+            return ax_algorithm_detect(handle_, image, result);
+        }
+
+    private:
+        struct mapped_t
+        {
+            unsigned long int id;
+            long long last_frame;
+        };
+
+        static int64_t now_us()
+        {
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        static void join(std::thread &th)
+        {
+            if (th.joinable())
+            {
+                th.join();
+            }
+        }
+
+        static float iou(const ax_bbox_t &a, const ax_bbox_t &b)
+        {
+            float x0 = std::fmax(a.x, b.x);
+            float y0 = std::fmax(a.y, b.y);
+            float x1 = std::fmin(a.x + a.w, b.x + b.w);
+            float y1 = std::fmin(a.y + a.h, b.y + b.h);
+            float inter = std::fmax(0.f, x1 - x0) * std::fmax(0.f, y1 - y0);
+            float uni = a.w * a.h + b.w * b.h - inter;
+            return uni > 0 ? inter / uni : 0;
+        }
+
+        void switch_if_ready()
+        {
+            if (state_ != state_ready)
+            {
+                return;
+            }
+            // 加载线程设置 state_ready 后立即结束，这里的 join 不会等待
+            join(loader_);
+            ax_algorithm_handle_t old = handle_;
+            handle_ = pending_;
+            pending_ = nullptr;
+            init_info_ = pending_info_;
+            state_ = state_idle;
+            generation_++;
+            if (on_switch_)
+            {
+                on_switch_(old, handle_);
+            }
+            retire(old);
+
+            // 旧句柄的编号全部作废，切换前最后一帧的目标等待新轨迹认领
+            ids_.clear();
+            handover_ = last_;
+            claimed_.assign(handover_.size(), false);
+            handover_end_ = frame_ + param_.handover_frames;
+            remapping_ = true;
+        }
+
+        // 旧句柄放入队列由后台线程释放，上一次的释放还没结束时也不阻塞推理线程
+        void retire(ax_algorithm_handle_t handle)
+        {
+            {
+                std::lock_guard<std::mutex> lock(retire_mutex_);
+                retire_queue_.push_back(handle);
+            }
+            retire_cv_.notify_one();
+            if (retire_.joinable())
+            {
+                return;
+            }
+            retire_ = std::thread([this]()
+                                  {
+                std::unique_lock<std::mutex> lock(retire_mutex_);
+                while (true)
+                {
+                    retire_cv_.wait(lock, [this]()
+                                    { return retire_stop_ || !retire_queue_.empty(); });
+                    if (retire_queue_.empty())
+                    {
+                        return;
+                    }
+                    ax_algorithm_handle_t h = retire_queue_.front();
+                    retire_queue_.pop_front();
+                    lock.unlock();
+                    ax_algorithm_deinit(h);
+                    lock.lock();
+                } });
+        }
+
+        void remap(ax_result_t *result)
+        {
+            frame_++;
+            if (!handover_.empty() && frame_ > handover_end_)
+            {
+                // 交接窗口结束，没有被认领的旧目标视为已离开
+                handover_.clear();
+                claimed_.clear();
+            }
+            if (remapping_)
+            {
+                for (int i = 0; i < result->n_objects; i++)
+                {
+                    auto &obj = result->objects[i];
+                    if (obj.track_id == 0)
+                    {
+                        continue;
+                    }
+                    auto it = ids_.find(obj.track_id);
+                    if (it == ids_.end())
+                    {
+                        it = ids_.insert(std::make_pair(obj.track_id, mapped_t{claim(obj.bbox, obj.label), frame_})).first;
+                    }
+                    it->second.last_frame = frame_;
+                    obj.track_id = it->second.id;
+                }
+                if (frame_ % 64 == 0)
+                {
+                    for (auto it = ids_.begin(); it != ids_.end();)
+                    {
+                        it = frame_ - it->second.last_frame > param_.lost_frames ? ids_.erase(it) : std::next(it);
+                    }
+                }
+            }
+
+            last_.clear();
+            for (int i = 0; i < result->n_objects; i++)
+            {
+                auto &obj = result->objects[i];
+                if (obj.track_id != 0)
+                {
+                    last_.push_back(obj);
+                    next_id_ = std::max(next_id_, (unsigned long int)obj.track_id + 1);
+                }
+            }
+        }
+
+        // 新轨迹与切换前最后一帧中未被认领的同类目标匹配
+        unsigned long int claim(const ax_bbox_t &bbox, int label)
+        {
+            int best = -1;
+            float best_iou = param_.match_iou;
+            for (size_t j = 0; j < handover_.size(); j++)
+            {
+                if (claimed_[j] || handover_[j].label != label)
+                {
+                    continue;
+                }
+                float v = iou(bbox, handover_[j].bbox);
+                if (v >= best_iou)
+                {
+                    best_iou = v;
+                    best = j;
+                }
+            }
+            if (best < 0)
+            {
+                return next_id_++;
+            }
+            claimed_[best] = true;
+            return handover_[best].track_id;
+        }
+
+        typedef std::remove_reference<decltype(ax_result_t::objects[0])>::type object_t;
+
+        param_t param_;
+        ax_algorithm_init_t init_info_;
+        ax_algorithm_handle_t handle_ = nullptr;
+
+        std::thread loader_;
+        std::thread retire_; // 释放旧句柄的后台线程，deinit 时处理完队列后退出
+        std::mutex retire_mutex_;
+        std::condition_variable retire_cv_;
+        std::deque<ax_algorithm_handle_t> retire_queue_;
+        bool retire_stop_ = false;
+        std::atomic<int> state_{state_idle};
+        ax_algorithm_handle_t pending_ = nullptr;
+        ax_algorithm_init_t pending_info_;
+        std::atomic<int> load_error_{0};
+        std::atomic<long long> load_us_{0};
+        int generation_ = 0;
+        switch_callback_t on_switch_;
+
+        bool remapping_ = false;
+        long long frame_ = 0;
+        unsigned long int next_id_ = 1;
+        std::unordered_map<unsigned long int, mapped_t> ids_; // 新句柄 track_id -> 输出 track_id
+        std::vector<object_t> last_;                           // 上一帧输出
+        std::vector<object_t> handover_;                       // 切换前最后一帧输出，交接窗口结束后清空
+        long long handover_end_ = 0;                           // 交接窗口的最后一帧
+        std::vector<bool> claimed_;
+    };
+}
@@ -0,0 +1,398 @@
+#pragma once
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ax_algorithm_sdk.h"
+
+/**
+ * ax_algorithm_detect 结果的磁盘缓存，用于重复运行精度评估：
+ * - 键为 XXH64(图像内容)，种子由模型文件内容、模型类型、算法参数和缓存格式版本共同决定，任一变化都不会命中旧结果
+ * - 每个结果一个文件 <dir>/<键前两位>/<键>.res，先写临时文件再 rename，多个进程共用一个目录也不会读到半个文件
+ * - 总大小超过 max_bytes 时按最近使用时间(文件 mtime，命中时更新)淘汰到 90%
+ */
+namespace inference_cache
+{
+    enum
+    {
+        version = 1,
+    };
+
+    namespace detail
+    {
+        static const unsigned long long p1 = 11400714785074694791ULL;
+        static const unsigned long long p2 = 14029467366897019727ULL;
+        static const unsigned long long p3 = 1609587929392839161ULL;
+        static const unsigned long long p4 = 9650029242287828579ULL;
+        static const unsigned long long p5 = 2870177450012600261ULL;
+
+        static inline unsigned long long rotl(unsigned long long x, int r) { return (x << r) | (x >> (64 - r)); }
+        static inline unsigned long long read64(const unsigned char *p)
+        {
+            unsigned long long v;
+            memcpy(&v, p, 8);
+            return v;
+        }
+        static inline unsigned int read32(const unsigned char *p)
+        {
+            unsigned int v;
+            memcpy(&v, p, 4);
+            return v;
+        }
+        static inline unsigned long long mix(unsigned long long acc, unsigned long long input)
+        {
+            return rotl(acc + input * p2, 31) * p1;
+        }
+        static inline unsigned long long merge(unsigned long long acc, unsigned long long v)
+        {
+            return (acc ^ mix(0, v)) * p1 + p4;
+        }
+    }
+
+    // XXH64，小端
+    static unsigned long long xxh64(const void *data, size_t len, unsigned long long seed)
+    {
+        using namespace detail;
+        const unsigned char *p = (const unsigned char *)data;
+        const unsigned char *end = p + len;
+        unsigned long long h;
+        if (len >= 32)
+        {
+            unsigned long long v1 = seed + p1 + p2, v2 = seed + p2, v3 = seed, v4 = seed - p1;
+            for (; p + 32 <= end; p += 32)
+            {
+                v1 = mix(v1, read64(p));
+                v2 = mix(v2, read64(p + 8));
+                v3 = mix(v3, read64(p + 16));
+                v4 = mix(v4, read64(p + 24));
+            }
+            h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+            h = merge(h, v1);
+            h = merge(h, v2);
+            h = merge(h, v3);
+            h = merge(h, v4);
+        }
+        else
+        {
+            h = seed + p5;
+        }
+        h += len;
+        for (; p + 8 <= end; p += 8)
+        {
+            h = rotl(h ^ mix(0, read64(p)), 27) * p1 + p4;
+        }
+        if (p + 4 <= end)
+        {
+            h = rotl(h ^ (read32(p) * p1), 23) * p2 + p3;
+            p += 4;
+        }
+        for (; p < end; p++)
+        {
+            h = rotl(h ^ (*p * p5), 11) * p1;
+        }
+        h ^= h >> 33;
+        h *= p2;
+        h ^= h >> 29;
+        h *= p3;
+        h ^= h >> 32;
+        return h;
+    }
+
+    typedef struct _entry_header_t
+    {
+        char magic[4];
+        unsigned int version;
+        unsigned long long key;
+        unsigned int width;
+        unsigned int height;
+        int dtype;
+        unsigned int result_size;
+    } entry_header_t;
+
+    typedef struct _stats_t
+    {
+        unsigned long long hits;
+        unsigned long long misses;
+        unsigned long long evictions;
+        unsigned long long entries;
+        unsigned long long bytes;
+    } stats_t;
+
+    class cache
+    {
+    public:
+        cache() {}
+
+        cache(const cache &) = delete;
+        cache &operator=(const cache &) = delete;
+
+        /**
+         * @brief: 打开(不存在时创建)缓存目录，扫描已有条目
+         * @param[in] dir: 缓存目录
+         * @param[in] init_info: 与 ax_algorithm_init 相同的初始化信息，模型文件、模型类型和参数参与键的计算
+         * @param[in] max_bytes: 缓存总大小上限
+         * @return 0 成功，非零表示失败。
+         */
+        int open(const std::string &dir, const ax_algorithm_init_t &init_info, unsigned long long max_bytes = 1ULL << 30)
+        {
+            dir_.clear();
+            max_bytes_ = max_bytes;
+            memset(&stats_, 0, sizeof(stats_));
+            lru_.clear();
+            index_.clear();
+            bytes_ = 0;
+
+            unsigned long long seed = version;
+            FILE *fp = fopen(init_info.model_file, "rb");
+            if (fp == nullptr)
+            {
+                return ax_error_code_init_model_fail;
+            }
+            std::string chunk(1 << 20, 0);
+            size_t n;
+            while ((n = fread(&chunk[0], 1, chunk.size(), fp)) > 0)
+            {
+                seed = xxh64(chunk.data(), n, seed);
+            }
+            fclose(fp);
+            int model_type = init_info.model_type;
+            seed = xxh64(&model_type, sizeof(model_type), seed);
+            seed = xxh64(&init_info.param, sizeof(init_info.param), seed);
+            seed_ = seed;
+
+            if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST)
+            {
+                return ax_error_code_fail;
+            }
+            dir_ = dir;
+            scan();
+            return ax_error_code_success;
+        }
+
+        bool is_open() const { return !dir_.empty(); }
+
+        /**
+         * @brief: 先查缓存，未命中时调用 ax_algorithm_detect 并写入缓存
+         * @return ax_algorithm_detect 的返回值，命中时为 0；推理失败的结果不缓存
+         */
+        int detect(ax_algorithm_handle_t handle, ax_image_t *image, ax_result_t *result)
+        {
+            unsigned long long key = image_key(image);
+            if (get(key, image, result))
+            {
+                return ax_error_code_success;
+            }
+            int ret = ax_algorithm_detect(handle, image, result);
+            if (ret == ax_error_code_success)
+            {
+                put(key, image, result);
+            }
+            return ret;
+        }
+
+        unsigned long long image_key(const ax_image_t *image) const
+        {
+            unsigned int shape[4] = {image->nWidth, image->nHeight, (unsigned int)image->tStride_W, (unsigned int)image->eDtype};
+            return xxh64(image->pVir, image->nSize, xxh64(shape, sizeof(shape), seed_));
+        }
+
+        bool get(unsigned long long key, const ax_image_t *image, ax_result_t *result)
+        {
+            std::string path = entry_path(key);
+            FILE *fp = fopen(path.c_str(), "rb");
+            entry_header_t header;
+            bool ok = fp != nullptr && fread(&header, sizeof(header), 1, fp) == 1 &&
+                      memcmp(header.magic, "AXIC", 4) == 0 && header.version == version && header.key == key &&
+                      header.width == image->nWidth && header.height == image->nHeight && header.dtype == image->eDtype &&
+                      header.result_size == sizeof(ax_result_t) && fread(result, sizeof(ax_result_t), 1, fp) == 1;
+            if (fp != nullptr)
+            {
+                fclose(fp);
+            }
+            if (!ok)
+            {
+                stats_.misses++;
+                return false;
+            }
+            stats_.hits++;
+            utimensat(AT_FDCWD, path.c_str(), nullptr, 0);
+            touch(key, sizeof(header) + sizeof(ax_result_t));
+            return true;
+        }
+
+        void put(unsigned long long key, const ax_image_t *image, const ax_result_t *result)
+        {
+            entry_header_t header;
+            memcpy(header.magic, "AXIC", 4);
+            header.version = version;
+            header.key = key;
+            header.width = image->nWidth;
+            header.height = image->nHeight;
+            header.dtype = image->eDtype;
+            header.result_size = sizeof(ax_result_t);
+
+            std::string path = entry_path(key);
+            mkdir(path.substr(0, path.rfind('/')).c_str(), 0755);
+            char tmp_suffix[32];
+            snprintf(tmp_suffix, sizeof(tmp_suffix), ".tmp%d", (int)getpid());
+            std::string tmp = path + tmp_suffix;
+            FILE *fp = fopen(tmp.c_str(), "wb");
+            if (fp == nullptr)
+            {
+                return;
+            }
+            bool ok = fwrite(&header, sizeof(header), 1, fp) == 1 && fwrite(result, sizeof(ax_result_t), 1, fp) == 1;
+            ok = fclose(fp) == 0 && ok;
+            if (!ok || rename(tmp.c_str(), path.c_str()) != 0)
+            {
+                remove(tmp.c_str());
+                return;
+            }
+            touch(key, sizeof(header) + sizeof(ax_result_t));
+            evict();
+        }
+
+        stats_t get_stats() const
+        {
+            stats_t stats = stats_;
+            stats.entries = index_.size();
+            stats.bytes = bytes_;
+            return stats;
+        }
+
+        static void print_stats(const stats_t &stats)
+        {
+            unsigned long long total = stats.hits + stats.misses;
+            printf("inference cache: %llu hits, %llu misses (hit rate %.1f%%), %llu evictions, %llu entries, %.1f MB\n",
+                   stats.hits, stats.misses, total ? 100.0 * stats.hits / total : 0.0, stats.evictions, stats.entries,
+                   stats.bytes / 1048576.0);
+        }
+
+    private:
+        struct item_t
+        {
+            unsigned long long key;
+            unsigned long long size;
+        };
+
+        std::string entry_path(unsigned long long key) const
+        {
+            char name[40];
+            snprintf(name, sizeof(name), "/%02llx/%016llx.res", key >> 56, key);
+            return dir_ + name;
+        }
+
+        // 移到 LRU 链表尾部(最近使用)
+        void touch(unsigned long long key, unsigned long long size)
+        {
+            auto it = index_.find(key);
+            if (it != index_.end())
+            {
+                bytes_ -= it->second->size;
+                lru_.erase(it->second);
+            }
+            lru_.push_back({key, size});
+            index_[key] = std::prev(lru_.end());
+            bytes_ += size;
+        }
+
+        void evict()
+        {
+            if (bytes_ <= max_bytes_)
+            {
+                return;
+            }
+            unsigned long long low = max_bytes_ / 10 * 9;
+            while (bytes_ > low && !lru_.empty())
+            {
+                item_t item = lru_.front();
+                lru_.pop_front();
+                index_.erase(item.key);
+                bytes_ -= item.size;
+                remove(entry_path(item.key).c_str());
+                stats_.evictions++;
+            }
+        }
+
+        // 按 mtime 从旧到新重建 LRU，顺便清理中断留下的临时文件
+        void scan()
+        {
+            struct found_t
+            {
+                struct timespec mtime;
+                item_t item;
+            };
+            std::vector<found_t> found;
+            DIR *top = opendir(dir_.c_str());
+            if (top == nullptr)
+            {
+                return;
+            }
+            while (struct dirent *sub = readdir(top))
+            {
+                if (strlen(sub->d_name) != 2)
+                {
+                    continue;
+                }
+                std::string sub_dir = dir_ + "/" + sub->d_name;
+                DIR *d = opendir(sub_dir.c_str());
+                if (d == nullptr)
+                {
+                    continue;
+                }
+                while (struct dirent *ent = readdir(d))
+                {
+                    std::string path = sub_dir + "/" + ent->d_name;
+                    unsigned long long key;
+                    char suffix[8] = {0};
+                    struct stat st;
+                    if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+                    {
+                        continue;
+                    }
+                    if (strstr(ent->d_name, ".tmp") != nullptr)
+                    {
+                        // 超过一小时的临时文件来自中断的进程
+                        if (time(nullptr) - st.st_mtime > 3600)
+                        {
+                            remove(path.c_str());
+                        }
+                        continue;
+                    }
+                    if (sscanf(ent->d_name, "%16llx.%3s", &key, suffix) == 2 && strcmp(suffix, "res") == 0)
+                    {
+                        found.push_back({st.st_mtim, {key, (unsigned long long)st.st_size}});
+                    }
+                }
+                closedir(d);
+            }
+            closedir(top);
+            std::sort(found.begin(), found.end(), [](const found_t &a, const found_t &b)
+                      { return a.mtime.tv_sec != b.mtime.tv_sec ? a.mtime.tv_sec < b.mtime.tv_sec : a.mtime.tv_nsec < b.mtime.tv_nsec; });
+            for (auto &f : found)
+            {
+                touch(f.item.key, f.item.size);
+            }
+            evict();
+        }
+
+        std::string dir_;
+        unsigned long long seed_ = 0;
+        unsigned long long max_bytes_ = 0;
+        unsigned long long bytes_ = 0;
+        std::list<item_t> lru_;
+        std::unordered_map<unsigned long long, std::list<item_t>::iterator> index_;
+        stats_t stats_;
+    };
+}
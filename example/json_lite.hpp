@@ -0,0 +1,449 @@
+#pragma once
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * 只读的轻量 JSON 解析器，不依赖 nlohmann，供主机侧工具(reference 后端、model_eval 工具)读取
+ * COCO 标注和结果文件。对象保留键的原始顺序，按键查找为线性查找，适合字段很少的对象。
+ */
+namespace json_lite
+{
+    typedef enum _type_e
+    {
+        type_null = 0,
+        type_bool,
+        type_number,
+        type_string,
+        type_array,
+        type_object,
+    } type_e;
+
+    class value
+    {
+    public:
+        value() : type_(type_null), number_(0) {}
+
+        type_e type() const { return type_; }
+        bool is_null() const { return type_ == type_null; }
+        bool is_number() const { return type_ == type_number; }
+        bool is_string() const { return type_ == type_string; }
+        bool is_array() const { return type_ == type_array; }
+        bool is_object() const { return type_ == type_object; }
+
+        double number(double def = 0) const { return type_ == type_number ? number_ : (type_ == type_bool ? number_ : def); }
+        const std::string &str() const { return string_; }
+
+        size_t size() const { return type_ == type_array ? array_.size() : (type_ == type_object ? object_.size() : 0); }
+        const value &at(size_t i) const { return i < array_.size() ? array_[i] : null_value(); }
+        const std::vector<value> &array() const { return array_; }
+        const std::vector<std::pair<std::string, value>> &object() const { return object_; }
+
+        // 不存在时返回 null
+        const value &operator[](const char *key) const
+        {
+            for (auto &kv : object_)
+            {
+                if (kv.first == key)
+                {
+                    return kv.second;
+                }
+            }
+            return null_value();
+        }
+
+        bool contains(const char *key) const { return &(*this)[key] != &null_value(); }
+
+        double get(const char *key, double def) const
+        {
+            const value &v = (*this)[key];
+            return v.is_number() ? v.number_ : def;
+        }
+
+        static const value &null_value()
+        {
+            static value v;
+            return v;
+        }
+
+    private:
+        friend class parser;
+        type_e type_;
+        double number_;
+        std::string string_;
+        std::vector<value> array_;
+        std::vector<std::pair<std::string, value>> object_;
+    };
+
+    class parser
+    {
+    public:
+        /**
+         * @brief: 解析 [begin, end) 中的 JSON 文本
+         * @return true 成功；失败时 error() 返回出错位置和原因
+         */
+        bool parse(const char *begin, const char *end, value &out)
+        {
+            p_ = begin;
+            begin_ = begin;
+            end_ = end;
+            error_.clear();
+            if (!parse_value(out, 0))
+            {
+                return false;
+            }
+            skip_ws();
+            if (p_ != end_)
+            {
+                return fail("trailing characters");
+            }
+            return true;
+        }
+
+        const std::string &error() const { return error_; }
+
+    private:
+        enum
+        {
+            max_depth = 256,
+        };
+
+        bool fail(const char *msg)
+        {
+            char buf[128];
+            snprintf(buf, sizeof(buf), "%s at offset %ld", msg, (long)(p_ - begin_));
+            error_ = buf;
+            return false;
+        }
+
+        void skip_ws()
+        {
+            while (p_ < end_ && (*p_ == ' ' || *p_ == '\n' || *p_ == '\r' || *p_ == '\t'))
+            {
+                p_++;
+            }
+        }
+
+        bool literal(const char *s, size_t n)
+        {
+            if ((size_t)(end_ - p_) < n || memcmp(p_, s, n) != 0)
+            {
+                return fail("invalid literal");
+            }
+            p_ += n;
+            return true;
+        }
+
+        bool parse_value(value &v, int depth)
+        {
+            if (depth > max_depth)
+            {
+                return fail("nesting too deep");
+            }
+            skip_ws();
+            if (p_ >= end_)
+            {
+                return fail("unexpected end");
+            }
+            switch (*p_)
+            {
+            case '{':
+                return parse_object(v, depth);
+            case '[':
+                return parse_array(v, depth);
+            case '"':
+                v.type_ = type_string;
+                return parse_string(v.string_);
+            case 't':
+                v.type_ = type_bool;
+                v.number_ = 1;
+                return literal("true", 4);
+            case 'f':
+                v.type_ = type_bool;
+                v.number_ = 0;
+                return literal("false", 5);
+            case 'n':
+                v.type_ = type_null;
+                return literal("null", 4);
+            default:
+                return parse_number(v);
+            }
+        }
+
+        bool parse_number(value &v)
+        {
+            // strtod 需要以 0 结尾的字符串，数字不会很长，拷贝到栈上
+            char buf[64];
+            size_t n = 0;
+            while (p_ + n < end_ && n < sizeof(buf) - 1 && strchr("+-0123456789.eE", p_[n]) != nullptr)
+            {
+                n++;
+            }
+            if (n == 0)
+            {
+                return fail("unexpected character");
+            }
+            memcpy(buf, p_, n);
+            buf[n] = 0;
+            char *stop = nullptr;
+            v.number_ = strtod(buf, &stop);
+            if (stop != buf + n)
+            {
+                return fail("invalid number");
+            }
+            v.type_ = type_number;
+            p_ += n;
+            return true;
+        }
+
+        static void append_utf8(std::string &s, unsigned int cp)
+        {
+            if (cp < 0x80)
+            {
+                s += (char)cp;
+            }
+            else if (cp < 0x800)
+            {
+                s += (char)(0xC0 | (cp >> 6));
+                s += (char)(0x80 | (cp & 0x3F));
+            }
+            else if (cp < 0x10000)
+            {
+                s += (char)(0xE0 | (cp >> 12));
+                s += (char)(0x80 | ((cp >> 6) & 0x3F));
+                s += (char)(0x80 | (cp & 0x3F));
+            }
+            else
+            {
+                s += (char)(0xF0 | (cp >> 18));
+                s += (char)(0x80 | ((cp >> 12) & 0x3F));
+                s += (char)(0x80 | ((cp >> 6) & 0x3F));
+                s += (char)(0x80 | (cp & 0x3F));
+            }
+        }
+
+        bool parse_hex4(unsigned int &cp)
+        {
+            if (end_ - p_ < 4)
+            {
+                return fail("invalid escape");
+            }
+            cp = 0;
+            for (int i = 0; i < 4; i++)
+            {
+                char c = *p_++;
+                cp <<= 4;
+                if (c >= '0' && c <= '9')
+                    cp |= c - '0';
+                else if (c >= 'a' && c <= 'f')
+                    cp |= c - 'a' + 10;
+                else if (c >= 'A' && c <= 'F')
+                    cp |= c - 'A' + 10;
+                else
+                    return fail("invalid escape");
+            }
+            return true;
+        }
+
+        bool parse_string(std::string &s)
+        {
+            p_++; // '"'
+            s.clear();
+            while (p_ < end_)
+            {
+                const char *run = p_;
+                while (p_ < end_ && *p_ != '"' && *p_ != '\\')
+                {
+                    p_++;
+                }
+                s.append(run, p_ - run);
+                if (p_ >= end_)
+                {
+                    break;
+                }
+                if (*p_ == '"')
+                {
+                    p_++;
+                    return true;
+                }
+                p_++; // '\\'
+                if (p_ >= end_)
+                {
+                    break;
+                }
+                char c = *p_++;
+                switch (c)
+                {
+                case '"':
+                case '\\':
+                case '/':
+                    s += c;
+                    break;
+                case 'b':
+                    s += '\b';
+                    break;
+                case 'f':
+                    s += '\f';
+                    break;
+                case 'n':
+                    s += '\n';
+                    break;
+                case 'r':
+                    s += '\r';
+                    break;
+                case 't':
+                    s += '\t';
+                    break;
+                case 'u':
+                {
+                    unsigned int cp;
+                    if (!parse_hex4(cp))
+                    {
+                        return false;
+                    }
+                    if (cp >= 0xD800 && cp < 0xDC00 && end_ - p_ >= 6 && p_[0] == '\\' && p_[1] == 'u')
+                    {
+                        p_ += 2;
+                        unsigned int lo;
+                        if (!parse_hex4(lo))
+                        {
+                            return false;
+                        }
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                    }
+                    append_utf8(s, cp);
+                }
+                break;
+                default:
+                    return fail("invalid escape");
+                }
+            }
+            return fail("unterminated string");
+        }
+
+        bool parse_array(value &v, int depth)
+        {
+            p_++; // '['
+            v.type_ = type_array;
+            skip_ws();
+            if (p_ < end_ && *p_ == ']')
+            {
+                p_++;
+                return true;
+            }
+            while (true)
+            {
+                v.array_.emplace_back();
+                if (!parse_value(v.array_.back(), depth + 1))
+                {
+                    return false;
+                }
+                skip_ws();
+                if (p_ < end_ && *p_ == ',')
+                {
+                    p_++;
+                    continue;
+                }
+                if (p_ < end_ && *p_ == ']')
+                {
+                    p_++;
+                    return true;
+                }
+                return fail("expected ',' or ']'");
+            }
+        }
+
+        bool parse_object(value &v, int depth)
+        {
+            p_++; // '{'
+            v.type_ = type_object;
+            skip_ws();
+            if (p_ < end_ && *p_ == '}')
+            {
+                p_++;
+                return true;
+            }
+            while (true)
+            {
+                skip_ws();
+                if (p_ >= end_ || *p_ != '"')
+                {
+                    return fail("expected key");
+                }
+                v.object_.emplace_back();
+                if (!parse_string(v.object_.back().first))
+                {
+                    return false;
+                }
+                skip_ws();
+                if (p_ >= end_ || *p_ != ':')
+                {
+                    return fail("expected ':'");
+                }
+                p_++;
+                if (!parse_value(v.object_.back().second, depth + 1))
+                {
+                    return false;
+                }
+                skip_ws();
+                if (p_ < end_ && *p_ == ',')
+                {
+                    p_++;
+                    continue;
+                }
+                if (p_ < end_ && *p_ == '}')
+                {
+                    p_++;
+                    return true;
+                }
+                return fail("expected ',' or '}'");
+            }
+        }
+
+        const char *p_ = nullptr;
+        const char *begin_ = nullptr;
+        const char *end_ = nullptr;
+        std::string error_;
+    };
+
+    /**
+     * @brief: 读取并解析 JSON 文件
+     * @param[out] error: 失败原因，可为空
+     * @return true 成功
+     */
+    static bool parse_file(const std::string &path, value &out, std::string *error = nullptr)
+    {
+        FILE *fp = fopen(path.c_str(), "rb");
+        if (fp == nullptr)
+        {
+            if (error)
+            {
+                *error = "open " + path + " failed";
+            }
+            return false;
+        }
+        std::string text;
+        char buf[1 << 16];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), fp)) > 0)
+        {
+            text.append(buf, n);
+        }
+        fclose(fp);
+
+        parser p;
+        if (!p.parse(text.data(), text.data() + text.size(), out))
+        {
+            if (error)
+            {
+                *error = path + ": " + p.error();
+            }
+            return false;
+        }
+        return true;
+    }
+}
@@ -7,21 +7,31 @@
 #include <ax_engine_api.h>
 
 #include <opencv2/opencv.hpp>
-#include <nlohmann/json.hpp>
 
 #include "ax_algorithm_sdk.h"
 #include "cmdline.hpp"
+#include "inference_cache.hpp"
+#include "result_log.hpp"
+#include "async_log.hpp"
+#include "result_writer.hpp"
 #include "string_utils.hpp"
 #include "putTextPlate.h"
+#include "plate_render.hpp"
 
 #define ALIGN_UP(x, align) ((((x) + ((align) - 1)) / (align)) * (align))
 
-using json = nlohmann::json;
+static result_writer::jsonl_writer result_writer_;
 
-static json image_arr_ = nlohmann::json::array();
+// --sweep_cache 打开时，以最低阈值运行一次并缓存所有候选框，model_eval/threshold_sweep 离线扫描阈值
+static result_log::writer sweep_cache_;
+
+// --cache_dir 打开时相同图像、模型和参数的检测结果直接从磁盘读取，只对未命中的图像推理
+static inference_cache::cache inference_cache_;
 
 static int img_index_ = 1;
 
+static plate_render::renderer plate_renderer_(1);
+
 int inference(ax_algorithm_handle_t handle, cv::Mat &image)
 {
     ax_image_t image_rgb;
@@ -30,9 +40,21 @@ int inference(ax_algorithm_handle_t handle, cv::Mat &image)
 
     ax_result_t result;
     memset(&result, 0, sizeof(ax_result_t));
-    ax_algorithm_detect(handle, &image_rgb, &result);
+    if (inference_cache_.is_open())
+    {
+        inference_cache_.detect(handle, &image_rgb, &result);
+    }
+    else
+    {
+        ax_algorithm_detect(handle, &image_rgb, &result);
+    }
     ax_release_image(&image_rgb);
 
+    if (sweep_cache_.is_open())
+    {
+        sweep_cache_.write(img_index_, -1, 0, result);
+    }
+
     for (int i = 0; i < result.n_objects; i++)
     {
         auto &box = result.objects[i];
@@ -47,7 +69,7 @@ int inference(ax_algorithm_handle_t handle, cv::Mat &image)
             }
 
             cv::putText(image, std::to_string(box.person_info.status) + " " + std::to_string(box.track_id), cv::Point(box.bbox.x, box.bbox.y), cv::FONT_HERSHEY_SIMPLEX, 1, cv::Scalar(255, 0, 0), 2);
-            printf("status: %d, track_id: %d\n", box.person_info.status, box.track_id);
+            ASYNC_LOG(ax_log_info, "status: %d, track_id: %lu\n", box.person_info.status, box.track_id);
         }
         break;
         case ax_model_type_face_detection:
@@ -57,40 +79,22 @@ int inference(ax_algorithm_handle_t handle, cv::Mat &image)
             {
                 cv::circle(image, cv::Point(box.face_info.points[j].x, box.face_info.points[j].y), 2, cv::Scalar(0, 0, 255), 1);
             }
-            printf("track_id: %d quality: %0.2f \n", box.track_id, box.face_info.quality);
+            ASYNC_LOG(ax_log_info, "track_id: %lu quality: %0.2f \n", box.track_id, box.face_info.quality);
         }
         break;
         case ax_model_type_lpr:
         {
             char license[32] = {0};
             ax_algorithm_get_plate_str(box.vehicle_info.plate_id, box.vehicle_info.len_plate_id, license);
-            printf("license: %s cartype: %d\n", license, box.vehicle_info.cartype);
-            ax_point_t org = {box.bbox.x + box.bbox.w / 2, box.bbox.y + box.bbox.h / 2};
-            unsigned char color[3] = {0, 0, 255};
-            ax_image_t ax_image_rgb = {0};
-            ax_image_rgb.nWidth = image.cols;
-            ax_image_rgb.nHeight = image.rows;
-            ax_image_rgb.pVir = image.data;
-            putTextPlateID(&ax_image_rgb, box.vehicle_info.plate_id, box.vehicle_info.len_plate_id, &org, color, 1);
+            ASYNC_LOG(ax_log_info, "license: %s cartype: %d\n", license, box.vehicle_info.cartype);
         }
         break;
         case ax_model_type_fire_smoke:
         {
             cv::putText(image, std::to_string(box.fire_smoke_info.label) + " " + std::to_string(box.track_id), cv::Point(box.bbox.x, box.bbox.y), cv::FONT_HERSHEY_SIMPLEX, 1, cv::Scalar(255, 0, 0), 2);
-            printf("idx: %d label: %d, track_id: %d label: %d score: %0.2f\n", i ,box.label, box.track_id, box.fire_smoke_info.label, box.score);
-
-            json bbox = nlohmann::json::array();
-            bbox.push_back(box.bbox.x);
-            bbox.push_back(box.bbox.y);
-            bbox.push_back(box.bbox.w);
-            bbox.push_back(box.bbox.h);
-
-            json item;
-            item["image_id"] = img_index_;
-            item["category_id"] = box.label;
-            item["bbox"] = bbox;
-            item["score"] = box.score;
-            image_arr_.push_back(item);
+            ASYNC_LOG(ax_log_info, "idx: %d label: %d, track_id: %lu label: %d score: %0.2f\n", i, box.label, box.track_id, box.fire_smoke_info.label, box.score);
+
+            result_writer_.write(img_index_, box.label, box.bbox, box.score);
         }
         break;
         default:
@@ -98,20 +102,21 @@ int inference(ax_algorithm_handle_t handle, cv::Mat &image)
         }
     }
 
+    // 整帧的车牌文字一次绘制
+    if (result.model_type == ax_model_type_lpr)
+    {
+        unsigned char color[3] = {0, 0, 255};
+        ax_image_t ax_image_rgb = {0};
+        ax_image_rgb.nWidth = image.cols;
+        ax_image_rgb.nHeight = image.rows;
+        ax_image_rgb.pVir = image.data;
+        plate_renderer_.draw(&ax_image_rgb, &result, color);
+    }
+
     // 没有检测到结果时
     if (result.n_objects == 0) {
-        json bbox = nlohmann::json::array();
-        bbox.push_back(-1);
-        bbox.push_back(-1);
-        bbox.push_back(-1);
-        bbox.push_back(-1);
-
-        json item;
-        item["image_id"] = img_index_;
-        item["category_id"] = -1;
-        item["bbox"] = bbox;
-        item["score"] = -1;
-        image_arr_.push_back(item);
+        ax_bbox_t none = {-1, -1, -1, -1};
+        result_writer_.write(img_index_, -1, none, -1);
     }
 
     img_index_++;
@@ -126,7 +131,12 @@ int main(int argc, char *argv[])
     parser.add<int>("model_type", 't', "model type 0:person detection 2:lpr 3:face detection 5:fire smoke", true);
     parser.add<std::string>("image", 'i', "image path", true);
     parser.add<std::string>("output", 'o', "output path", false, "plate_result");
+    parser.add<std::string>("cache_dir", 0, "detect result cache directory, empty disables the cache", false, "");
+    parser.add<int>("cache_size_mb", 0, "detect result cache size limit", false, 1024);
+    parser.add<std::string>("sweep_cache", 0, "cache raw candidates for threshold_sweep (all thresholds set to sweep_floor)", false, "");
+    parser.add<float>("sweep_floor", 0, "lowest threshold of the sweep", false, 0.05f);
     parser.parse_check(argc, argv);
+    async_log::start();
 
     int ret = AX_SYS_Init();
     if (0 != ret)
@@ -161,17 +171,49 @@ int main(int argc, char *argv[])
     sprintf(init_info.license_path, "/opt/bin/BoxDemo/ax_algorithm_license/");
     init_info.param = ax_algorithm_get_default_param();
 
+    std::string sweep_cache_path = parser.get<std::string>("sweep_cache");
+    if (!sweep_cache_path.empty())
+    {
+        // 阈值越低候选越多，但每帧最多 AX_ALGORITHM_MAX_OBJ_NUM 个，floor 不宜过低
+        float floor = parser.get<float>("sweep_floor");
+        init_info.param.face_param.det_threshold = floor;
+        init_info.param.face_param.quality_threshold = floor;
+        init_info.param.person_param.det_threshold = floor;
+        init_info.param.vehicle_param.det_threshold = floor;
+        init_info.param.fire_smoke_param.det_threshold = floor;
+        if (sweep_cache_.open(sweep_cache_path) != 0)
+        {
+            printf("open %s failed\n", sweep_cache_path.c_str());
+            return -1;
+        }
+    }
+
     if (ax_algorithm_init(&init_info, &handle) != 0)
     {
         return -1;
     }
 
+    std::string cache_dir = parser.get<std::string>("cache_dir");
+    if (!cache_dir.empty() && inference_cache_.open(cache_dir, init_info, (unsigned long long)parser.get<int>("cache_size_mb") << 20) != 0)
+    {
+        printf("open inference cache %s failed\n", cache_dir.c_str());
+        return -1;
+    }
+
     // output_path exists
     if (access(output_path.c_str(), 0) != 0)
     {
         mkdir(output_path.c_str(), 0755);
     }
 
+    // 结果边运行边追加到 output.jsonl，结束时再转换成 output.json
+    std::string out_jsonl_path = output_path + "output.jsonl";
+    if (result_writer_.open(out_jsonl_path) != 0)
+    {
+        printf("open %s failed\n", out_jsonl_path.c_str());
+        return -1;
+    }
+
     cv::Mat image = cv::imread(image_path);
     if (image.data)
     {
@@ -183,14 +225,6 @@ int main(int argc, char *argv[])
         auto out_path = string_utils::join(output_path, string_utils::basename(image_path));
         printf("out_path: %s\n", out_path.c_str());
 
-        std::string image_arr_str = image_arr_.dump(4, ' ');
-        std::string out_json_path = output_path + "output.json";
-        std::ofstream ofs(out_json_path.c_str(), std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
-        if (ofs.is_open()) {
-            ofs.write((const char*)image_arr_str.c_str(), image_arr_str.length());
-            ofs.close();
-        }
-
         cv::imwrite(out_path, image);
     }
     else
@@ -211,19 +245,25 @@ int main(int argc, char *argv[])
                 auto out_path = string_utils::join(output_path, string_utils::basename(image_path_));
                 printf("out_path: %s\n", out_path.c_str());
 
-                std::string image_arr_str = image_arr_.dump(4, ' ');
-                std::string out_json_path = output_path + "output.json";
-                std::ofstream ofs(out_json_path.c_str(), std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
-                if (ofs.is_open()) {
-                    ofs.write((const char*)image_arr_str.c_str(), image_arr_str.length());
-                    ofs.close();
-                }
-
                 cv::imwrite(out_path, image);
             }
         }
     }
+    result_writer_.close();
+    sweep_cache_.close();
+    std::string out_json_path = output_path + "output.json";
+    if (result_writer::finalize(out_jsonl_path, out_json_path) != 0)
+    {
+        printf("write %s failed\n", out_json_path.c_str());
+    }
+
+    if (inference_cache_.is_open())
+    {
+        inference_cache::cache::print_stats(inference_cache_.get_stats());
+    }
+
     ax_algorithm_deinit(handle);
+    async_log::stop();
     AX_ENGINE_Deinit();
     AX_IVPS_Deinit();
     AX_SYS_Deinit();
@@ -0,0 +1,304 @@
+#include <unistd.h>
+#include <sys/stat.h>
+#include <fstream>
+
+#include <ax_sys_api.h>
+#include <ax_ivps_api.h>
+#include <ax_engine_api.h>
+#include <signal.h>
+#include <opencv2/opencv.hpp>
+#include <nlohmann/json.hpp>
+
+#include "ax_algorithm_sdk.h"
+#include "cmdline.hpp"
+#include "bench_utils.hpp"
+#include "memory_usage.hpp"
+
+#define ALIGN_UP(x, align) ((((x) + ((align) - 1)) / (align)) * (align))
+
+using json = nlohmann::json;
+
+enum
+{
+    stage_decode = 0,
+    stage_resize,
+    stage_cvtcolor,
+    stage_create_image,
+    stage_memcpy,
+    stage_algorithm,
+    stage_postprocess,
+    stage_release,
+    stage_total,
+    stage_end
+};
+
+// stage_algorithm 的名称按实际调用的接口在 main 中设置
+static const char *stage_names[stage_end] = {
+    "decode", "resize", "cvtColor", "ax_create_image", "memcpy", "ax_algorithm_track", "postprocess", "release", "total"};
+
+static bool read_file(const std::string &path, std::vector<unsigned char> &data)
+{
+    std::ifstream fs(path, std::ios::in | std::ios::binary);
+    if (!fs.is_open())
+    {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(fs), std::istreambuf_iterator<char>());
+    return !data.empty();
+}
+
+volatile int gLoopExit = 0;
+extern "C" void __sigExit(int iSigNo)
+{
+    gLoopExit = 1;
+    return;
+}
+
+static json summary_to_json(const bench_utils::summary_t &s)
+{
+    json j;
+    j["count"] = s.count;
+    j["mean_us"] = s.mean;
+    j["min_us"] = s.min;
+    j["p50_us"] = s.p50;
+    j["p90_us"] = s.p90;
+    j["p99_us"] = s.p99;
+    j["max_us"] = s.max;
+    return j;
+}
+
+int main(int argc, char *argv[])
+{
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, __sigExit);
+    cmdline::parser parser;
+    parser.add<std::string>("model", 'm', "model path", true);
+    parser.add<int>("model_type", 't', "model type 0:person detection 2:lpr 3:face detection 5:fire smoke", true);
+    parser.add<std::string>("image", 'i', "image path or directory", true);
+    parser.add<int>("warmup", 'w', "warm-up iterations, not counted", false, 20);
+    parser.add<int>("iterations", 'n', "measured iterations, 0 means use duration", false, 1000);
+    parser.add<int>("duration", 'd', "measured duration in seconds when iterations is 0", false, 60);
+    parser.add<std::string>("report", 'r', "json report path", false, "benchmark.json");
+    parser.add("detect", '\0', "use ax_algorithm_detect instead of ax_algorithm_track");
+    parser.parse_check(argc, argv);
+
+    int ret = AX_SYS_Init();
+    if (0 != ret)
+    {
+        printf("AX_SYS_Init failed\n");
+        return -1;
+    }
+    ret = AX_IVPS_Init();
+    if (0 != ret)
+    {
+        printf("AX_IVPS_Init failed\n");
+        return -1;
+    }
+    AX_ENGINE_NPU_ATTR_T npu_attr;
+    memset(&npu_attr, 0, sizeof(npu_attr));
+    npu_attr.eHardMode = AX_ENGINE_VIRTUAL_NPU_STD;
+    ret = AX_ENGINE_Init(&npu_attr);
+    if (0 != ret)
+    {
+        printf("AX_ENGINE_Init failed\n");
+        return -1;
+    }
+
+    std::string model_path = parser.get<std::string>("model");
+    std::string image_path = parser.get<std::string>("image");
+    int warmup = parser.get<int>("warmup");
+    int iterations = parser.get<int>("iterations");
+    int duration = parser.get<int>("duration");
+    bool use_detect = parser.exist("detect");
+
+    // 预先把所有输入读入内存，测试过程中不再访问磁盘
+    std::vector<std::string> image_list;
+    struct stat st;
+    if (stat(image_path.c_str(), &st) == 0 && S_ISDIR(st.st_mode))
+    {
+        cv::glob(image_path + "/*.*", image_list);
+    }
+    else
+    {
+        image_list.push_back(image_path);
+    }
+    // 预加载时解码一次，丢弃读不出或解码失败的文件，测试循环中不会出现空图
+    std::vector<std::vector<unsigned char>> inputs;
+    std::vector<std::string> bad_inputs;
+    for (auto &path : image_list)
+    {
+        std::vector<unsigned char> data;
+        if (!read_file(path, data) || cv::imdecode(data, cv::IMREAD_COLOR).empty())
+        {
+            printf("skip %s: read or decode failed\n", path.c_str());
+            bad_inputs.push_back(path);
+            continue;
+        }
+        inputs.push_back(std::move(data));
+    }
+    if (inputs.empty())
+    {
+        printf("no input image in %s\n", image_path.c_str());
+        return -1;
+    }
+    printf("preloaded %zu images, %zu skipped\n", inputs.size(), bad_inputs.size());
+    stage_names[stage_algorithm] = use_detect ? "ax_algorithm_detect" : "ax_algorithm_track";
+
+    ax_algorithm_handle_t handle;
+    ax_algorithm_init_t init_info;
+    init_info.model_type = (ax_model_type_e)parser.get<int>("model_type");
+    sprintf(init_info.model_file, model_path.c_str());
+    init_info.param = ax_algorithm_get_default_param();
+
+    double t_init = bench_utils::now_us();
+    if (memory_usage::init(&init_info, &handle) != 0)
+    {
+        return -1;
+    }
+    t_init = bench_utils::now_us() - t_init;
+
+    bench_utils::latency_recorder stages[stage_end];
+    long long n_objects = 0;
+    long long n_fail = 0;
+    bench_utils::cpu_meter cpu;
+    double t_start = 0;
+
+    for (long long iter = 0; gLoopExit == 0; iter++)
+    {
+        bool measure = iter >= warmup;
+        long long measured = iter - warmup;
+        if (measure && measured == 0)
+        {
+            for (auto &s : stages)
+            {
+                s.clear();
+            }
+            n_objects = 0;
+            n_fail = 0;
+            cpu.start();
+            t_start = bench_utils::now_us();
+        }
+        if (measure && iterations > 0 && measured >= iterations)
+        {
+            break;
+        }
+        if (measure && iterations <= 0 && bench_utils::now_us() - t_start >= duration * 1e6)
+        {
+            break;
+        }
+
+        double t[stage_end + 1];
+        auto &input = inputs[iter % inputs.size()];
+        t[0] = bench_utils::now_us();
+        cv::Mat image = cv::imdecode(input, cv::IMREAD_COLOR);
+        t[1] = bench_utils::now_us();
+        cv::resize(image, image, cv::Size(ALIGN_UP(image.cols, 128), ALIGN_UP(image.rows, 128)));
+        t[2] = bench_utils::now_us();
+        cv::cvtColor(image, image, cv::COLOR_BGR2RGB);
+        t[3] = bench_utils::now_us();
+        ax_image_t image_rgb;
+        memory_usage::create_image(image.cols, image.rows, image.cols, ax_color_space_rgb, &image_rgb);
+        t[4] = bench_utils::now_us();
+        memcpy(image_rgb.pVir, image.data, image_rgb.nSize);
+        t[5] = bench_utils::now_us();
+
+        ax_result_t result;
+        memset(&result, 0, sizeof(ax_result_t));
+        ret = use_detect ? ax_algorithm_detect(handle, &image_rgb, &result) : ax_algorithm_track(handle, &image_rgb, &result);
+        t[6] = bench_utils::now_us();
+
+        // 与示例程序相同的结果处理，不打印
+        for (int i = 0; i < result.n_objects; i++)
+        {
+            auto &box = result.objects[i];
+            if (result.model_type == ax_model_type_lpr)
+            {
+                char license[32] = {0};
+                ax_algorithm_get_plate_str(box.vehicle_info.plate_id, box.vehicle_info.len_plate_id, license);
+            }
+        }
+        t[7] = bench_utils::now_us();
+        memory_usage::release_image(&image_rgb);
+        t[8] = bench_utils::now_us();
+
+        if (!measure)
+        {
+            continue;
+        }
+        for (int s = 0; s < stage_total; s++)
+        {
+            stages[s].add(t[s + 1] - t[s]);
+        }
+        stages[stage_total].add(t[8] - t[0]);
+        n_objects += result.n_objects;
+        n_fail += ret != 0;
+    }
+
+    if (t_start == 0)
+    {
+        // 预热期间收到 SIGINT，计时阶段没有开始，不输出统计和报告
+        printf("interrupted during warm-up, nothing measured\n");
+        memory_usage::deinit(handle);
+        AX_ENGINE_Deinit();
+        AX_IVPS_Deinit();
+        AX_SYS_Deinit();
+        return -1;
+    }
+
+    double elapsed = bench_utils::now_us() - t_start;
+    double cpu_usage = cpu.usage();
+    size_t frames = stages[stage_total].count();
+    double fps = elapsed > 0 ? frames * 1e6 / elapsed : 0;
+
+    json report;
+    report["model_file"] = model_path;
+    report["model_type"] = (int)init_info.model_type;
+    report["api"] = use_detect ? "ax_algorithm_detect" : "ax_algorithm_track";
+    report["inputs"] = inputs.size();
+    report["skipped_inputs"] = bad_inputs;
+    report["warmup"] = warmup;
+    report["frames"] = frames;
+    report["interrupted"] = gLoopExit != 0;
+    report["elapsed_s"] = elapsed / 1e6;
+    report["fps"] = fps;
+    report["cpu_usage"] = cpu_usage;
+    report["init_ms"] = t_init / 1e3;
+    report["objects_per_frame"] = frames ? (double)n_objects / frames : 0;
+    report["failures"] = n_fail;
+    for (int s = 0; s < stage_end; s++)
+    {
+        auto sum = stages[s].summarize();
+        bench_utils::print_summary(stage_names[s], sum);
+        report["stages"][stage_names[s]] = summary_to_json(sum);
+    }
+    memory_usage::handle_usage_t handle_usage;
+    memory_usage::global_usage_t global_usage;
+    memory_usage::get_handle_usage(handle, &handle_usage);
+    memory_usage::get_global_usage(&global_usage);
+    memory_usage::print_global_usage(global_usage);
+    report["memory"]["handle_cmm_bytes"] = handle_usage.cmm_bytes;
+    report["memory"]["handle_heap_bytes"] = handle_usage.heap_bytes;
+    report["memory"]["image_bytes_peak"] = global_usage.image_bytes_peak;
+    report["memory"]["cmm_used_peak"] = global_usage.cmm_used_peak;
+    report["memory"]["rss_peak"] = global_usage.rss_peak;
+
+    printf("frames: %zu fps: %.2f cpu: %.1f%% objects/frame: %.2f failures: %lld\n",
+           frames, fps, cpu_usage, frames ? (double)n_objects / frames : 0, n_fail);
+
+    std::string report_path = parser.get<std::string>("report");
+    std::string report_str = report.dump(4, ' ');
+    std::ofstream ofs(report_path.c_str(), std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+    if (ofs.is_open())
+    {
+        ofs.write(report_str.c_str(), report_str.length());
+        ofs.close();
+        printf("report: %s\n", report_path.c_str());
+    }
+
+    memory_usage::deinit(handle);
+    AX_ENGINE_Deinit();
+    AX_IVPS_Deinit();
+    AX_SYS_Deinit();
+
+    return 0;
+}
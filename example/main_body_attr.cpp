@@ -11,6 +11,10 @@
 #include "cmdline.hpp"
 #include "string_utils.hpp"
 #include "putTextPlate.h"
+#include "body_attr_cache.hpp"
+#include "startup_profile.hpp"
+#include "model_package.hpp"
+#include "async_log.hpp"
 
 #define ALIGN_UP(x, align) ((((x) + ((align) - 1)) / (align)) * (align))
 
@@ -51,6 +55,14 @@ std::string get_attr_str(std::string name, unsigned char lab)
     return "\033[1;30;32m" + g_attr_label_map[name][lab] + "\033[0m";
 }
 
+// 按 track_id 平滑人体属性，属性收敛后不再逐帧推理
+static body_attr_cache::cache attr_cache_;
+
+// 静态初始化时开始计时，首次检测完成后打印启动耗时分解
+static startup_profile::profiler startup_;
+
+static model_package::package package_;
+
 int inference(ax_algorithm_handle_t handle_det, ax_algorithm_handle_t handle_attr, cv::Mat &image)
 {
     ax_image_t image_rgb;
@@ -59,21 +71,30 @@ int inference(ax_algorithm_handle_t handle_det, ax_algorithm_handle_t handle_att
 
     ax_result_t result;
     memset(&result, 0, sizeof(ax_result_t));
-    ax_algorithm_inference(handle_det, &image_rgb, &result);
+    ax_algorithm_track(handle_det, &image_rgb, &result);
+
+    static bool first_detection = true;
+    if (first_detection)
+    {
+        first_detection = false;
+        startup_.mark("first detection");
+        startup_.print();
+    }
 
+    attr_cache_.next_frame();
     for (int i = 0; i < result.n_objects; i++)
     {
         ax_body_attr_t body_attr = {0};
         auto &box = result.objects[i];
         // 设置track_id，用作历史状态跟踪
         body_attr.track_id = box.track_id;
-        int ret = ax_algorithm_get_body_attr(handle_attr, &image_rgb, &box.bbox, &body_attr);
+        int ret = attr_cache_.get(handle_attr, &image_rgb, &box.bbox, &body_attr);
         if (ret != 0)
         {
-            printf("track_id:%d get body attr failed, ret:%d\n", box.track_id, ret);
+            ASYNC_LOG(ax_log_error, "track_id:%lu get body attr failed, ret:%d\n", box.track_id, ret);
             continue;
         }
-        printf("track_id:%d umbrella: %s headwear: %s glasses: %s faceMask: %s smoke: %s carryingItem: %s cellphone: %s safetyClothing: %s upperWear: %s upperColor: %s upperWearFg: %s upperWearTexture: %s bag: %s safetyRope: %s upperCut: %s lowerWear: %s lowerColor: %s vehicle: %s lowerCut: %s occlusion: %s orientation: %s isHuman: %s gender: %s race: %s age: %s \n",
+        ASYNC_LOG(ax_log_info, "track_id:%lu umbrella: %s headwear: %s glasses: %s faceMask: %s smoke: %s carryingItem: %s cellphone: %s safetyClothing: %s upperWear: %s upperColor: %s upperWearFg: %s upperWearTexture: %s bag: %s safetyRope: %s upperCut: %s lowerWear: %s lowerColor: %s vehicle: %s lowerCut: %s occlusion: %s orientation: %s isHuman: %s gender: %s race: %s age: %s \n",
                box.track_id,
                get_attr_str("umbrella", body_attr.umbrella).c_str(),
                get_attr_str("headwear", body_attr.headwear).c_str(),
@@ -118,7 +139,7 @@ int inference(ax_algorithm_handle_t handle_det, ax_algorithm_handle_t handle_att
             }
 
             cv::putText(image, std::to_string(box.person_info.status) + " " + std::to_string(box.track_id), cv::Point(box.bbox.x, box.bbox.y), cv::FONT_HERSHEY_SIMPLEX, 1, cv::Scalar(255, 0, 0), 2);
-            printf("status: %d, track_id: %d\n", box.person_info.status, box.track_id);
+            ASYNC_LOG(ax_log_info, "status: %d, track_id: %lu\n", box.person_info.status, box.track_id);
         }
         break;
         default:
@@ -135,8 +156,11 @@ int main(int argc, char *argv[])
     parser.add<std::string>("model", 'm', "model path", true);
     parser.add<std::string>("image", 'i', "image path", true);
     parser.add<std::string>("output", 'o', "output path", false, "plate_result");
+    parser.add("serial_init", 0, "initialise the detector and attribute handles one after the other");
     parser.parse_check(argc, argv);
+    async_log::start();
 
+    int bsp_phase = startup_.begin("bsp init");
     int ret = AX_SYS_Init();
     if (0 != ret)
     {
@@ -158,6 +182,7 @@ int main(int argc, char *argv[])
         printf("AX_ENGINE_Init failed\n");
         return -1;
     }
+    startup_.end(bsp_phase);
 
     std::string model_path = parser.get<std::string>("model");
     std::string image_path = parser.get<std::string>("image");
@@ -166,28 +191,36 @@ int main(int argc, char *argv[])
     ax_algorithm_handle_t handle_det, handle_attr;
 
     {
-        ax_algorithm_init_t init_info;
-        init_info.model_type = ax_model_type_person_detection;
-        sprintf(init_info.model_file, model_path.c_str());
-        init_info.param = ax_algorithm_get_default_param();
-
-        if (ax_algorithm_init(&init_info, &handle_det) != 0)
+        // 检测和属性在同一个模型包中：只读一次文件，两个子句柄同时初始化
+        if (package_.open(model_path, "", &startup_) != 0)
         {
+            printf("read model %s failed\n", model_path.c_str());
             return -1;
         }
-    }
-
-    {
-        ax_algorithm_init_t init_info;
-        init_info.model_type = ax_model_type_person_attr;
-        sprintf(init_info.model_file, model_path.c_str());
-        init_info.param = ax_algorithm_get_default_param();
-
-        if (ax_algorithm_init(&init_info, &handle_attr) != 0)
+        std::vector<ax_algorithm_handle_t> handles;
+        if (package_.acquire_all({ax_model_type_person_detection, ax_model_type_person_attr}, handles,
+                                 model_package::share_auto, nullptr, !parser.exist("serial_init")) != 0)
         {
             return -1;
         }
+        handle_det = handles[0];
+        handle_attr = handles[1];
     }
+
+    {
+        // 第一次推理包含 NPU 上下文和缓冲区的延迟分配，用空白图像提前完成
+        startup_profile::scoped_phase phase(&startup_, "warm-up");
+        ax_image_t warm_image;
+        ax_create_image(640, 384, 640, ax_color_space_rgb, &warm_image);
+        memset(warm_image.pVir, 0, warm_image.nSize);
+        ax_result_t warm_result;
+        ax_algorithm_detect(handle_det, &warm_image, &warm_result);
+        ax_bbox_t warm_bbox = {0, 0, 64, 128};
+        ax_body_attr_t warm_attr = {0};
+        ax_algorithm_get_body_attr(handle_attr, &warm_image, &warm_bbox, &warm_attr);
+        ax_release_image(&warm_image);
+    }
+
     // output_path exists
     if (access(output_path.c_str(), 0) != 0)
     {
@@ -228,8 +261,9 @@ int main(int argc, char *argv[])
             }
         }
     }
-    ax_algorithm_deinit(handle_det);
-    ax_algorithm_deinit(handle_attr);
+    package_.release(handle_det);
+    package_.release(handle_attr);
+    async_log::stop();
     AX_ENGINE_Deinit();
     AX_IVPS_Deinit();
     AX_SYS_Deinit();
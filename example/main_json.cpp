@@ -7,16 +7,18 @@
 #include <ax_engine_api.h>
 
 #include <opencv2/opencv.hpp>
-#include <nlohmann/json.hpp>
 
 #include "ax_algorithm_sdk.h"
 #include "cmdline.hpp"
+#include "inference_cache.hpp"
+#include "result_writer.hpp"
 #include "string_utils.hpp"
 #include "putTextPlate.h"
 
-using json = nlohmann::json;
+static result_writer::jsonl_writer result_writer_;
 
-static json image_arr_ = nlohmann::json::array();
+// --cache_dir 打开时相同图像、模型和参数的检测结果直接从磁盘读取，只对未命中的图像推理
+static inference_cache::cache inference_cache_;
 
 #define ALIGN_UP(x, align) ((((x) + ((align) - 1)) / (align)) * (align))
 
@@ -28,7 +30,14 @@ int inference(ax_algorithm_handle_t handle, cv::Mat &image)
 
     ax_result_t result;
     memset(&result, 0, sizeof(ax_result_t));
-    ax_algorithm_inference(handle, &image_rgb, &result);
+    if (inference_cache_.is_open())
+    {
+        inference_cache_.detect(handle, &image_rgb, &result);
+    }
+    else
+    {
+        ax_algorithm_detect(handle, &image_rgb, &result);
+    }
     ax_release_image(&image_rgb);
 
     for (int i = 0; i < result.n_objects; i++)
@@ -37,7 +46,7 @@ int inference(ax_algorithm_handle_t handle, cv::Mat &image)
         cv::rectangle(image, cv::Rect(box.bbox.x, box.bbox.y, box.bbox.w, box.bbox.h), cv::Scalar(255, 0, 0), 2);
         switch (result.model_type)
         {
-        case ax_model_type_person:
+        case ax_model_type_person_detection:
         {
             if (box.person_info.status == 3)
             {
@@ -77,18 +86,7 @@ int inference(ax_algorithm_handle_t handle, cv::Mat &image)
             cv::putText(image, std::to_string(box.label) + " " + std::to_string(box.track_id), cv::Point(box.bbox.x, box.bbox.y), cv::FONT_HERSHEY_SIMPLEX, 1, cv::Scalar(255, 0, 0), 2);
             printf("status: %d, track_id: %d label: %d score: %0.2f\n", box.label, box.track_id, box.label, box.score);
 
-            json bbox = nlohmann::json::array();
-            bbox.push_back(box.bbox.x);
-            bbox.push_back(box.bbox.y);
-            bbox.push_back(box.bbox.w);
-            bbox.push_back(box.bbox.h);
-
-            json item;
-            item["image_id"] = box.track_id;
-            item["category_id"] = box.label;
-            item["bbox"] = bbox;
-            item["score"] = box.score;
-            image_arr_.push_back(item);
+            result_writer_.write(box.track_id, box.label, box.bbox, box.score);
         }
         break;
         default:
@@ -106,6 +104,8 @@ int main(int argc, char *argv[])
     parser.add<int>("model_type", 't', "model type 0:person 1:lpr 2:face 3:fire smoke", true);
     parser.add<std::string>("image", 'i', "image path", true);
     parser.add<std::string>("output", 'o', "output path", false, "plate_result");
+    parser.add<std::string>("cache_dir", 0, "detect result cache directory, empty disables the cache", false, "");
+    parser.add<int>("cache_size_mb", 0, "detect result cache size limit", false, 1024);
     parser.parse_check(argc, argv);
 
     int ret = AX_SYS_Init();
@@ -145,12 +145,27 @@ int main(int argc, char *argv[])
         return -1;
     }
 
+    std::string cache_dir = parser.get<std::string>("cache_dir");
+    if (!cache_dir.empty() && inference_cache_.open(cache_dir, init_info, (unsigned long long)parser.get<int>("cache_size_mb") << 20) != 0)
+    {
+        printf("open inference cache %s failed\n", cache_dir.c_str());
+        return -1;
+    }
+
     // output_path exists
     if (access(output_path.c_str(), 0) != 0)
     {
         mkdir(output_path.c_str(), 0755);
     }
 
+    // 结果边运行边追加到 output.jsonl，结束时再转换成 output.json
+    std::string out_jsonl_path = output_path + "output.jsonl";
+    if (result_writer_.open(out_jsonl_path) != 0)
+    {
+        printf("open %s failed\n", out_jsonl_path.c_str());
+        return -1;
+    }
+
     cv::Mat image = cv::imread(image_path);
     if (image.data)
     {
@@ -162,14 +177,6 @@ int main(int argc, char *argv[])
         auto out_path = string_utils::join(output_path, string_utils::basename(image_path));
         printf("out_path: %s\n", out_path.c_str());
 
-        std::string image_arr_str = image_arr_.dump(4, ' ');
-        std::string out_json_path = output_path + "output.json";
-        std::ofstream ofs(out_json_path.c_str(), std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
-        if (ofs.is_open()) {
-            ofs.write((const char*)image_arr_str.c_str(), image_arr_str.length());
-            ofs.close();
-        }
-
         cv::imwrite(out_path, image);
     }
     else
@@ -190,18 +197,22 @@ int main(int argc, char *argv[])
                 auto out_path = string_utils::join(output_path, string_utils::basename(image_path_));
                 printf("out_path: %s\n", out_path.c_str());
 
-                std::string image_arr_str = image_arr_.dump(4, ' ');
-                std::string out_json_path = output_path + "output.json";
-                std::ofstream ofs(out_json_path.c_str(), std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
-                if (ofs.is_open()) {
-                    ofs.write((const char*)image_arr_str.c_str(), image_arr_str.length());
-                    ofs.close();
-                }
-
                 cv::imwrite(out_path, image);
             }
         }
     }
+    result_writer_.close();
+    std::string out_json_path = output_path + "output.json";
+    if (result_writer::finalize(out_jsonl_path, out_json_path) != 0)
+    {
+        printf("write %s failed\n", out_json_path.c_str());
+    }
+
+    if (inference_cache_.is_open())
+    {
+        inference_cache::cache::print_stats(inference_cache_.get_stats());
+    }
+
     ax_algorithm_deinit(handle);
     AX_ENGINE_Deinit();
     AX_IVPS_Deinit();
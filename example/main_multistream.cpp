@@ -0,0 +1,456 @@
+#include <unistd.h>
+#include <sys/stat.h>
+#include <fstream>
+#include <memory>
+#include <thread>
+
+#include <ax_sys_api.h>
+#include <ax_ivps_api.h>
+#include <ax_engine_api.h>
+#include <signal.h>
+#include <opencv2/opencv.hpp>
+#include <nlohmann/json.hpp>
+
+#include "ax_algorithm_sdk.h"
+#include "cmdline.hpp"
+#include "string_utils.hpp"
+#include "bench_utils.hpp"
+#include "algorithm_stats.hpp"
+#include "trace.hpp"
+#include "param_snapshot.hpp"
+
+#define ALIGN_UP(x, align) ((((x) + ((align) - 1)) / (align)) * (align))
+
+using json = nlohmann::json;
+
+volatile int gLoopExit = 0;
+extern "C" void __sigExit(int iSigNo)
+{
+    gLoopExit = 1;
+    return;
+}
+
+struct stream_t
+{
+    int id;
+    ax_algorithm_handle_t handle;
+    param_snapshot::bound_handle *bound;
+    const ax_algorithm_param_t *param; // 本路的阈值，为空时使用共享快照
+    ax_model_type_e model_type;
+    ax_image_t image;
+    double next_due;
+    long long frames;
+    long long failures;
+    bench_utils::latency_recorder latency;
+};
+
+struct point_t
+{
+    int streams;
+    double fps;
+    bench_utils::summary_t latency;
+    double worst_stream_p99;
+    double queue_wait_ms;
+    double cpu_usage;
+    unsigned long long set_param_calls; // 累计值，各路阈值不同时每次切换都会调用
+};
+
+static int run_frame(stream_t &s)
+{
+    ax_result_t result;
+    memset(&result, 0, sizeof(ax_result_t));
+    // run_frame 包含等待句柄锁(bound_handle_wait)，SDK 调用本身单独记录
+    trace::scope scope("run_frame", s.id, s.frames);
+    if (s.model_type == ax_model_type_face_recognition)
+    {
+        float feature[AX_ALGORITHM_FACE_FEATURE_LEN];
+        return s.bound->call([&](ax_algorithm_handle_t handle)
+                             {
+            trace::scope call_scope("ax_algorithm_get_face_feature", s.id, s.frames);
+            return algorithm_stats::get_face_feature(handle, &s.image, &result, -1, feature); });
+    }
+    return s.bound->track(&s.image, &result, s.param, [&](ax_algorithm_handle_t handle, ax_image_t *image, ax_result_t *r)
+                          {
+        trace::scope call_scope("ax_algorithm_track", s.id, s.frames);
+        return algorithm_stats::track(handle, image, r); });
+}
+
+static float *det_threshold(ax_algorithm_param_t &param, ax_model_type_e model_type)
+{
+    switch (model_type)
+    {
+    case ax_model_type_person_detection:
+        return &param.person_param.det_threshold;
+    case ax_model_type_lpr:
+        return &param.vehicle_param.det_threshold;
+    case ax_model_type_face_detection:
+        return &param.face_param.det_threshold;
+    case ax_model_type_fire_smoke:
+        return &param.fire_smoke_param.det_threshold;
+    default:
+        return nullptr;
+    }
+}
+
+// 一个线程轮流驱动分配给它的若干路视频，fps > 0 时按固定帧率，否则尽可能快
+static void worker(std::vector<stream_t *> streams, double fps, double t_end)
+{
+    double interval = fps > 0 ? 1e6 / fps : 0;
+    while (gLoopExit == 0)
+    {
+        stream_t *s = streams[0];
+        for (auto *c : streams)
+        {
+            if (c->next_due < s->next_due)
+            {
+                s = c;
+            }
+        }
+        double now = bench_utils::now_us();
+        if (s->next_due >= t_end || now >= t_end)
+        {
+            break;
+        }
+        if (s->next_due > now)
+        {
+            usleep((useconds_t)(s->next_due - now));
+        }
+
+        double t0 = bench_utils::now_us();
+        int ret = run_frame(*s);
+        double t1 = bench_utils::now_us();
+        // 固定帧率时延迟从帧的计划时间算起，包含排队
+        s->latency.add(t1 - (interval > 0 ? s->next_due : t0));
+        s->frames++;
+        s->failures += ret != 0;
+        s->next_due = interval > 0 ? s->next_due + interval : t1;
+    }
+}
+
+static std::vector<int> parse_int_list(const std::string &str)
+{
+    std::vector<int> values;
+    for (auto &item : string_utils::split(str, ","))
+    {
+        values.push_back(atoi(item.c_str()));
+    }
+    return values;
+}
+
+static std::vector<float> parse_float_list(const std::string &str)
+{
+    std::vector<float> values;
+    for (auto &item : string_utils::split(str, ","))
+    {
+        if (!item.empty())
+        {
+            values.push_back(atof(item.c_str()));
+        }
+    }
+    return values;
+}
+
+int main(int argc, char *argv[])
+{
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, __sigExit);
+    cmdline::parser parser;
+    parser.add<std::string>("model", 'm', "model path", true);
+    parser.add<std::string>("model_types", 't', "comma separated model types 0:person detection 2:lpr 3:face detection 4:face recognition 5:fire smoke", false, "0,2,3,4,5");
+    parser.add<std::string>("image", 'i', "image path", true);
+    parser.add<std::string>("streams", 's', "comma separated stream counts to sweep", false, "1,2,4,8,16");
+    parser.add<int>("threads", 'j', "worker threads, 0 means one per stream", false, 0);
+    parser.add<int>("handles", 'n', "handles per model type, streams are spread over them", false, 1);
+    parser.add<double>("fps", 'f', "frame rate per stream, 0 means as fast as possible", false, 0);
+    parser.add<int>("duration", 'd', "seconds per sweep point", false, 10);
+    parser.add<double>("knee", 'k', "minimum relative fps gain that still counts as scaling", false, 0.05);
+    parser.add<std::string>("report", 'r', "json report path", false, "multistream.json");
+    parser.add<std::string>("trace", '\0', "write a chrome trace event json to this path", false, "");
+    parser.add<std::string>("stream_thresholds", '\0', "comma separated detection thresholds assigned round-robin to streams sharing a handle, empty uses the shared snapshot", false, "");
+    parser.add<int>("retune_ms", '\0', "publish a new shared threshold snapshot every N ms while running, 0 disables", false, 0);
+    parser.parse_check(argc, argv);
+
+    int ret = AX_SYS_Init();
+    if (0 != ret)
+    {
+        printf("AX_SYS_Init failed\n");
+        return -1;
+    }
+    ret = AX_IVPS_Init();
+    if (0 != ret)
+    {
+        printf("AX_IVPS_Init failed\n");
+        return -1;
+    }
+    AX_ENGINE_NPU_ATTR_T npu_attr;
+    memset(&npu_attr, 0, sizeof(npu_attr));
+    npu_attr.eHardMode = AX_ENGINE_VIRTUAL_NPU_STD;
+    ret = AX_ENGINE_Init(&npu_attr);
+    if (0 != ret)
+    {
+        printf("AX_ENGINE_Init failed\n");
+        return -1;
+    }
+
+    std::string model_path = parser.get<std::string>("model");
+    std::string image_path = parser.get<std::string>("image");
+    std::vector<int> model_types = parse_int_list(parser.get<std::string>("model_types"));
+    std::vector<int> stream_counts = parse_int_list(parser.get<std::string>("streams"));
+    int n_threads = parser.get<int>("threads");
+    int n_handles = parser.get<int>("handles") < 1 ? 1 : parser.get<int>("handles");
+    double fps = parser.get<double>("fps");
+    int duration = parser.get<int>("duration");
+    double knee_gain = parser.get<double>("knee");
+    std::vector<float> stream_thresholds = parse_float_list(parser.get<std::string>("stream_thresholds"));
+    int retune_ms = parser.get<int>("retune_ms");
+
+    std::string trace_path = parser.get<std::string>("trace");
+    if (!trace_path.empty() && trace::start(trace_path) != 0)
+    {
+        printf("open trace %s failed\n", trace_path.c_str());
+        return -1;
+    }
+
+    cv::Mat image = cv::imread(image_path);
+    if (!image.data)
+    {
+        printf("read %s failed\n", image_path.c_str());
+        return -1;
+    }
+    cv::resize(image, image, cv::Size(ALIGN_UP(image.cols, 128), ALIGN_UP(image.rows, 128)));
+    cv::cvtColor(image, image, cv::COLOR_BGR2RGB);
+
+    json report;
+    report["image"] = image_path;
+    report["fps_per_stream"] = fps;
+    report["handles"] = n_handles;
+
+    for (int model_type : model_types)
+    {
+        if (model_type == ax_model_type_person_attr || model_type < 0 || model_type >= ax_model_type_end)
+        {
+            printf("model type %d skipped: no whole-frame entry point\n", model_type);
+            continue;
+        }
+
+        std::vector<ax_algorithm_handle_t> handles;
+        for (int h = 0; h < n_handles; h++)
+        {
+            ax_algorithm_handle_t handle;
+            ax_algorithm_init_t init_info;
+            init_info.model_type = (ax_model_type_e)model_type;
+            sprintf(init_info.model_file, model_path.c_str());
+            init_info.param = ax_algorithm_get_default_param();
+            if (ax_algorithm_init(&init_info, &handle) != 0)
+            {
+                printf("model type %d init failed\n", model_type);
+                break;
+            }
+            handles.push_back(handle);
+        }
+        if (handles.size() != (size_t)n_handles)
+        {
+            for (auto handle : handles)
+            {
+                ax_algorithm_deinit(handle);
+            }
+            continue;
+        }
+
+        // 所有句柄共用一份默认参数快照，各路可以带自己的阈值
+        param_snapshot::store defaults;
+        std::vector<std::unique_ptr<param_snapshot::bound_handle>> bounds;
+        for (auto handle : handles)
+        {
+            bounds.emplace_back(new param_snapshot::bound_handle(handle, &defaults, true));
+        }
+        std::vector<ax_algorithm_param_t> overrides;
+        for (float thr : stream_thresholds)
+        {
+            ax_algorithm_param_t param = ax_algorithm_get_default_param();
+            float *p = det_threshold(param, (ax_model_type_e)model_type);
+            if (p != nullptr)
+            {
+                *p = thr;
+                overrides.push_back(param);
+            }
+        }
+
+        std::vector<point_t> points;
+        int knee = -1;
+        for (int n_streams : stream_counts)
+        {
+            if (gLoopExit || n_streams <= 0)
+            {
+                break;
+            }
+
+            // 每路视频的图像只申请一次
+            std::vector<stream_t> streams(n_streams);
+            for (int i = 0; i < n_streams; i++)
+            {
+                stream_t &s = streams[i];
+                s.id = i;
+                s.handle = handles[i % handles.size()];
+                s.bound = bounds[i % handles.size()].get();
+                s.param = overrides.empty() ? nullptr : &overrides[i % overrides.size()];
+                s.model_type = (ax_model_type_e)model_type;
+                trace::create_image(image.cols, image.rows, image.cols, ax_color_space_rgb, &s.image, i);
+                memcpy(s.image.pVir, image.data, s.image.nSize);
+                s.frames = 0;
+                s.failures = 0;
+            }
+            for (auto handle : handles)
+            {
+                algorithm_stats::reset_stats(handle);
+            }
+
+            int threads = n_threads > 0 ? std::min(n_threads, n_streams) : n_streams;
+            std::vector<std::vector<stream_t *>> assign(threads);
+            for (int i = 0; i < n_streams; i++)
+            {
+                assign[i % threads].push_back(&streams[i]);
+            }
+
+            bench_utils::cpu_meter cpu;
+            double t_start = bench_utils::now_us();
+            double t_end = t_start + duration * 1e6;
+            for (int i = 0; i < n_streams; i++)
+            {
+                // 固定帧率时把各路的起始时间错开
+                streams[i].next_due = t_start + (fps > 0 ? 1e6 / fps * i / n_streams : 0);
+            }
+            std::vector<std::thread> pool;
+            for (int t = 0; t < threads; t++)
+            {
+                pool.emplace_back(worker, assign[t], fps, t_end);
+            }
+            // 模拟管理界面在运行中调整阈值：只发布快照，不等待推理线程
+            std::thread retuner;
+            if (retune_ms > 0)
+            {
+                retuner = std::thread([&]()
+                                      {
+                    ax_algorithm_param_t base = ax_algorithm_get_default_param();
+                    float *p = det_threshold(base, (ax_model_type_e)model_type);
+                    for (int n = 0; gLoopExit == 0 && bench_utils::now_us() < t_end; n++)
+                    {
+                        usleep(retune_ms * 1000);
+                        defaults.update([&](ax_algorithm_param_t &param)
+                                        {
+                            float *q = det_threshold(param, (ax_model_type_e)model_type);
+                            if (p != nullptr && q != nullptr)
+                            {
+                                *q = *p + (n % 2 ? 0.05f : 0.f);
+                            } });
+                    } });
+            }
+            for (auto &th : pool)
+            {
+                th.join();
+            }
+            if (retuner.joinable())
+            {
+                retuner.join();
+            }
+            double elapsed = bench_utils::now_us() - t_start;
+
+            point_t p;
+            p.streams = n_streams;
+            p.cpu_usage = cpu.usage();
+            bench_utils::latency_recorder all;
+            long long frames = 0;
+            p.worst_stream_p99 = 0;
+            for (auto &s : streams)
+            {
+                frames += s.frames;
+                all.merge(s.latency);
+                auto sum = s.latency.summarize();
+                p.worst_stream_p99 = std::max(p.worst_stream_p99, sum.p99);
+                trace::release_image(&s.image, s.id);
+            }
+            p.fps = frames * 1e6 / elapsed;
+            p.latency = all.summarize();
+            p.queue_wait_ms = 0;
+            unsigned long long calls = 0;
+            for (auto handle : handles)
+            {
+                algorithm_stats::stats_t stats;
+                algorithm_stats::get_stats(handle, &stats);
+                p.queue_wait_ms += stats.total[algorithm_stats::stage_queue_wait].total_ms;
+                calls += stats.total[algorithm_stats::stage_queue_wait].calls;
+            }
+            p.queue_wait_ms = calls ? p.queue_wait_ms / calls : 0;
+            p.set_param_calls = 0;
+            for (auto &b : bounds)
+            {
+                p.set_param_calls += b->set_param_calls();
+            }
+            points.push_back(p);
+
+            printf("model_type %d streams %3d threads %3d handles %d: %8.2f fps, latency p50 %8.1f p99 %8.1f max %8.1f us, worst stream p99 %8.1f us, queue wait %.2f ms, cpu %.1f%%, set_param %llu\n",
+                   model_type, n_streams, threads, n_handles, p.fps, p.latency.p50, p.latency.p99, p.latency.max,
+                   p.worst_stream_p99, p.queue_wait_ms, p.cpu_usage, p.set_param_calls);
+
+            if (knee < 0 && points.size() > 1 && p.fps < points[points.size() - 2].fps * (1 + knee_gain))
+            {
+                knee = points[points.size() - 2].streams;
+            }
+        }
+
+        for (auto handle : handles)
+        {
+            algorithm_stats::remove_stats(handle);
+            ax_algorithm_deinit(handle);
+        }
+
+        json jm;
+        for (auto &p : points)
+        {
+            json jp;
+            jp["streams"] = p.streams;
+            jp["fps"] = p.fps;
+            jp["latency_p50_us"] = p.latency.p50;
+            jp["latency_p90_us"] = p.latency.p90;
+            jp["latency_p99_us"] = p.latency.p99;
+            jp["latency_max_us"] = p.latency.max;
+            jp["worst_stream_p99_us"] = p.worst_stream_p99;
+            jp["queue_wait_ms"] = p.queue_wait_ms;
+            jp["cpu_usage"] = p.cpu_usage;
+            jp["set_param_calls"] = p.set_param_calls;
+            jm["points"].push_back(jp);
+        }
+        jm["knee_streams"] = knee;
+        report["model_types"][std::to_string(model_type)] = jm;
+        if (knee > 0)
+        {
+            printf("model_type %d: throughput stops scaling after %d streams\n", model_type, knee);
+        }
+        else
+        {
+            printf("model_type %d: no knee found in the swept range\n", model_type);
+        }
+    }
+
+    std::string report_path = parser.get<std::string>("report");
+    std::string report_str = report.dump(4, ' ');
+    std::ofstream ofs(report_path.c_str(), std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+    if (ofs.is_open())
+    {
+        ofs.write(report_str.c_str(), report_str.length());
+        ofs.close();
+        printf("report: %s\n", report_path.c_str());
+    }
+
+    if (!trace_path.empty())
+    {
+        unsigned long long dropped = trace::stop();
+        printf("trace: %s dropped events: %llu\n", trace_path.c_str(), dropped);
+    }
+
+    AX_ENGINE_Deinit();
+    AX_IVPS_Deinit();
+    AX_SYS_Deinit();
+
+    return 0;
+}
@@ -12,6 +12,8 @@
 #include "cmdline.hpp"
 #include "string_utils.hpp"
 #include "putTextPlate.h"
+#include "nv12_draw.hpp"
+#include "async_log.hpp"
 
 static bool read_file(const std::string &path, std::vector<char> &data)
 {
@@ -38,7 +40,9 @@ static bool read_file(const std::string &path, std::vector<char> &data)
     return true;
 }
 
-int inference(ax_algorithm_handle_t handle, std::vector<char> &image, int width, int height, int stride, cv::Mat &image_bgr)
+static nv12_draw::plate_renderer plate_renderer_(1);
+
+int inference(ax_algorithm_handle_t handle, std::vector<char> &image, int width, int height, int stride)
 {
     ax_image_t image_nv12;
     ax_create_image(width, height, stride, ax_color_space_nv12, &image_nv12);
@@ -46,16 +50,23 @@ int inference(ax_algorithm_handle_t handle, std::vector<char> &image, int width,
 
     ax_result_t result;
     memset(&result, 0, sizeof(ax_result_t));
-    ax_algorithm_inference(handle, &image_nv12, &result);
+    ax_algorithm_detect(handle, &image_nv12, &result);
     ax_release_image(&image_nv12);
 
-    cv::Mat image_cv_nv12(height * 3 / 2, width, CV_8UC1, image.data(), stride);
-    cv::cvtColor(image_cv_nv12, image_bgr, cv::COLOR_YUV2BGR_NV12);
+    // 直接在 NV12 原图上绘制，结果可以直接送编码器
+    ax_image_t image_draw = {0};
+    image_draw.pVir = image.data();
+    image_draw.nWidth = width;
+    image_draw.nHeight = height;
+    image_draw.tStride_W = stride;
+    image_draw.eDtype = ax_color_space_nv12;
 
+    unsigned char box_color[3] = {0, 0, 255};
+    unsigned char point_color[3] = {255, 0, 0};
     for (int i = 0; i < result.n_objects; i++)
     {
         auto &box = result.objects[i];
-        cv::rectangle(image_bgr, cv::Rect(box.bbox.x, box.bbox.y, box.bbox.w, box.bbox.h), cv::Scalar(255, 0, 0), 2);
+        nv12_draw::rectangle(&image_draw, box.bbox, box_color, 2);
         switch (result.model_type)
         {
         case ax_model_type_person_detection:
@@ -64,23 +75,23 @@ int inference(ax_algorithm_handle_t handle, std::vector<char> &image, int width,
             {
                 continue;
             }
-
-            cv::putText(image_bgr, std::to_string(box.person_info.status) + " " + std::to_string(box.track_id), cv::Point(box.bbox.x, box.bbox.y), cv::FONT_HERSHEY_SIMPLEX, 1, cv::Scalar(255, 0, 0), 2);
-            printf("status: %d, track_id: %d\n", box.person_info.status, box.track_id);
+            char label[48];
+            snprintf(label, sizeof(label), "%d %lu", box.person_info.status, box.track_id);
+            nv12_draw::text(&image_draw, (int)box.bbox.x, (int)box.bbox.y, label, box_color);
+            ASYNC_LOG(ax_log_info, "status: %d, track_id: %lu\n", box.person_info.status, box.track_id);
+        }
+        break;
+        case ax_model_type_face_detection:
+        {
+            nv12_draw::points(&image_draw, box.face_info.points, AX_ALGORITHM_FACE_POINT_LEN, point_color, 2);
+            ASYNC_LOG(ax_log_info, "track_id: %lu quality: %0.2f \n", box.track_id, box.face_info.quality);
         }
         break;
         case ax_model_type_lpr:
         {
             char license[32] = {0};
             ax_algorithm_get_plate_str(box.vehicle_info.plate_id, box.vehicle_info.len_plate_id, license);
-            printf("license: %s cartype: %d\n", license, box.vehicle_info.cartype);
-            ax_point_t org = {box.bbox.x + box.bbox.w / 2, box.bbox.y + box.bbox.h / 2};
-            unsigned char color[3] = {0, 0, 255};
-            ax_image_t ax_image_rgb = {0};
-            ax_image_rgb.nWidth = image_bgr.cols;
-            ax_image_rgb.nHeight = image_bgr.rows;
-            ax_image_rgb.pVir = image_bgr.data;
-            putTextPlateID(&ax_image_rgb, box.vehicle_info.plate_id, box.vehicle_info.len_plate_id, &org, color, 1);
+            ASYNC_LOG(ax_log_info, "license: %s cartype: %d\n", license, box.vehicle_info.cartype);
         }
         break;
         default:
@@ -88,6 +99,12 @@ int inference(ax_algorithm_handle_t handle, std::vector<char> &image, int width,
         }
     }
 
+    if (result.model_type == ax_model_type_lpr)
+    {
+        unsigned char color[3] = {255, 0, 0};
+        plate_renderer_.draw(&image_draw, &result, color);
+    }
+
     return 0;
 }
 
@@ -95,13 +112,14 @@ int main(int argc, char *argv[])
 {
     cmdline::parser parser;
     parser.add<std::string>("model", 'm', "model path", true);
-    parser.add<int>("model_type", 't', "model type 0:person 1:lpr", true);
+    parser.add<int>("model_type", 't', "model type 0:person detection 2:lpr 3:face detection 5:fire smoke", true);
     parser.add<std::string>("image", 'i', "image path", true);
     parser.add<int>("width", 'w', "image width", true);
     parser.add<int>("height", 'h', "image height", true);
     parser.add<int>("stride", 's', "image stride", true);
     parser.add<std::string>("output", 'o', "output path", false, "plate_result");
     parser.parse_check(argc, argv);
+    async_log::start();
 
     int ret = AX_SYS_Init();
     if (0 != ret)
@@ -150,22 +168,41 @@ int main(int argc, char *argv[])
     }
 
     std::vector<char> image;
-    cv::Mat image_bgr;
     if (!read_file(image_path, image))
     {
         return -1;
     }
     printf("image size: %ld wh: %dx%d stride: %d\n", image.size(), width, height, stride);
-    inference(handle, image, width, height, stride, image_bgr);
+    inference(handle, image, width, height, stride);
 
-    if (image_bgr.data)
+    // 绘制后的 NV12 原样保存为 .nv12，jpg 只用于预览；不使用输入文件名，输出目录与输入目录相同时也不会覆盖原图
+    auto name = string_utils::basename(image_path);
+    auto ext = string_utils::extension(name);
+    if (!ext.empty())
+    {
+        name = name.substr(0, name.size() - ext.size() - 1);
+    }
+    if (string_utils::tolower(ext) == "nv12")
+    {
+        name += "_draw";
+    }
+    auto out_path = string_utils::join(output_path, name);
+    printf("out_path: %s\n", (out_path + ".nv12").c_str());
+    std::ofstream ofs((out_path + ".nv12").c_str(), std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+    if (ofs.is_open())
     {
-        auto out_path = string_utils::join(output_path, string_utils::basename(image_path)) + ".jpg";
-        printf("out_path: %s\n", out_path.c_str());
-        cv::imwrite(out_path, image_bgr);
+        ofs.write(image.data(), image.size());
+        ofs.close();
     }
 
+    cv::Mat image_cv_nv12(height * 3 / 2, width, CV_8UC1, image.data(), stride);
+    cv::Mat image_bgr;
+    cv::cvtColor(image_cv_nv12, image_bgr, cv::COLOR_YUV2BGR_NV12);
+    printf("out_path: %s\n", (out_path + ".jpg").c_str());
+    cv::imwrite(out_path + ".jpg", image_bgr);
+
     ax_algorithm_deinit(handle);
+    async_log::stop();
     AX_ENGINE_Deinit();
     AX_IVPS_Deinit();
     AX_SYS_Deinit();
@@ -12,10 +12,77 @@
 #include "cmdline.hpp"
 #include "string_utils.hpp"
 #include "putTextPlate.h"
+#include "algorithm_stats.hpp"
+#include "hot_reload.hpp"
+#include "result_log.hpp"
+#include "async_log.hpp"
+#include "motion_gate.hpp"
+#include "track_events.hpp"
+#include "fire_smoke_scheduler.hpp"
+#include "plate_cascade.hpp"
 
 #define ALIGN_UP(x, align) ((((x) + ((align) - 1)) / (align)) * (align))
 
-int inference(ax_algorithm_handle_t handle, cv::Mat &image)
+/**
+ * 压力测试可以叠加以下功能，每帧的处理顺序：
+ *   hot_reload(SIGHUP) -> motion_gate(--motion_gate) -> fire_smoke_scheduler(--fire_smoke_schedule)
+ *     -> algorithm_stats::track -> plate_cascade(--plate_cascade) -> track_id 重映射
+ *     -> result_log(--record) -> track_events(--track_events) 或逐目标日志(--log_rate) -> async_log(--log_binary)
+ * 支持的组合：
+ * - --motion_gate 可与任意模型和其它选项同时使用；门控在调度器外层，画面静止的帧不计入调度器的帧数，
+ *   门控跳过的帧不参与 plate_cascade 投票
+ * - --fire_smoke_schedule 只对 -t 5 生效，--plate_cascade 只对 -t 2 生效，两者不会同时生效，对其它模型给出提示后忽略
+ * - SIGHUP 重新加载时门控、调度器和级联的缓存属于旧句柄的 track_id，切换时全部清空，下一帧重新推理
+ * - --track_events 打开时不输出逐目标日志，--log_rate 只限制逐目标日志；--record 与 --log_binary 与其它选项无关
+ */
+
+// --record 打开时把每帧结果追加到二进制日志，用 model_eval/result_log_tool 查询和转换
+static result_log::writer result_log_;
+
+// 收到 SIGHUP 时在后台重新加载 --model，推理不中断
+static hot_reload::reloader reloader_;
+
+// --motion_gate 打开时画面静止的帧不调用 NPU，返回老化后的上一次结果
+static bool gate_enabled_ = false;
+static motion_gate::gate gate_;
+
+// --fire_smoke_schedule 打开时烟火模型低频推理，检测到火/烟后切换为逐帧，结果需满足 K-of-N 才输出
+static bool schedule_enabled_ = false;
+static fire_smoke_scheduler::scheduler scheduler_;
+
+static int scheduled_track(ax_algorithm_handle_t handle, ax_image_t *image, ax_result_t *result)
+{
+    if (!schedule_enabled_)
+    {
+        return algorithm_stats::track(handle, image, result);
+    }
+    return fire_smoke_scheduler::track(handle, scheduler_, image, result, algorithm_stats::track);
+}
+
+// --plate_cascade 打开时车牌确定后按轨迹输出确定的车牌；运动门控跳过的帧不参与投票
+static bool cascade_enabled_ = false;
+static plate_cascade::cascade cascade_;
+
+static int gated_track(ax_algorithm_handle_t handle, ax_image_t *image, ax_result_t *result)
+{
+    int skipped = 0;
+    int ret = gate_enabled_ ? motion_gate::track(handle, gate_, image, result, scheduled_track, &skipped)
+                            : scheduled_track(handle, image, result);
+    if (ret == ax_error_code_success && cascade_enabled_)
+    {
+        cascade_.update(result, skipped == 0);
+    }
+    return ret;
+}
+
+// --track_events 打开时只输出轨迹的新建/显著变化/丢失/结束事件，不再逐帧输出每个目标
+static bool events_enabled_ = false;
+static track_events::emitter emitter_;
+
+// 每个检测结果的输出经异步日志写出，--log_rate 限制每个调用点每秒的条数
+static int log_rate_ = 0;
+
+int inference(cv::Mat &image)
 {
     // 图片分辨率和格式不变的情况下 这个图片一路视频只需要申请一次就可以了
     ax_image_t image_rgb;
@@ -24,11 +91,31 @@ int inference(ax_algorithm_handle_t handle, cv::Mat &image)
 
     ax_result_t result;
     memset(&result, 0, sizeof(ax_result_t));
-    ax_algorithm_inference(handle, &image_rgb, &result);
+    reloader_.track(&image_rgb, &result, gated_track);
     // 释放也只需要一次
     ax_release_image(&image_rgb);
 
-    for (int i = 0; i < result.n_objects; i++)
+    static unsigned long long frame_id = 0;
+    if (result_log_.is_open())
+    {
+        result_log_.write(frame_id, -1, 0, result);
+    }
+    frame_id++;
+
+    if (events_enabled_)
+    {
+        static std::vector<track_events::event_t> events;
+        events.clear();
+        emitter_.update(&result, result_log::writer::wall_us() / 1000, events);
+        for (auto &e : events)
+        {
+            ASYNC_LOG(ax_log_info, "event: %s track_id: %lu ts: %lld bbox: %.0f %.0f %.0f %.0f score: %.2f label: %d\n",
+                      track_events::event_type_str(e.type), e.track_id, e.timestamp,
+                      e.bbox.x, e.bbox.y, e.bbox.w, e.bbox.h, e.score, e.label);
+        }
+    }
+
+    for (int i = 0; !events_enabled_ && i < result.n_objects; i++)
     {
         auto &box = result.objects[i];
         switch (result.model_type)
@@ -39,19 +126,24 @@ int inference(ax_algorithm_handle_t handle, cv::Mat &image)
             {
                 continue;
             }
-            printf("status: %d, track_id: %d\n", box.person_info.status, box.track_id);
+            ASYNC_LOG_RATE(ax_log_info, log_rate_, "status: %d, track_id: %lu\n", box.person_info.status, box.track_id);
         }
         break;
         case ax_model_type_face_detection:
         {
-            printf("track_id: %d %0.2f\n", box.track_id, box.face_info.quality);
+            ASYNC_LOG_RATE(ax_log_info, log_rate_, "track_id: %lu %0.2f\n", box.track_id, box.face_info.quality);
         }
         break;
         case ax_model_type_lpr:
         {
             char license[32] = {0};
             ax_algorithm_get_plate_str(box.vehicle_info.plate_id, box.vehicle_info.len_plate_id, license);
-            printf("license: %s cartype: %d\n", license, box.vehicle_info.cartype);
+            ASYNC_LOG_RATE(ax_log_info, log_rate_, "license: %s cartype: %d\n", license, box.vehicle_info.cartype);
+        }
+        break;
+        case ax_model_type_fire_smoke:
+        {
+            ASYNC_LOG_RATE(ax_log_info, log_rate_, "track_id: %lu label: %d score: %0.2f\n", box.track_id, box.fire_smoke_info.label, box.score);
         }
         break;
         default:
@@ -59,6 +151,15 @@ int inference(ax_algorithm_handle_t handle, cv::Mat &image)
         }
     }
 
+    // 每 100 帧打印一次句柄统计
+    static int frame_count = 0;
+    if (++frame_count % 100 == 0)
+    {
+        algorithm_stats::stats_t stats;
+        algorithm_stats::get_stats(reloader_.handle(), &stats);
+        algorithm_stats::print_stats(stats);
+    }
+
     return 0;
 }
 volatile int gLoopExit = 0;
@@ -68,17 +169,79 @@ extern "C" void __sigExit(int iSigNo)
     return;
 }
 
+volatile int gReload = 0;
+extern "C" void __sigReload(int iSigNo)
+{
+    gReload = 1;
+    return;
+}
+
+// 主循环中检查 SIGHUP，旧模型继续推理直到新模型加载完成
+static void check_reload(const std::string &model_path)
+{
+    static int last_generation = 0;
+    if (gReload)
+    {
+        gReload = 0;
+        if (reloader_.reload(model_path) == 0)
+        {
+            printf("reloading %s\n", model_path.c_str());
+        }
+    }
+    static int last_state = hot_reload::state_idle;
+    int state = reloader_.state();
+    if (state == hot_reload::state_failed && last_state != state)
+    {
+        printf("reload %s failed: %d, keep running the old model\n", model_path.c_str(), reloader_.load_error());
+    }
+    last_state = state;
+    if (reloader_.generation() != last_generation)
+    {
+        last_generation = reloader_.generation();
+        printf("switched to reloaded model (load %.1f ms)\n", reloader_.load_us() / 1000.0);
+    }
+}
+
 int main(int argc, char *argv[])
 {
 
     signal(SIGPIPE, SIG_IGN);
     signal(SIGINT, __sigExit);
+    signal(SIGHUP, __sigReload);
     cmdline::parser parser;
     parser.add<std::string>("model", 'm', "model path", true);
     parser.add<int>("model_type", 't', "model type 0:person detection 2:lpr 3:face detection 5:fire smoke", true);
     parser.add<std::string>("image", 'i', "image path", true);
+    parser.add<std::string>("record", 'r', "append results to this binary result log", false, "");
+    parser.add("motion_gate", 0, "skip inference on frames without motion and return the aged previous result");
+    parser.add("fire_smoke_schedule", 0, "run the fire/smoke model at a low base rate and escalate while fire or smoke is seen");
+    parser.add("plate_cascade", 0, "lpr only: report each track's plate once it has been read the same several times in a row");
+    parser.add("track_events", 0, "log track created/updated/lost/ended events instead of every object on every frame");
+    parser.add<int>("log_rate", 0, "max detection log lines per second per call site, 0 means unlimited", false, 0);
+    parser.add<std::string>("log_binary", 0, "also write detection logs as binary records, formatting deferred to async_log::decode", false, "");
     parser.parse_check(argc, argv);
 
+    gate_enabled_ = parser.exist("motion_gate");
+    cascade_enabled_ = parser.exist("plate_cascade") && parser.get<int>("model_type") == ax_model_type_lpr;
+    events_enabled_ = parser.exist("track_events");
+    schedule_enabled_ = parser.exist("fire_smoke_schedule") && parser.get<int>("model_type") == ax_model_type_fire_smoke;
+    if (parser.exist("plate_cascade") && !cascade_enabled_)
+    {
+        printf("--plate_cascade only applies to model type 2 (lpr), ignored\n");
+    }
+    if (parser.exist("fire_smoke_schedule") && !schedule_enabled_)
+    {
+        printf("--fire_smoke_schedule only applies to model type 5 (fire smoke), ignored\n");
+    }
+    log_rate_ = parser.get<int>("log_rate");
+    async_log::options_t log_options = async_log::get_default_options();
+    log_options.binary_path = parser.get<std::string>("log_binary");
+    if (async_log::start(log_options) != 0)
+    {
+        printf("open log %s failed\n", log_options.binary_path.c_str());
+        return -1;
+    }
+
     int ret = AX_SYS_Init();
     if (0 != ret)
     {
@@ -104,14 +267,27 @@ int main(int argc, char *argv[])
     std::string model_path = parser.get<std::string>("model");
     std::string image_path = parser.get<std::string>("image");
 
-    ax_algorithm_handle_t handle;
     ax_algorithm_init_t init_info;
     init_info.model_type = (ax_model_type_e)parser.get<int>("model_type");
     sprintf(init_info.model_file, model_path.c_str());
     init_info.param = ax_algorithm_get_default_param();
 
-    if (ax_algorithm_init(&init_info, &handle) != 0)
+    if (reloader_.init(init_info) != 0)
+    {
+        return -1;
+    }
+    // 切换时旧句柄的统计并入新句柄，统计不清零，新句柄的第一帧也计入；各功能缓存的旧 track_id 清空
+    reloader_.set_switch_callback([](ax_algorithm_handle_t old_handle, ax_algorithm_handle_t new_handle)
+                                  {
+        algorithm_stats::move_stats(old_handle, new_handle);
+        gate_.reset();
+        scheduler_.reset();
+        cascade_.reset(); });
+
+    std::string record_path = parser.get<std::string>("record");
+    if (!record_path.empty() && result_log_.open(record_path, true) != 0)
     {
+        printf("open result log %s failed\n", record_path.c_str());
         return -1;
     }
 
@@ -123,7 +299,8 @@ int main(int argc, char *argv[])
             // cv::resize(image, image, cv::Size(1920, 1080));
             cv::resize(image, image, cv::Size(ALIGN_UP(image.cols, 128), ALIGN_UP(image.rows, 128)));
             cv::cvtColor(image, image, cv::COLOR_BGR2RGB);
-            inference(handle, image);
+            check_reload(model_path);
+            inference(image);
         }
         else
         {
@@ -140,13 +317,30 @@ int main(int argc, char *argv[])
                     cv::resize(image, image, cv::Size(ALIGN_UP(image.cols, 128), ALIGN_UP(image.rows, 128)));
                     cv::cvtColor(image, image, cv::COLOR_BGR2RGB);
                     printf("image path: %s\n", image_path_.c_str());
-                    inference(handle, image);
+                    check_reload(model_path);
+                    inference(image);
                 }
             }
         }
     }
 
-    ax_algorithm_deinit(handle);
+    algorithm_stats::stats_t stats;
+    algorithm_stats::get_stats(reloader_.handle(), &stats);
+    algorithm_stats::print_stats(stats);
+    algorithm_stats::remove_stats(reloader_.handle());
+    if (cascade_enabled_)
+    {
+        printf("plate cascade: %lld frames, %lld settled plates reported\n", cascade_.frames(), cascade_.cached_plates());
+    }
+    result_log_.close();
+
+    unsigned long long log_dropped = async_log::stop();
+    if (log_dropped > 0)
+    {
+        printf("log records dropped: %llu\n", log_dropped);
+    }
+
+    reloader_.deinit();
     AX_ENGINE_Deinit();
     AX_IVPS_Deinit();
     AX_SYS_Deinit();
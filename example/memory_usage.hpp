@@ -0,0 +1,220 @@
+#pragma once
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "ax_algorithm_sdk.h"
+
+/**
+ * 内存占用统计：
+ * - 句柄：memory_usage::init 在 ax_algorithm_init 前后采样 CMM 与进程 RSS，差值即模型权重、NPU 工作缓冲区等初始化占用
+ * - 图像：memory_usage::create_image/release_image 统计存活的 ax_image_t 数量和字节数
+ * - 全局：当前/峰值 CMM、RSS，以及上面两项的汇总和峰值
+ * 句柄运行期间跟踪器、历史状态的增长无法单独区分，体现在全局 RSS 和 CMM 中。
+ */
+namespace memory_usage
+{
+    typedef struct _handle_usage_t
+    {
+        /**
+         * cmm_bytes: 初始化占用的 CMM(模型权重、NPU 工作缓冲区)，-1 表示无法获取
+         * heap_bytes: 初始化占用的进程内存(RSS 增量)
+         */
+        long long cmm_bytes;
+        long long heap_bytes;
+    } handle_usage_t;
+
+    typedef struct _global_usage_t
+    {
+        long long handles;
+        long long handle_cmm_bytes;
+        long long handle_heap_bytes;
+
+        long long images;
+        long long images_peak;
+        long long image_bytes;
+        long long image_bytes_peak;
+
+        long long cmm_used;      // -1 表示无法获取
+        long long cmm_used_peak; // 采样到的峰值
+        long long rss;
+        long long rss_peak;      // VmHWM
+    } global_usage_t;
+
+    // AX650 CMM 状态，取所有分区 "nbytes(... Cur=xxxB" 之和
+    static const char *cmm_info_path = "/proc/ax_proc/mem_cmm_info";
+
+    static long long read_cmm_used()
+    {
+        std::ifstream ifs(cmm_info_path);
+        if (!ifs.is_open())
+        {
+            return -1;
+        }
+        std::string line;
+        long long used = 0;
+        bool found = false;
+        while (std::getline(ifs, line))
+        {
+            size_t pos = line.find("nbytes(");
+            if (pos == std::string::npos)
+            {
+                continue;
+            }
+            pos = line.find("Cur=", pos);
+            if (pos == std::string::npos)
+            {
+                continue;
+            }
+            used += strtoll(line.c_str() + pos + 4, nullptr, 10);
+            found = true;
+        }
+        return found ? used : -1;
+    }
+
+    // 读取 /proc/self/status 中的字段，单位字节
+    static long long read_proc_status(const char *key)
+    {
+        std::ifstream ifs("/proc/self/status");
+        std::string line;
+        size_t key_len = strlen(key);
+        while (std::getline(ifs, line))
+        {
+            if (line.compare(0, key_len, key) == 0 && line.size() > key_len && line[key_len] == ':')
+            {
+                return strtoll(line.c_str() + key_len + 1, nullptr, 10) * 1024;
+            }
+        }
+        return -1;
+    }
+
+    namespace detail
+    {
+        static std::mutex g_mutex;
+        static std::unordered_map<ax_algorithm_handle_t, handle_usage_t> g_handles;
+        static std::atomic<long long> g_images{0};
+        static std::atomic<long long> g_images_peak{0};
+        static std::atomic<long long> g_image_bytes{0};
+        static std::atomic<long long> g_image_bytes_peak{0};
+        static std::atomic<long long> g_cmm_peak{-1};
+
+        static void update_peak(std::atomic<long long> &peak, long long v)
+        {
+            long long cur = peak.load(std::memory_order_relaxed);
+            while (v > cur && !peak.compare_exchange_weak(cur, v, std::memory_order_relaxed))
+            {
+            }
+        }
+    }
+
+    /**
+     * @brief: 与 ax_algorithm_init 相同，同时记录句柄初始化占用的内存。
+     *         为了让差值只属于这个句柄，内部串行执行
+     */
+    static int init(ax_algorithm_init_t *init_info, ax_algorithm_handle_t *handle)
+    {
+        std::lock_guard<std::mutex> lock(detail::g_mutex);
+        long long cmm0 = read_cmm_used();
+        long long rss0 = read_proc_status("VmRSS");
+        int ret = ax_algorithm_init(init_info, handle);
+        if (ret != ax_error_code_success)
+        {
+            return ret;
+        }
+        long long cmm1 = read_cmm_used();
+        long long rss1 = read_proc_status("VmRSS");
+
+        handle_usage_t usage;
+        usage.cmm_bytes = (cmm0 >= 0 && cmm1 >= 0) ? cmm1 - cmm0 : -1;
+        usage.heap_bytes = rss1 - rss0;
+        detail::g_handles[*handle] = usage;
+        detail::update_peak(detail::g_cmm_peak, cmm1);
+        return ret;
+    }
+
+    static void deinit(ax_algorithm_handle_t handle)
+    {
+        std::lock_guard<std::mutex> lock(detail::g_mutex);
+        ax_algorithm_deinit(handle);
+        detail::g_handles.erase(handle);
+    }
+
+    /**
+     * @brief: 获取句柄初始化时的内存占用
+     * @return 0 成功，非零表示句柄不是通过 memory_usage::init 创建的
+     */
+    static int get_handle_usage(ax_algorithm_handle_t handle, handle_usage_t *usage)
+    {
+        std::lock_guard<std::mutex> lock(detail::g_mutex);
+        auto it = detail::g_handles.find(handle);
+        if (it == detail::g_handles.end())
+        {
+            return ax_error_code_fail;
+        }
+        *usage = it->second;
+        return ax_error_code_success;
+    }
+
+    /**
+     * @brief: 与 ax_create_image 相同，同时统计存活图像
+     */
+    static int create_image(int width, int height, int stride, ax_color_space_e color, ax_image_t *image)
+    {
+        int ret = ax_create_image(width, height, stride, color, image);
+        if (ret != ax_error_code_success)
+        {
+            return ret;
+        }
+        long long n = detail::g_images.fetch_add(1, std::memory_order_relaxed) + 1;
+        long long bytes = detail::g_image_bytes.fetch_add(image->nSize, std::memory_order_relaxed) + image->nSize;
+        detail::update_peak(detail::g_images_peak, n);
+        detail::update_peak(detail::g_image_bytes_peak, bytes);
+        return ret;
+    }
+
+    static void release_image(ax_image_t *image)
+    {
+        detail::g_images.fetch_sub(1, std::memory_order_relaxed);
+        detail::g_image_bytes.fetch_sub(image->nSize, std::memory_order_relaxed);
+        ax_release_image(image);
+    }
+
+    /**
+     * @brief: 获取全局内存占用，同时采样一次 CMM 用于峰值统计
+     */
+    static void get_global_usage(global_usage_t *usage)
+    {
+        memset(usage, 0, sizeof(global_usage_t));
+        {
+            std::lock_guard<std::mutex> lock(detail::g_mutex);
+            usage->handles = detail::g_handles.size();
+            for (auto &kv : detail::g_handles)
+            {
+                usage->handle_cmm_bytes += kv.second.cmm_bytes > 0 ? kv.second.cmm_bytes : 0;
+                usage->handle_heap_bytes += kv.second.heap_bytes > 0 ? kv.second.heap_bytes : 0;
+            }
+        }
+        usage->images = detail::g_images.load();
+        usage->images_peak = detail::g_images_peak.load();
+        usage->image_bytes = detail::g_image_bytes.load();
+        usage->image_bytes_peak = detail::g_image_bytes_peak.load();
+        usage->cmm_used = read_cmm_used();
+        detail::update_peak(detail::g_cmm_peak, usage->cmm_used);
+        usage->cmm_used_peak = detail::g_cmm_peak.load();
+        usage->rss = read_proc_status("VmRSS");
+        usage->rss_peak = read_proc_status("VmHWM");
+    }
+
+    static void print_global_usage(const global_usage_t &usage)
+    {
+        const double mb = 1024.0 * 1024.0;
+        printf("handles: %lld cmm %.2f MB heap %.2f MB\n", usage.handles, usage.handle_cmm_bytes / mb, usage.handle_heap_bytes / mb);
+        printf("images: %lld (peak %lld) %.2f MB (peak %.2f MB)\n", usage.images, usage.images_peak, usage.image_bytes / mb, usage.image_bytes_peak / mb);
+        printf("cmm used: %.2f MB (peak %.2f MB) rss: %.2f MB (peak %.2f MB)\n", usage.cmm_used / mb, usage.cmm_used_peak / mb, usage.rss / mb, usage.rss_peak / mb);
+    }
+}
@@ -0,0 +1,261 @@
+#pragma once
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ax_algorithm_sdk.h"
+#include "startup_profile.hpp"
+
+/**
+ * 多模型包：同一个 model_file 中包含多种模型时，打开一次，按模型类型分发子句柄
+ * - open 预取模型文件到页缓存并检查一次 license 文件；第一次 acquire/acquire_all 初始化完成后解除预取映射，
+ *   之后的 acquire 从页缓存中剩下的文件页加载，页被回收时会重新读盘。需要只读一次时用一次 acquire_all 取得全部子句柄
+ * - 无跟踪状态的模型(人脸识别)默认在所有使用者之间共享同一个句柄，引用计数释放；
+ *   带跟踪的检测模型和人体属性(按 ax_body_attr_t.track_id 在句柄内保存历史)每个使用者一个句柄，避免不同视频流的轨迹混在一起
+ * - 共享句柄由 acquire 原样交给多个使用者，这里不加锁；多线程使用时调用方自己串行化，例如每个线程用同一个
+ *   param_snapshot::bound_handle 调用
+ * - acquire_all 一次创建多个子句柄，并行初始化
+ * 权重、NPU 上下文和 license 校验都在 ax_algorithm_init 内部，SDK 没有提供在句柄之间共享的接口，
+ * 每个子句柄仍各自持有一份；这里能省下的是重复的磁盘读取和重复的同类句柄。
+ */
+namespace model_package
+{
+    typedef enum _share_e
+    {
+        share_auto = 0, // 无跟踪状态的模型共享，其它独占
+        share_always,   // 同类型同参数的使用者共享，例如只调用 ax_algorithm_detect
+        share_never,
+    } share_e;
+
+    // 这些模型按输入推理，句柄内没有跨帧状态；人体属性按 track_id 保存历史，各视频流的 track_id 都从 1 编号，不能共享
+    static bool is_stateless(ax_model_type_e type)
+    {
+        return type == ax_model_type_face_recognition;
+    }
+
+    class package
+    {
+    public:
+        package() = default;
+        ~package() { close(); }
+
+        package(const package &) = delete;
+        package &operator=(const package &) = delete;
+
+        /**
+         * @brief: 打开模型包
+         * @param[in] model_file: 模型文件
+         * @param[in] license_path: license 文件，为空时不设置
+         * @param[in] prof: 记录文件读取和子句柄初始化阶段，可为空
+         * @return 0 成功；模型文件或 license 文件无法读取时返回 ax_error_code_init_model_fail / ax_error_code_init_license_fail
+         */
+        int open(const std::string &model_file, const std::string &license_path = "", startup_profile::profiler *prof = nullptr)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (model_file.size() >= sizeof(ax_algorithm_init_t::model_file) || license_path.size() >= sizeof(ax_algorithm_init_t::license_path))
+            {
+                return ax_error_code_fail;
+            }
+            if (!license_path.empty() && access(license_path.c_str(), R_OK) != 0)
+            {
+                return ax_error_code_init_license_fail;
+            }
+            {
+                startup_profile::scoped_phase phase(prof, "model file I/O");
+                model_bytes_ = startup_profile::prefetch(model_file);
+            }
+            if (model_bytes_ < 0)
+            {
+                return ax_error_code_init_model_fail;
+            }
+            model_file_ = model_file;
+            license_path_ = license_path;
+            prof_ = prof;
+            return ax_error_code_success;
+        }
+
+        /**
+         * @brief: 释放所有子句柄，未 release 的句柄也会被释放
+         */
+        void close()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto &e : entries_)
+            {
+                ax_algorithm_deinit(e.handle);
+            }
+            entries_.clear();
+            if (!model_file_.empty())
+            {
+                startup_profile::release_prefetch(model_file_);
+            }
+            model_file_.clear();
+        }
+
+        /**
+         * @brief: 获取一个子句柄
+         * @param[in] type: 模型类型
+         * @param[out] handle: 子句柄，用完后调用 release；共享的句柄同时交给了其他使用者，多线程调用时需要串行化
+         * @param[in] share: 共享策略
+         * @param[in] param: 为空时使用 ax_algorithm_get_default_param；只有参数相同的句柄才会共享
+         * @return 0 成功，非零为 ax_algorithm_init 的错误码
+         */
+        int acquire(ax_model_type_e type, ax_algorithm_handle_t *handle, share_e share = share_auto, const ax_algorithm_param_t *param = nullptr)
+        {
+            std::vector<ax_algorithm_handle_t> handles;
+            int ret = acquire_all({type}, handles, share, param);
+            if (ret == ax_error_code_success)
+            {
+                *handle = handles[0];
+            }
+            return ret;
+        }
+
+        /**
+         * @brief: 一次获取多个子句柄，需要新建的句柄并行初始化
+         * @param[out] handles: 与 types 一一对应；失败时本次新建的句柄全部释放
+         */
+        int acquire_all(const std::vector<ax_model_type_e> &types, std::vector<ax_algorithm_handle_t> &handles,
+                        share_e share = share_auto, const ax_algorithm_param_t *param = nullptr, bool parallel = true)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (model_file_.empty())
+            {
+                return ax_error_code_fail;
+            }
+            ax_algorithm_param_t p = param ? *param : ax_algorithm_get_default_param();
+
+            // slot[i] >= 0 表示复用 entries_ 中已有的句柄，否则为 infos 中的下标 -(k + 1)
+            std::vector<int> slot(types.size());
+            std::vector<ax_algorithm_init_t> infos;
+            std::vector<bool> infos_shared;
+            for (size_t i = 0; i < types.size(); i++)
+            {
+                bool shared = share == share_always || (share == share_auto && is_stateless(types[i]));
+                int found = shared ? find(types[i], p) : -1;
+                if (found >= 0)
+                {
+                    slot[i] = found;
+                    continue;
+                }
+                // 同一批中相同的共享类型只初始化一次
+                int pending = -1;
+                for (size_t k = 0; shared && k < infos.size(); k++)
+                {
+                    if (infos[k].model_type == types[i] && infos_shared[k])
+                    {
+                        pending = k;
+                    }
+                }
+                if (pending >= 0)
+                {
+                    slot[i] = -(pending + 1);
+                    continue;
+                }
+                ax_algorithm_init_t info;
+                memset(&info, 0, sizeof(info));
+                info.model_type = types[i];
+                snprintf(info.model_file, sizeof(info.model_file), "%s", model_file_.c_str());
+                snprintf(info.license_path, sizeof(info.license_path), "%s", license_path_.c_str());
+                info.param = p;
+                infos.push_back(info);
+                infos_shared.push_back(shared);
+                slot[i] = -(int)infos.size();
+            }
+
+            std::vector<ax_algorithm_handle_t> created;
+            int ret = startup_profile::init_all(infos, created, prof_, parallel);
+            // 初始化已从映射读完模型，解除映射后模型文件不再计入 RSS，之后的初始化直接读页缓存
+            startup_profile::release_prefetch(model_file_);
+            if (ret != ax_error_code_success)
+            {
+                return ret;
+            }
+
+            size_t base = entries_.size();
+            for (size_t k = 0; k < infos.size(); k++)
+            {
+                entries_.push_back({created[k], infos[k].model_type, p, infos_shared[k], 0});
+            }
+            handles.resize(types.size());
+            for (size_t i = 0; i < types.size(); i++)
+            {
+                size_t index = slot[i] >= 0 ? slot[i] : base + (-slot[i] - 1);
+                entries_[index].refs++;
+                handles[i] = entries_[index].handle;
+            }
+            return ax_error_code_success;
+        }
+
+        /**
+         * @brief: 归还子句柄，最后一个使用者归还时释放
+         */
+        void release(ax_algorithm_handle_t handle)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (size_t i = 0; i < entries_.size(); i++)
+            {
+                if (entries_[i].handle == handle)
+                {
+                    if (--entries_[i].refs <= 0)
+                    {
+                        ax_algorithm_deinit(handle);
+                        entries_.erase(entries_.begin() + i);
+                    }
+                    return;
+                }
+            }
+        }
+
+        // 当前持有的子句柄数量
+        size_t n_handles() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return entries_.size();
+        }
+
+        void print() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            printf("model package %s (%lld bytes), %zu handles\n", model_file_.c_str(), model_bytes_, entries_.size());
+            for (auto &e : entries_)
+            {
+                printf("  %-20s %s refs=%d\n", startup_profile::model_type_name(e.type), e.shared ? "shared   " : "exclusive", e.refs);
+            }
+        }
+
+    private:
+        struct entry_t
+        {
+            ax_algorithm_handle_t handle;
+            ax_model_type_e type;
+            ax_algorithm_param_t param;
+            bool shared;
+            int refs;
+        };
+
+        int find(ax_model_type_e type, const ax_algorithm_param_t &param) const
+        {
+            for (size_t i = 0; i < entries_.size(); i++)
+            {
+                const entry_t &e = entries_[i];
+                if (e.shared && e.type == type && memcmp(&e.param, &param, sizeof(param)) == 0)
+                {
+                    return i;
+                }
+            }
+            return -1;
+        }
+
+        mutable std::mutex mutex_;
+        std::string model_file_;
+        std::string license_path_;
+        long long model_bytes_ = 0;
+        startup_profile::profiler *prof_ = nullptr;
+        std::vector<entry_t> entries_;
+    };
+}
@@ -0,0 +1,289 @@
+#pragma once
+#include <cstring>
+#include <cstdlib>
+#include <vector>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+#include "ax_algorithm_sdk.h"
+
+/**
+ * 基于 Y 平面的运动门控：
+ * 将 NV12/NV21 图像的 Y 平面按块下采样求亮度均值，与上一次推理帧的块均值做差分，
+ * 变化块占比低于阈值时认为画面静止，跳过 ax_algorithm_track，返回上一次的跟踪结果并按跳过的帧数老化：
+ * 置信度逐帧衰减，连续跳过 lost_frames 帧后不再输出这些目标。
+ * RGB/BGR 图像用 G 通道近似亮度。
+ */
+namespace motion_gate
+{
+    typedef struct _param_t
+    {
+        /**
+         * block_size: 下采样块边长(像素)，取 16 的倍数
+         * diff_threshold: 块亮度均值变化超过该值(0-255)认为该块发生变化
+         * changed_ratio: 变化块占比超过该值(0-1)认为画面发生变化，越小越灵敏
+         * max_skip_frames: 最多连续跳过的帧数，超过后强制推理一次，让跟踪器正常老化/结束轨迹，0 表示不限制
+         * score_decay: 跳过的帧中缓存目标的 score 每帧乘以该值，1 表示不衰减
+         * lost_frames: 连续跳过该帧数后缓存目标视为丢失，不再输出，0 表示不丢弃
+         */
+        int block_size;
+        int diff_threshold;
+        float changed_ratio;
+        int max_skip_frames;
+        float score_decay;
+        int lost_frames;
+    } param_t;
+
+    static param_t get_default_param()
+    {
+        param_t param;
+        param.block_size = 32;
+        param.diff_threshold = 8;
+        param.changed_ratio = 0.002f;
+        param.max_skip_frames = 25;
+        param.score_decay = 0.98f;
+        param.lost_frames = 0;
+        return param;
+    }
+
+    // 对一行中连续 n 个像素求和，n 为 16 的倍数
+    static inline unsigned int sum_row(const unsigned char *p, int n)
+    {
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+        uint16x8_t acc = vdupq_n_u16(0);
+        for (int i = 0; i < n; i += 16)
+        {
+            acc = vpadalq_u8(acc, vld1q_u8(p + i));
+        }
+        uint32x4_t acc32 = vpaddlq_u16(acc);
+        uint64x2_t acc64 = vpaddlq_u32(acc32);
+        return (unsigned int)(vgetq_lane_u64(acc64, 0) + vgetq_lane_u64(acc64, 1));
+#else
+        unsigned int sum = 0;
+        for (int i = 0; i < n; i++)
+        {
+            sum += p[i];
+        }
+        return sum;
+#endif
+    }
+
+    // 对一行中连续 n 个 RGB/BGR 像素的 G 通道求和
+    static inline unsigned int sum_row_g(const unsigned char *p, int n)
+    {
+        unsigned int sum = 0;
+        for (int i = 0; i < n; i++)
+        {
+            sum += p[i * 3 + 1];
+        }
+        return sum;
+    }
+
+    class gate
+    {
+    public:
+        gate() : param_(get_default_param())
+        {
+            reset();
+        }
+
+        explicit gate(const param_t &param) : param_(param)
+        {
+            reset();
+        }
+
+        param_t get_param() const
+        {
+            return param_;
+        }
+
+        void set_param(const param_t &param)
+        {
+            param_ = param;
+            reset();
+        }
+
+        void reset()
+        {
+            ref_means_.clear();
+            cur_means_.clear();
+            skipped_ = 0;
+            has_result_ = false;
+            memset(&last_result_, 0, sizeof(ax_result_t));
+        }
+
+        /**
+         * @brief: 判断当前帧相对上一次推理帧是否发生变化；返回 true 时参考帧不变，推理成功后由 set_result 更新
+         * @param[in] image: NV12/NV21/RGB/BGR 图像，其他格式始终返回 true
+         * @return true 表示需要推理，false 表示可以跳过
+         */
+        bool update(const ax_image_t *image)
+        {
+            if (image == nullptr || image->pVir == nullptr || image->eDtype == ax_color_space_unknown)
+            {
+                cur_means_.clear();
+                return true;
+            }
+            bool packed = image->eDtype == ax_color_space_rgb || image->eDtype == ax_color_space_bgr;
+
+            int block = param_.block_size < 16 ? 16 : param_.block_size / 16 * 16;
+            int stride = image->tStride_W > 0 ? image->tStride_W : (int)image->nWidth;
+            int bw = image->nWidth / block;
+            int bh = image->nHeight / block;
+            if (bw == 0 || bh == 0)
+            {
+                cur_means_.clear();
+                return true;
+            }
+
+            // 块内隔行采样，Y 平面只需读一半数据
+            cur_means_.assign(bw * bh, 0);
+            const unsigned char *y_plane = (const unsigned char *)image->pVir;
+            for (int by = 0; by < bh; by++)
+            {
+                unsigned int *sums = cur_means_.data() + by * bw;
+                for (int y = by * block; y < (by + 1) * block; y += 2)
+                {
+                    const unsigned char *row = y_plane + (size_t)y * stride * (packed ? 3 : 1);
+                    for (int bx = 0; bx < bw; bx++)
+                    {
+                        sums[bx] += packed ? sum_row_g(row + bx * block * 3, block) : sum_row(row + bx * block, block);
+                    }
+                }
+            }
+            unsigned int n_pixels = block * (block / 2);
+            for (size_t i = 0; i < cur_means_.size(); i++)
+            {
+                cur_means_[i] /= n_pixels;
+            }
+
+            if (ref_means_.size() != cur_means_.size() || !has_result_)
+            {
+                return true;
+            }
+
+            if (param_.max_skip_frames > 0 && skipped_ >= param_.max_skip_frames)
+            {
+                return true;
+            }
+
+            int n_changed = 0;
+            int max_changed = (int)(param_.changed_ratio * cur_means_.size());
+            for (size_t i = 0; i < cur_means_.size(); i++)
+            {
+                if (abs((int)cur_means_[i] - (int)ref_means_[i]) > param_.diff_threshold)
+                {
+                    if (++n_changed > max_changed)
+                    {
+                        return true;
+                    }
+                }
+            }
+
+            skipped_++;
+            return false;
+        }
+
+        /**
+         * @brief: 连续跳过推理的帧数，即缓存结果的"年龄"
+         */
+        int skipped_frames() const
+        {
+            return skipped_;
+        }
+
+        bool has_result() const
+        {
+            return has_result_;
+        }
+
+        const ax_result_t &last_result() const
+        {
+            return last_result_;
+        }
+
+        /**
+         * @brief: 推理成功后调用，保存结果，并把最近一次 update 的帧作为新的参考帧；推理失败时不调用，下一帧仍与上一次成功的推理帧比较
+         */
+        void set_result(const ax_result_t &result)
+        {
+            last_result_ = result;
+            has_result_ = true;
+            ref_means_.swap(cur_means_);
+            skipped_ = 0;
+        }
+
+        /**
+         * @brief: 按当前连续跳过的帧数老化缓存结果
+         * @param[out] result: 老化后的结果
+         */
+        void aged_result(ax_result_t *result) const
+        {
+            *result = last_result_;
+            if (param_.lost_frames > 0 && skipped_ >= param_.lost_frames)
+            {
+                result->n_objects = 0;
+                return;
+            }
+            float decay = 1.f;
+            for (int i = 0; i < skipped_; i++)
+            {
+                decay *= param_.score_decay;
+            }
+            for (int i = 0; i < result->n_objects; i++)
+            {
+                result->objects[i].score *= decay;
+            }
+        }
+
+    private:
+        param_t param_;
+        std::vector<unsigned int> ref_means_;
+        std::vector<unsigned int> cur_means_;
+        int skipped_;
+        bool has_result_;
+        ax_result_t last_result_;
+    };
+
+    /**
+     * @brief: 带运动门控的 ax_algorithm_track，画面静止时不调用 NPU，返回老化后的上一次跟踪结果
+     * @param[in] handle: 算法句柄
+     * @param[in] g: 每路视频一个 gate
+     * @param[in] image: 图像数据
+     * @param[out] result: 跟踪结果
+     * @param[in] track_fn: 替代 ax_algorithm_track 的函数，例如 algorithm_stats::track
+     * @param[out] skipped: 可选，1 表示本帧跳过了推理
+     * @return 0 成功，非零表示失败。
+     */
+    template <typename F>
+    static int track(ax_algorithm_handle_t handle, gate &g, ax_image_t *image, ax_result_t *result, F track_fn, int *skipped = nullptr)
+    {
+        if (!g.update(image))
+        {
+            g.aged_result(result);
+            if (skipped)
+            {
+                *skipped = 1;
+            }
+            return ax_error_code_success;
+        }
+
+        if (skipped)
+        {
+            *skipped = 0;
+        }
+        int ret = track_fn(handle, image, result);
+        if (ret == ax_error_code_success)
+        {
+            g.set_result(*result);
+        }
+        return ret;
+    }
+
+    static int track(ax_algorithm_handle_t handle, gate &g, ax_image_t *image, ax_result_t *result, int *skipped = nullptr)
+    {
+        return track(handle, g, image, result, ax_algorithm_track, skipped);
+    }
+}
@@ -0,0 +1,246 @@
+#pragma once
+#include <cstring>
+#include <vector>
+
+#include "ax_algorithm_sdk.h"
+#include "plate_render.hpp"
+
+/**
+ * 直接在 NV12/NV21 ax_image_t 上绘制框、关键点和车牌文字，不需要先转换成 BGR。
+ * UV 平面是 2x2 下采样的，矩形边界和线宽都对齐到偶数像素，保证亮度和色度覆盖同一区域，不会出现色边。
+ */
+namespace nv12_draw
+{
+    typedef struct _yuv_t
+    {
+        unsigned char y, u, v;
+    } yuv_t;
+
+    /**
+     * @brief: RGB 转 BT.601 limited range YUV，与 cv::COLOR_YUV2BGR_NV12 互逆
+     */
+    static inline yuv_t rgb2yuv(const unsigned char rgb[3])
+    {
+        int r = rgb[0], g = rgb[1], b = rgb[2];
+        yuv_t c;
+        c.y = (unsigned char)(16 + ((66 * r + 129 * g + 25 * b + 128) >> 8));
+        c.u = (unsigned char)(128 + ((-38 * r - 74 * g + 112 * b + 128) >> 8));
+        c.v = (unsigned char)(128 + ((112 * r - 94 * g - 18 * b + 128) >> 8));
+        return c;
+    }
+
+    static inline int y_stride(const ax_image_t *image)
+    {
+        return image->tStride_W > 0 ? image->tStride_W : (int)image->nWidth;
+    }
+
+    static inline unsigned char *uv_plane(const ax_image_t *image)
+    {
+        return (unsigned char *)image->pVir + (size_t)y_stride(image) * image->nHeight;
+    }
+
+    static inline bool is_yuv420sp(const ax_image_t *image)
+    {
+        return image->eDtype == ax_color_space_nv12 || image->eDtype == ax_color_space_nv21;
+    }
+
+    /**
+     * @brief: 填充矩形区域，坐标向外对齐到偶数
+     * @param[in,out] image: NV12/NV21 图像
+     * @param[in] x, y, w, h: 矩形区域(像素)
+     * @param[in] color: RGB 颜色
+     */
+    static void fill_rect(ax_image_t *image, int x, int y, int w, int h, const unsigned char color[3])
+    {
+        if (!is_yuv420sp(image) || w <= 0 || h <= 0)
+        {
+            return;
+        }
+        int x0 = x & ~1, y0 = y & ~1;
+        int x1 = (x + w + 1) & ~1, y1 = (y + h + 1) & ~1;
+        x0 = x0 < 0 ? 0 : x0;
+        y0 = y0 < 0 ? 0 : y0;
+        x1 = x1 > (int)(image->nWidth & ~1u) ? (int)(image->nWidth & ~1u) : x1;
+        y1 = y1 > (int)(image->nHeight & ~1u) ? (int)(image->nHeight & ~1u) : y1;
+        if (x0 >= x1 || y0 >= y1)
+        {
+            return;
+        }
+
+        yuv_t c = rgb2yuv(color);
+        int stride = y_stride(image);
+        unsigned char *y_base = (unsigned char *)image->pVir;
+        for (int row = y0; row < y1; row++)
+        {
+            memset(y_base + (size_t)row * stride + x0, c.y, x1 - x0);
+        }
+
+        unsigned char c0 = image->eDtype == ax_color_space_nv12 ? c.u : c.v;
+        unsigned char c1 = image->eDtype == ax_color_space_nv12 ? c.v : c.u;
+        unsigned char *uv_base = uv_plane(image);
+        for (int row = y0 / 2; row < y1 / 2; row++)
+        {
+            unsigned char *uv = uv_base + (size_t)row * stride + x0;
+            for (int i = 0; i < x1 - x0; i += 2)
+            {
+                uv[i] = c0;
+                uv[i + 1] = c1;
+            }
+        }
+    }
+
+    /**
+     * @brief: 绘制矩形框，线宽向上取偶数
+     */
+    static void rectangle(ax_image_t *image, const ax_bbox_t &bbox, const unsigned char color[3], int thickness = 2)
+    {
+        int t = (thickness + 1) & ~1;
+        int x = (int)bbox.x, y = (int)bbox.y, w = (int)bbox.w, h = (int)bbox.h;
+        fill_rect(image, x, y, w, t, color);
+        fill_rect(image, x, y + h - t, w, t, color);
+        fill_rect(image, x, y, t, h, color);
+        fill_rect(image, x + w - t, y, t, h, color);
+    }
+
+    /**
+     * @brief: 绘制关键点，每个点是边长 2*radius 的方块
+     */
+    static void points(ax_image_t *image, const ax_point_t *pts, int n, const unsigned char color[3], int radius = 2)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            fill_rect(image, (int)pts[i].x - radius, (int)pts[i].y - radius, radius * 2, radius * 2, color);
+        }
+    }
+
+    /**
+     * @brief: 用内置 3x5 点阵绘制数字标签(0-9、空格、'-'、':'，其它字符留空)，每个点是 scale x scale 的方块
+     * @param[in] x, y: 文字左下角，与 cv::putText 的 org 一致
+     * @param[in] scale: 点的边长，向上取偶数
+     */
+    static void text(ax_image_t *image, int x, int y, const char *str, const unsigned char color[3], int scale = 4)
+    {
+        // 每个字符 5 行，每行低 3 位从左到右
+        static const unsigned char font[13][5] = {
+            {7, 5, 5, 5, 7}, {2, 6, 2, 2, 7}, {7, 1, 7, 4, 7}, {7, 1, 7, 1, 7}, {5, 5, 7, 1, 1},
+            {7, 4, 7, 1, 7}, {7, 4, 7, 5, 7}, {7, 1, 1, 1, 1}, {7, 5, 7, 5, 7}, {7, 5, 7, 1, 7},
+            {0, 0, 0, 0, 0}, {0, 0, 7, 0, 0}, {0, 2, 0, 2, 0}};
+        int s = (scale + 1) & ~1;
+        int top = (y - 5 * s) & ~1;
+        x &= ~1;
+        for (const char *p = str; *p; p++, x += 4 * s)
+        {
+            int index = *p >= '0' && *p <= '9' ? *p - '0' : *p == '-' ? 11 : *p == ':' ? 12 : 10;
+            for (int row = 0; row < 5; row++)
+            {
+                for (int col = 0; col < 3; col++)
+                {
+                    if (font[index][row] & (4 >> col))
+                    {
+                        fill_rect(image, x + col * s, top + row * s, s, s, color);
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief: 使用 plate_render 的字形图集在 NV12/NV21 上绘制车牌文字，
+     *         Y 按像素 alpha 混合，UV 按 2x2 块的平均 alpha 混合
+     */
+    class plate_renderer : public plate_render::renderer
+    {
+    public:
+        explicit plate_renderer(float fontScale = 1.f) : plate_render::renderer(fontScale) {}
+
+        void draw(ax_image_t *image, const plate_render::plate_text_t *texts, int n)
+        {
+            if (!is_yuv420sp(image))
+            {
+                plate_render::renderer::draw(image, texts, n);
+                return;
+            }
+            for (int i = 0; i < n; i++)
+            {
+                const plate_render::plate_text_t &t = texts[i];
+                yuv_t c = rgb2yuv(t.color);
+                for_each_glyph(t, [&](const plate_render::glyph_t &g, int x, int y)
+                               { blend(image, g, x, y, c); });
+            }
+        }
+
+        void draw(ax_image_t *image, const ax_result_t *result, const unsigned char color[3])
+        {
+            std::vector<plate_render::plate_text_t> texts;
+            collect(result, color, texts);
+            draw(image, texts.data(), (int)texts.size());
+        }
+
+    private:
+        static inline unsigned char mix(unsigned char dst, unsigned char src, unsigned int a)
+        {
+            unsigned int v = dst * (255 - a) + src * a + 128;
+            return (unsigned char)((v + (v >> 8)) >> 8);
+        }
+
+        void blend(ax_image_t *image, const plate_render::glyph_t &g, int x, int y, const yuv_t &c)
+        {
+            int w = (int)image->nWidth, h = (int)image->nHeight;
+            int stride = y_stride(image);
+            const unsigned char *alpha = glyph_alpha(g);
+            unsigned char *y_base = (unsigned char *)image->pVir;
+            for (int row = 0; row < g.h; row++)
+            {
+                int py = y + row;
+                if (py < 0 || py >= h)
+                {
+                    continue;
+                }
+                for (int col = 0; col < g.w; col++)
+                {
+                    int px = x + col;
+                    unsigned int a = alpha[row * g.w + col];
+                    if (a && px >= 0 && px < w)
+                    {
+                        unsigned char *p = y_base + (size_t)py * stride + px;
+                        *p = mix(*p, c.y, a);
+                    }
+                }
+            }
+
+            unsigned char c0 = image->eDtype == ax_color_space_nv12 ? c.u : c.v;
+            unsigned char c1 = image->eDtype == ax_color_space_nv12 ? c.v : c.u;
+            unsigned char *uv_base = uv_plane(image);
+            for (int cy = (y & ~1); cy < y + g.h; cy += 2)
+            {
+                if (cy < 0 || cy + 1 >= h)
+                {
+                    continue;
+                }
+                for (int cx = (x & ~1); cx < x + g.w; cx += 2)
+                {
+                    if (cx < 0 || cx + 1 >= w)
+                    {
+                        continue;
+                    }
+                    unsigned int sum = 0;
+                    for (int k = 0; k < 4; k++)
+                    {
+                        int gx = cx + (k & 1) - x, gy = cy + (k >> 1) - y;
+                        if (gx >= 0 && gx < g.w && gy >= 0 && gy < g.h)
+                        {
+                            sum += alpha[gy * g.w + gx];
+                        }
+                    }
+                    if (sum == 0)
+                    {
+                        continue;
+                    }
+                    unsigned char *uv = uv_base + (size_t)(cy / 2) * stride + cx;
+                    uv[0] = mix(uv[0], c0, sum / 4);
+                    uv[1] = mix(uv[1], c1, sum / 4);
+                }
+            }
+        }
+    };
+}
@@ -0,0 +1,194 @@
+#pragma once
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
+
+#include "ax_algorithm_sdk.h"
+#include "algorithm_stats.hpp"
+#include "trace.hpp"
+
+/**
+ * 不阻塞推理线程的参数更新：
+ * - store 保存一份不可变的参数快照，写者(例如管理界面)发布新快照，不需要等待任何推理调用
+ * - bound_handle 包装一个句柄，每次调用可以传入单独的 ax_algorithm_param_t，不传时使用 store 的当前快照；
+ *   生效参数与句柄上一次 set_param 的值不同时才调用 ax_algorithm_set_param
+ * SDK 的参数是句柄状态，set_param 与推理必须成对执行，所以同一句柄上的调用在 bound_handle 内串行，
+ * 等待这个锁的时间可以上报给 algorithm_stats 的 stage_queue_wait，trace 打开时同时记录为 bound_handle_wait 事件；
+ * 写者只替换快照，从不进入这个锁。
+ * 推理线程在快照未变化时只读一个原子版本号。
+ */
+namespace param_snapshot
+{
+    class store
+    {
+    public:
+        explicit store(const ax_algorithm_param_t &param)
+            : snapshot_(std::make_shared<const ax_algorithm_param_t>(param)) {}
+
+        store() : store(ax_algorithm_get_default_param()) {}
+
+        store(const store &) = delete;
+        store &operator=(const store &) = delete;
+
+        /**
+         * @brief: 发布新的参数快照，之后的调用开始使用
+         */
+        void publish(const ax_algorithm_param_t &param)
+        {
+            std::lock_guard<std::mutex> lock(writer_mutex_);
+            std::atomic_store(&snapshot_, std::make_shared<const ax_algorithm_param_t>(param));
+            version_.fetch_add(1, std::memory_order_release);
+        }
+
+        /**
+         * @brief: 在当前快照的基础上修改并发布，多个写者之间不会丢失修改
+         * @param[in] fn: void(ax_algorithm_param_t &)
+         */
+        template <typename F>
+        void update(F fn)
+        {
+            std::lock_guard<std::mutex> lock(writer_mutex_);
+            ax_algorithm_param_t param = *std::atomic_load(&snapshot_);
+            fn(param);
+            std::atomic_store(&snapshot_, std::make_shared<const ax_algorithm_param_t>(param));
+            version_.fetch_add(1, std::memory_order_release);
+        }
+
+        std::shared_ptr<const ax_algorithm_param_t> get() const
+        {
+            return std::atomic_load(&snapshot_);
+        }
+
+        // 每次发布加一，读者据此判断缓存的快照是否过期
+        unsigned long long version() const
+        {
+            return version_.load(std::memory_order_acquire);
+        }
+
+    private:
+        std::shared_ptr<const ax_algorithm_param_t> snapshot_;
+        std::atomic<unsigned long long> version_{0};
+        std::mutex writer_mutex_;
+    };
+
+    class bound_handle
+    {
+    public:
+        /**
+         * @param[in] handle: 算法句柄
+         * @param[in] defaults: 不传单次参数时使用的快照，为空时使用构造时句柄上的参数
+         * @param[in] report_wait: 每次调用把等待句柄锁的时间上报给 algorithm_stats::add_queue_wait
+         */
+        bound_handle(ax_algorithm_handle_t handle, const store *defaults = nullptr, bool report_wait = false)
+            : handle_(handle), defaults_(defaults), report_wait_(report_wait)
+        {
+            applied_ = ax_algorithm_get_param(handle_);
+            cached_ = applied_;
+        }
+
+        bound_handle(const bound_handle &) = delete;
+        bound_handle &operator=(const bound_handle &) = delete;
+
+        ax_algorithm_handle_t handle() const { return handle_; }
+
+        // 实际调用 ax_algorithm_set_param 的次数
+        unsigned long long set_param_calls() const { return set_param_calls_.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief: 同 ax_algorithm_track
+         * @param[in] param: 本次调用使用的参数，为空时使用快照
+         * @param[in] track_fn: 替代 ax_algorithm_track 的函数，例如 algorithm_stats::track
+         */
+        template <typename F>
+        int track(ax_image_t *image, ax_result_t *result, const ax_algorithm_param_t *param, F track_fn)
+        {
+            std::unique_lock<std::mutex> lock = acquire();
+            apply(param);
+            return track_fn(handle_, image, result);
+        }
+
+        int track(ax_image_t *image, ax_result_t *result, const ax_algorithm_param_t *param = nullptr)
+        {
+            return track(image, result, param, ax_algorithm_track);
+        }
+
+        template <typename F>
+        int detect(ax_image_t *image, ax_result_t *result, const ax_algorithm_param_t *param, F detect_fn)
+        {
+            std::unique_lock<std::mutex> lock = acquire();
+            apply(param);
+            return detect_fn(handle_, image, result);
+        }
+
+        int detect(ax_image_t *image, ax_result_t *result, const ax_algorithm_param_t *param = nullptr)
+        {
+            return detect(image, result, param, ax_algorithm_detect);
+        }
+
+        /**
+         * @brief: 在句柄锁内执行不涉及参数的调用，例如 ax_algorithm_get_face_feature
+         * @param[in] fn: int(ax_algorithm_handle_t)
+         */
+        template <typename F>
+        int call(F fn)
+        {
+            std::unique_lock<std::mutex> lock = acquire();
+            return fn(handle_);
+        }
+
+    private:
+        std::unique_lock<std::mutex> acquire()
+        {
+            bool tracing = trace::enabled();
+            if (!report_wait_ && !tracing)
+            {
+                return std::unique_lock<std::mutex>(mutex_);
+            }
+            unsigned long long t0 = algorithm_stats::detail::now_ns();
+            std::unique_lock<std::mutex> lock(mutex_);
+            unsigned long long wait_ns = algorithm_stats::detail::now_ns() - t0;
+            if (report_wait_)
+            {
+                algorithm_stats::add_queue_wait(handle_, wait_ns);
+            }
+            if (tracing)
+            {
+                // 与 trace::now_us 同为 steady_clock；流和帧号由调用方外层的事件给出
+                trace::record("bound_handle_wait", t0 / 1e3, wait_ns / 1e3, -1, -1);
+            }
+            return lock;
+        }
+
+        // 调用方已持有 mutex_
+        void apply(const ax_algorithm_param_t *param)
+        {
+            if (param == nullptr)
+            {
+                unsigned long long version = defaults_ ? defaults_->version() : cached_version_;
+                if (version != cached_version_)
+                {
+                    cached_ = *defaults_->get();
+                    cached_version_ = version;
+                }
+                param = &cached_;
+            }
+            if (memcmp(param, &applied_, sizeof(applied_)) == 0)
+            {
+                return;
+            }
+            applied_ = *param;
+            ax_algorithm_set_param(handle_, &applied_);
+            set_param_calls_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        ax_algorithm_handle_t handle_;
+        const store *defaults_;
+        bool report_wait_;
+        std::mutex mutex_;
+        ax_algorithm_param_t applied_; // 句柄上当前生效的参数
+        ax_algorithm_param_t cached_;  // defaults_ 的本地副本
+        unsigned long long cached_version_ = ~0ull;
+        std::atomic<unsigned long long> set_param_calls_{0};
+    };
+}
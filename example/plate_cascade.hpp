@@ -0,0 +1,203 @@
+#pragma once
+#include <cstring>
+#include <unordered_map>
+
+#include "ax_algorithm_sdk.h"
+#include "track_events.hpp"
+
+/**
+ * ax_model_type_lpr 的车牌确定(级联)模式：
+ * 同一 track_id 连续 settle_count 次识别出相同车牌(SDK 只上报高于 lpr_threshold 的车牌)后认为该轨迹的车牌已确定，
+ * 之后该轨迹输出确定的车牌，不再随单帧识别结果跳变；另一个车牌同样连续 settle_count 次读出时替换，
+ * 车框相对确定时几何变化过大时取消确定，重新投票。
+ * 每个轨迹单独判断，不影响同一画面中未确定的车辆。
+ * 预编译的 SDK 没有跳过车牌识别的接口，ax_algorithm_track 每帧仍然运行车牌检测和识别，这里不节省 NPU 计算；
+ * 级联不修改句柄参数，多个 cascade 可以共用一个句柄。
+ */
+namespace plate_cascade
+{
+    typedef struct _param_t
+    {
+        /**
+         * settle_count: 连续读到相同车牌的次数，达到后车牌确定
+         * geometry_iou: 车框与确定时的车框 IoU 低于该值时重新投票
+         * lost_frames: track_id 连续多少帧未出现后丢弃其车牌历史
+         */
+        int settle_count;
+        float geometry_iou;
+        int lost_frames;
+    } param_t;
+
+    static param_t get_default_param()
+    {
+        param_t param;
+        param.settle_count = 3;
+        param.geometry_iou = 0.5f;
+        param.lost_frames = 50;
+        return param;
+    }
+
+    class cascade
+    {
+    public:
+        cascade() : param_(get_default_param())
+        {
+            reset();
+        }
+
+        explicit cascade(const param_t &param) : param_(param)
+        {
+            reset();
+        }
+
+        void set_param(const param_t &param)
+        {
+            param_ = param;
+            reset();
+        }
+
+        void reset()
+        {
+            tracks_.clear();
+            frame_ = 0;
+            cached_plates_ = 0;
+        }
+
+        bool is_settled(unsigned long int track_id) const
+        {
+            auto it = tracks_.find(track_id);
+            return it != tracks_.end() && it->second.settled;
+        }
+
+        /**
+         * @brief: ax_algorithm_track 之后调用，更新车牌投票，并把已确定的车牌填回 result
+         * @param[in,out] result: ax_algorithm_track 的结果
+         * @param[in] recognised: 本帧的结果是否来自 SDK，例如运动门控跳过的帧传 false，不参与投票
+         */
+        void update(ax_result_t *result, bool recognised = true)
+        {
+            frame_++;
+
+            for (int i = 0; i < result->n_objects; i++)
+            {
+                auto &obj = result->objects[i];
+                if (obj.track_id == 0)
+                {
+                    continue;
+                }
+
+                track_t &t = tracks_[obj.track_id];
+                t.last_frame = frame_;
+                auto &vi = obj.vehicle_info;
+                bool fresh = recognised && vi.b_is_track_plate == 0 && vi.len_plate_id > 0;
+                if (t.settled && track_events::iou(obj.bbox, t.settle_bbox) < param_.geometry_iou)
+                {
+                    t.settled = false;
+                    t.vote.len = 0;
+                    t.count = 0;
+                }
+                if (fresh)
+                {
+                    if (same_plate(t.vote, vi.plate_id, vi.len_plate_id))
+                    {
+                        t.count++;
+                    }
+                    else
+                    {
+                        t.count = 1;
+                        t.vote.len = vi.len_plate_id;
+                        memcpy(t.vote.id, vi.plate_id, sizeof(int) * vi.len_plate_id);
+                    }
+                    if (t.count >= param_.settle_count && !(t.settled && same_plate(t.plate, t.vote.id, t.vote.len)))
+                    {
+                        t.settled = true;
+                        t.plate = t.vote;
+                        t.settle_bbox = obj.bbox;
+                    }
+                }
+
+                if (t.settled && !(fresh && same_plate(t.plate, vi.plate_id, vi.len_plate_id)))
+                {
+                    vi.b_is_track_plate = 1;
+                    vi.len_plate_id = t.plate.len;
+                    memcpy(vi.plate_id, t.plate.id, sizeof(int) * t.plate.len);
+                    cached_plates_++;
+                }
+            }
+
+            for (auto it = tracks_.begin(); it != tracks_.end();)
+            {
+                if (frame_ - it->second.last_frame >= param_.lost_frames)
+                {
+                    it = tracks_.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+
+        // 已处理的帧数和其中用缓存车牌填回的目标数
+        long long frames() const { return frame_; }
+        long long cached_plates() const { return cached_plates_; }
+
+    private:
+        struct plate_t
+        {
+            int len;
+            int id[16];
+        };
+
+        struct track_t
+        {
+            track_t() : settled(false), count(0), last_frame(0)
+            {
+                plate.len = 0;
+                vote.len = 0;
+                memset(&settle_bbox, 0, sizeof(ax_bbox_t));
+            }
+            bool settled;
+            plate_t plate; // 确定的车牌
+            plate_t vote;  // 正在投票的车牌，连续读到的次数为 count
+            int count;
+            ax_bbox_t settle_bbox;
+            long long last_frame;
+        };
+
+        static bool same_plate(const plate_t &p, const int *plate_id, int len)
+        {
+            return p.len == len && memcmp(p.id, plate_id, sizeof(int) * len) == 0;
+        }
+
+        param_t param_;
+        std::unordered_map<unsigned long int, track_t> tracks_;
+        long long frame_;
+        long long cached_plates_;
+    };
+
+    /**
+     * @brief: 级联模式的 ax_algorithm_track，已确定车牌的轨迹输出缓存的车牌
+     * @param[in] handle: ax_model_type_lpr 算法句柄
+     * @param[in] c: 每路视频一个 cascade
+     * @param[in] image: 图像数据
+     * @param[out] result: 跟踪结果
+     * @param[in] track_fn: 替代 ax_algorithm_track 的函数，例如 algorithm_stats::track
+     * @return 0 成功，非零表示失败。
+     */
+    template <typename F>
+    static int track(ax_algorithm_handle_t handle, cascade &c, ax_image_t *image, ax_result_t *result, F track_fn)
+    {
+        int ret = track_fn(handle, image, result);
+        if (ret == ax_error_code_success)
+        {
+            c.update(result);
+        }
+        return ret;
+    }
+
+    static int track(ax_algorithm_handle_t handle, cascade &c, ax_image_t *image, ax_result_t *result)
+    {
+        return track(handle, c, image, result, ax_algorithm_track);
+    }
+}
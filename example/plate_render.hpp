@@ -0,0 +1,294 @@
+#pragma once
+#include <cstring>
+#include <vector>
+#include <unordered_map>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+#include "ax_algorithm_sdk.h"
+#include "putTextPlate.h"
+
+/**
+ * 带字形缓存的车牌文字批量绘制：
+ * 每个 plate_id(包括省份汉字)第一次出现时用 putTextPlateID 栅格化一次，取出 alpha 存入字形图集，
+ * 之后整帧的车牌在一次 draw 调用中直接从图集做 alpha 混合，不再逐车调用 putTextPlateID。
+ * renderer 内部有懒加载的缓存，不是线程安全的，每个绘制线程使用一个 renderer。
+ */
+namespace plate_render
+{
+    typedef struct _plate_text_t
+    {
+        int plate_id[16];
+        int len_plate_id;
+        ax_point_t org;
+        unsigned char color[3];
+    } plate_text_t;
+
+    typedef struct _glyph_t
+    {
+        size_t offset; // alpha 在图集中的起始位置
+        int w, h;
+        int dx, dy;    // 左上角相对画笔位置的偏移
+        int advance;
+    } glyph_t;
+
+    // dst = (dst * (255 - a) + c * a) / 255, 对 3 通道交错的 n 个像素
+    static inline void blend_row_c3(unsigned char *dst, const unsigned char *alpha, int n, const unsigned char color[3])
+    {
+        int i = 0;
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+        uint8x16_t c0 = vdupq_n_u8(color[0]);
+        uint8x16_t c1 = vdupq_n_u8(color[1]);
+        uint8x16_t c2 = vdupq_n_u8(color[2]);
+        for (; i + 16 <= n; i += 16)
+        {
+            uint8x16_t a = vld1q_u8(alpha + i);
+            uint8x16_t ia = vmvnq_u8(a);
+            uint8x16x3_t px = vld3q_u8(dst + i * 3);
+            uint8x16_t *ch[3] = {&px.val[0], &px.val[1], &px.val[2]};
+            uint8x16_t cc[3] = {c0, c1, c2};
+            for (int k = 0; k < 3; k++)
+            {
+                uint16x8_t lo = vmull_u8(vget_low_u8(*ch[k]), vget_low_u8(ia));
+                uint16x8_t hi = vmull_u8(vget_high_u8(*ch[k]), vget_high_u8(ia));
+                lo = vmlal_u8(lo, vget_low_u8(cc[k]), vget_low_u8(a));
+                hi = vmlal_u8(hi, vget_high_u8(cc[k]), vget_high_u8(a));
+                // x / 255 ~= (x + 128 + ((x + 128) >> 8)) >> 8
+                lo = vaddq_u16(lo, vdupq_n_u16(128));
+                hi = vaddq_u16(hi, vdupq_n_u16(128));
+                *ch[k] = vcombine_u8(vaddhn_u16(lo, vshrq_n_u16(lo, 8)), vaddhn_u16(hi, vshrq_n_u16(hi, 8)));
+            }
+            vst3q_u8(dst + i * 3, px);
+        }
+#endif
+        for (; i < n; i++)
+        {
+            unsigned int a = alpha[i];
+            if (a == 0)
+            {
+                continue;
+            }
+            for (int k = 0; k < 3; k++)
+            {
+                unsigned int x = dst[i * 3 + k] * (255 - a) + color[k] * a + 128;
+                dst[i * 3 + k] = (unsigned char)((x + (x >> 8)) >> 8);
+            }
+        }
+    }
+
+    class renderer
+    {
+    public:
+        explicit renderer(float fontScale = 1.f) : font_scale_(fontScale), default_advance_(0), align_ratio_(0.f)
+        {
+            canvas_w_ = (int)(512 * fontScale);
+            canvas_h_ = (int)(256 * fontScale);
+        }
+
+        /**
+         * @brief: 预先栅格化一组 plate_id，避免首帧绘制时的栅格化开销
+         */
+        void preload(const int *plate_id, int len)
+        {
+            for (int i = 0; i < len; i++)
+            {
+                get_glyph(plate_id[i]);
+            }
+        }
+
+        /**
+         * @brief: 一次绘制一帧内的所有车牌文字
+         * @param[in,out] image: BGR/RGB 图像(eDtype 为 unknown 时按 3 通道处理)
+         * @param[in] texts: 车牌数组
+         * @param[in] n: 车牌数量
+         */
+        void draw(ax_image_t *image, const plate_text_t *texts, int n)
+        {
+            for (int i = 0; i < n; i++)
+            {
+                const plate_text_t &t = texts[i];
+                for_each_glyph(t, [&](const glyph_t &g, int x, int y)
+                               { blend_c3(image, g, x, y, t.color); });
+            }
+        }
+
+        /**
+         * @brief: 绘制 ax_model_type_lpr 结果中的所有车牌，位置与示例一致(车框中心)
+         */
+        void draw(ax_image_t *image, const ax_result_t *result, const unsigned char color[3])
+        {
+            std::vector<plate_text_t> texts;
+            collect(result, color, texts);
+            draw(image, texts.data(), (int)texts.size());
+        }
+
+        static void collect(const ax_result_t *result, const unsigned char color[3], std::vector<plate_text_t> &texts)
+        {
+            for (int i = 0; i < result->n_objects; i++)
+            {
+                auto &obj = result->objects[i];
+                if (obj.vehicle_info.len_plate_id <= 0)
+                {
+                    continue;
+                }
+                plate_text_t t;
+                t.len_plate_id = obj.vehicle_info.len_plate_id > 16 ? 16 : obj.vehicle_info.len_plate_id;
+                memcpy(t.plate_id, obj.vehicle_info.plate_id, sizeof(int) * t.len_plate_id);
+                t.org.x = obj.bbox.x + obj.bbox.w / 2;
+                t.org.y = obj.bbox.y + obj.bbox.h / 2;
+                memcpy(t.color, color, 3);
+                texts.push_back(t);
+            }
+        }
+
+    protected:
+        // 按 putTextPlateID 的排版规则遍历字形，回调参数为字形和它左上角在图像中的位置
+        template <typename F>
+        void for_each_glyph(const plate_text_t &t, F fn)
+        {
+            const glyph_t *glyphs[16];
+            int len = t.len_plate_id > 16 ? 16 : t.len_plate_id;
+            int extra = 0;
+            for (int i = 0; i < len; i++)
+            {
+                glyphs[i] = &get_glyph(t.plate_id[i]);
+                if (i > 0)
+                {
+                    extra += glyphs[i]->advance;
+                }
+            }
+
+            int pen_x = (int)(t.org.x + align_ratio_ * extra);
+            int pen_y = (int)t.org.y;
+            for (int i = 0; i < len; i++)
+            {
+                const glyph_t &g = *glyphs[i];
+                if (g.w > 0 && g.h > 0)
+                {
+                    fn(g, pen_x + g.dx, pen_y + g.dy);
+                }
+                pen_x += g.advance;
+            }
+        }
+
+        const unsigned char *glyph_alpha(const glyph_t &g) const
+        {
+            return atlas_.data() + g.offset;
+        }
+
+        const glyph_t &get_glyph(int plate_id)
+        {
+            auto it = glyphs_.find(plate_id);
+            if (it != glyphs_.end())
+            {
+                return it->second;
+            }
+            return glyphs_[plate_id] = rasterize(plate_id);
+        }
+
+    private:
+        struct extent_t
+        {
+            int x0, y0, x1, y1;
+        };
+
+        // 在空白画布上用白色绘制 ids，返回非零像素的外接框
+        extent_t render(const int *ids, int len)
+        {
+            canvas_.assign((size_t)canvas_w_ * canvas_h_ * 3, 0);
+            ax_image_t image = {0};
+            image.nWidth = canvas_w_;
+            image.nHeight = canvas_h_;
+            image.pVir = canvas_.data();
+            ax_point_t org = {(float)(canvas_w_ / 4), (float)(canvas_h_ / 2)};
+            unsigned char white[3] = {255, 255, 255};
+            putTextPlateID(&image, (int *)ids, len, &org, white, font_scale_);
+
+            extent_t e = {canvas_w_, canvas_h_, -1, -1};
+            for (int y = 0; y < canvas_h_; y++)
+            {
+                const unsigned char *row = canvas_.data() + (size_t)y * canvas_w_ * 3;
+                for (int x = 0; x < canvas_w_; x++)
+                {
+                    if (row[x * 3])
+                    {
+                        e.x0 = x < e.x0 ? x : e.x0;
+                        e.x1 = x > e.x1 ? x : e.x1;
+                        e.y0 = y < e.y0 ? y : e.y0;
+                        e.y1 = y > e.y1 ? y : e.y1;
+                    }
+                }
+            }
+            return e;
+        }
+
+        glyph_t rasterize(int plate_id)
+        {
+            glyph_t g = {0};
+            int org_x = canvas_w_ / 4, org_y = canvas_h_ / 2;
+
+            // 先画两个相同字符，由宽度差得到字符步进，由左边界移动量得到对齐方式(左对齐或居中)
+            int pair[2] = {plate_id, plate_id};
+            extent_t e2 = render(pair, 2);
+            extent_t e1 = render(pair, 1);
+            if (e1.x1 < 0)
+            {
+                g.advance = default_advance_;
+                return g;
+            }
+
+            g.w = e1.x1 - e1.x0 + 1;
+            g.h = e1.y1 - e1.y0 + 1;
+            g.dx = e1.x0 - org_x;
+            g.dy = e1.y0 - org_y;
+            g.advance = (e2.x1 - e2.x0) - (e1.x1 - e1.x0);
+            if (g.advance > 0)
+            {
+                default_advance_ = g.advance;
+                align_ratio_ = (float)(e2.x0 - e1.x0) / g.advance;
+            }
+
+            g.offset = atlas_.size();
+            atlas_.resize(atlas_.size() + (size_t)g.w * g.h);
+            for (int y = 0; y < g.h; y++)
+            {
+                const unsigned char *src = canvas_.data() + ((size_t)(e1.y0 + y) * canvas_w_ + e1.x0) * 3;
+                unsigned char *dst = atlas_.data() + g.offset + (size_t)y * g.w;
+                for (int x = 0; x < g.w; x++)
+                {
+                    dst[x] = src[x * 3];
+                }
+            }
+            return g;
+        }
+
+        void blend_c3(ax_image_t *image, const glyph_t &g, int x, int y, const unsigned char color[3])
+        {
+            int stride = image->tStride_W > 0 ? image->tStride_W : (int)image->nWidth;
+            int sx = x < 0 ? -x : 0;
+            int sy = y < 0 ? -y : 0;
+            int ex = x + g.w > (int)image->nWidth ? (int)image->nWidth - x : g.w;
+            int ey = y + g.h > (int)image->nHeight ? (int)image->nHeight - y : g.h;
+            if (sx >= ex || sy >= ey)
+            {
+                return;
+            }
+            unsigned char *base = (unsigned char *)image->pVir;
+            for (int row = sy; row < ey; row++)
+            {
+                unsigned char *dst = base + ((size_t)(y + row) * stride + x + sx) * 3;
+                blend_row_c3(dst, glyph_alpha(g) + (size_t)row * g.w + sx, ex - sx, color);
+            }
+        }
+
+        float font_scale_;
+        int canvas_w_, canvas_h_;
+        int default_advance_;
+        float align_ratio_;
+        std::vector<unsigned char> canvas_;
+        std::vector<unsigned char> atlas_;
+        std::unordered_map<int, glyph_t> glyphs_;
+    };
+}
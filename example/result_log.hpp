@@ -0,0 +1,601 @@
+#pragma once
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "ax_algorithm_sdk.h"
+
+/**
+ * 二进制结果日志，用于长时间录制 ax_result_t：
+ * - <path>：64 字节文件头 + 定长 128 字节记录，每个目标一条，没有目标的帧写一条 n_objects = 0 的占位记录
+ * - <path>.idx：每帧一条 32 字节索引(帧号、时间戳、第一条记录的位置、记录数)
+ * 两个文件都只追加；读取时 mmap 后直接按结构体访问，不需要解析。字节序为小端，与 AX650 和 x86 一致。
+ * 索引项先缓存在内存中，对应的记录 fflush 之后才写入，所以进程退出时索引只会落后于记录；
+ * 索引缺失或落后(例如录制中途断电)时读取端扫描记录重建，追加打开时写入端按记录修正索引。
+ */
+namespace result_log
+{
+    enum
+    {
+        version = 1,
+        max_plate_len = 16,
+    };
+
+    static const char magic[8] = {'A', 'X', 'R', 'L', 'O', 'G', 0, 0};
+
+    typedef struct _file_header_t
+    {
+        char magic[8];
+        unsigned int version;
+        unsigned int header_size;
+        unsigned int record_size;
+        unsigned int index_entry_size;
+        long long created_us;
+        unsigned char reserved[32];
+    } file_header_t;
+
+    typedef struct _record_t
+    {
+        unsigned long long frame_id;
+        long long timestamp_us;
+        unsigned long long track_id;
+        int model_type;
+        int stream_id;
+        ax_bbox_t bbox;
+        float score;
+        int label;
+        unsigned short obj_index;
+        unsigned short n_objects; // 0 表示这一帧没有目标，其余字段无意义
+        unsigned int reserved0;
+        union
+        {
+            struct
+            {
+                float quality;
+                ax_point_t points[AX_ALGORITHM_FACE_POINT_LEN];
+            } face;
+            struct
+            {
+                int status;
+            } person;
+            struct
+            {
+                int label;
+            } fire_smoke;
+            struct
+            {
+                int cartype;
+                signed char b_is_track_plate;
+                signed char len_plate_id;
+                short plate_id[max_plate_len];
+            } vehicle;
+            unsigned char raw[48];
+        } info;
+        unsigned char reserved1[16];
+    } record_t;
+
+    typedef struct _index_entry_t
+    {
+        unsigned long long frame_id;
+        long long timestamp_us;
+        unsigned long long first_record;
+        unsigned int n_records;
+        int stream_id;
+    } index_entry_t;
+
+    static_assert(sizeof(file_header_t) == 64, "file_header_t layout");
+    static_assert(sizeof(record_t) == 128, "record_t layout");
+    static_assert(sizeof(index_entry_t) == 32, "index_entry_t layout");
+
+    static inline std::string index_path(const std::string &path)
+    {
+        return path + ".idx";
+    }
+
+    // mmap 只读打开整个文件，文件不存在或为空时返回 nullptr
+    static const char *map_file(const std::string &path, size_t *size)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return nullptr;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0)
+        {
+            ::close(fd);
+            return nullptr;
+        }
+        void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED)
+        {
+            return nullptr;
+        }
+        madvise(p, st.st_size, MADV_SEQUENTIAL);
+        *size = st.st_size;
+        return (const char *)p;
+    }
+
+    // 去掉末尾不完整的帧(写一帧的中途退出)，返回完整帧的记录数
+    static size_t complete_records(const record_t *records, size_t n)
+    {
+        if (n == 0)
+        {
+            return 0;
+        }
+        const record_t &last = records[n - 1];
+        size_t expected = last.n_objects > 0 ? last.n_objects : 1;
+        return (size_t)last.obj_index + 1 >= expected ? n : n - last.obj_index - 1;
+    }
+
+    // 索引中与记录一致的前缀长度：每一项紧接上一项，且不超出 n_records
+    static size_t valid_index_prefix(const index_entry_t *entries, size_t n, size_t n_records)
+    {
+        size_t covered = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            if (entries[i].first_record != covered || entries[i].n_records == 0 || covered + entries[i].n_records > n_records)
+            {
+                return i;
+            }
+            covered += entries[i].n_records;
+        }
+        return n;
+    }
+
+    // 从第 first 条记录开始，按 (stream_id, frame_id) 变化切分帧，追加到 entries
+    static void rebuild_index(const record_t *records, size_t first, size_t n_records, std::vector<index_entry_t> &entries)
+    {
+        for (size_t i = first; i < n_records; i++)
+        {
+            const record_t &r = records[i];
+            if (i == first || r.frame_id != records[i - 1].frame_id || r.stream_id != records[i - 1].stream_id)
+            {
+                index_entry_t e;
+                e.frame_id = r.frame_id;
+                e.timestamp_us = r.timestamp_us;
+                e.first_record = i;
+                e.n_records = 0;
+                e.stream_id = r.stream_id;
+                entries.push_back(e);
+            }
+            entries.back().n_records++;
+        }
+    }
+
+    // ax_result_t 中的一个目标转成记录
+    static void to_record(const ax_result_t &result, int i, record_t &r)
+    {
+        auto &obj = result.objects[i];
+        r.track_id = obj.track_id;
+        r.model_type = result.model_type;
+        r.bbox = obj.bbox;
+        r.score = obj.score;
+        r.label = obj.label;
+        r.obj_index = i;
+        r.n_objects = result.n_objects;
+        switch (result.model_type)
+        {
+        case ax_model_type_face_detection:
+        case ax_model_type_face_recognition:
+            r.info.face.quality = obj.face_info.quality;
+            memcpy(r.info.face.points, obj.face_info.points, sizeof(r.info.face.points));
+            break;
+        case ax_model_type_person_detection:
+            r.info.person.status = obj.person_info.status;
+            break;
+        case ax_model_type_fire_smoke:
+            r.info.fire_smoke.label = obj.fire_smoke_info.label;
+            break;
+        case ax_model_type_lpr:
+            r.info.vehicle.cartype = obj.vehicle_info.cartype;
+            r.info.vehicle.b_is_track_plate = obj.vehicle_info.b_is_track_plate;
+            r.info.vehicle.len_plate_id = obj.vehicle_info.len_plate_id;
+            for (int k = 0; k < max_plate_len; k++)
+            {
+                r.info.vehicle.plate_id[k] = obj.vehicle_info.plate_id[k];
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    /**
+     * @brief: 把一帧的记录还原成 ax_result_t
+     * @param[in] records: 同一帧的连续记录
+     * @param[in] n: 记录数
+     */
+    static void to_result(const record_t *records, size_t n, ax_result_t *result)
+    {
+        memset(result, 0, sizeof(ax_result_t));
+        if (n == 0)
+        {
+            return;
+        }
+        result->model_type = (ax_model_type_e)records[0].model_type;
+        for (size_t j = 0; j < n && result->n_objects < AX_ALGORITHM_MAX_OBJ_NUM; j++)
+        {
+            const record_t &r = records[j];
+            if (r.n_objects == 0)
+            {
+                continue;
+            }
+            auto &obj = result->objects[result->n_objects++];
+            obj.bbox = r.bbox;
+            obj.score = r.score;
+            obj.label = r.label;
+            obj.track_id = r.track_id;
+            switch (r.model_type)
+            {
+            case ax_model_type_face_detection:
+            case ax_model_type_face_recognition:
+                obj.face_info.quality = r.info.face.quality;
+                memcpy(obj.face_info.points, r.info.face.points, sizeof(obj.face_info.points));
+                break;
+            case ax_model_type_person_detection:
+                obj.person_info.status = r.info.person.status;
+                break;
+            case ax_model_type_fire_smoke:
+                obj.fire_smoke_info.label = r.info.fire_smoke.label;
+                break;
+            case ax_model_type_lpr:
+                obj.vehicle_info.cartype = r.info.vehicle.cartype;
+                obj.vehicle_info.b_is_track_plate = r.info.vehicle.b_is_track_plate;
+                obj.vehicle_info.len_plate_id = r.info.vehicle.len_plate_id;
+                for (int k = 0; k < max_plate_len; k++)
+                {
+                    obj.vehicle_info.plate_id[k] = r.info.vehicle.plate_id[k];
+                }
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    class writer
+    {
+    public:
+        enum
+        {
+            // 缓存这么多帧的索引项后 flush 一次
+            index_batch = 256,
+        };
+
+        writer() {}
+        ~writer() { close(); }
+
+        writer(const writer &) = delete;
+        writer &operator=(const writer &) = delete;
+
+        /**
+         * @brief: 打开日志文件
+         * @param[in] path: 日志路径，索引写到 path.idx
+         * @param[in] append: true 时在已有日志后追加(版本和记录大小必须一致)，否则截断；
+         *                    追加前丢掉末尾不完整的帧，截掉与记录不一致的索引项并按记录补齐索引
+         * @return 0 成功，非零表示失败。
+         */
+        int open(const std::string &path, bool append = false)
+        {
+            close();
+            file_header_t header;
+            bool exists = false;
+            if (append)
+            {
+                FILE *fp = fopen(path.c_str(), "rb");
+                if (fp != nullptr)
+                {
+                    exists = fread(&header, sizeof(header), 1, fp) == 1;
+                    fclose(fp);
+                    if (exists && (memcmp(header.magic, magic, sizeof(magic)) != 0 || header.version != version ||
+                                   header.record_size != sizeof(record_t) || header.header_size != sizeof(file_header_t)))
+                    {
+                        return ax_error_code_fail;
+                    }
+                }
+            }
+
+            std::vector<index_entry_t> missing;
+            if (exists && recover(path, missing) != 0)
+            {
+                return ax_error_code_fail;
+            }
+
+            fp_ = fopen(path.c_str(), exists ? "r+b" : "wb");
+            idx_fp_ = fopen(index_path(path).c_str(), exists ? "ab" : "wb");
+            if (fp_ == nullptr || idx_fp_ == nullptr)
+            {
+                close();
+                return ax_error_code_fail;
+            }
+            setvbuf(fp_, nullptr, _IOFBF, 1 << 20);
+            if (exists)
+            {
+                fseek(fp_, 0, SEEK_END);
+                if (!missing.empty() && fwrite(missing.data(), sizeof(index_entry_t), missing.size(), idx_fp_) != missing.size())
+                {
+                    close();
+                    return ax_error_code_fail;
+                }
+                fflush(idx_fp_);
+            }
+            else
+            {
+                memset(&header, 0, sizeof(header));
+                memcpy(header.magic, magic, sizeof(magic));
+                header.version = version;
+                header.header_size = sizeof(file_header_t);
+                header.record_size = sizeof(record_t);
+                header.index_entry_size = sizeof(index_entry_t);
+                header.created_us = wall_us();
+                fwrite(&header, sizeof(header), 1, fp_);
+                records_ = 0;
+            }
+            return ax_error_code_success;
+        }
+
+        bool is_open() const { return fp_ != nullptr; }
+        unsigned long long records() const { return records_; }
+
+        /**
+         * @brief: 写入一帧结果
+         * @param[in] frame_id: 帧号，同一路视频内递增
+         * @param[in] timestamp_us: 时间戳，小于 0 时使用当前时间
+         * @param[in] stream_id: 视频路号
+         */
+        int write(unsigned long long frame_id, long long timestamp_us, int stream_id, const ax_result_t &result)
+        {
+            if (fp_ == nullptr)
+            {
+                return ax_error_code_fail;
+            }
+            if (timestamp_us < 0)
+            {
+                timestamp_us = wall_us();
+            }
+            index_entry_t entry;
+            entry.frame_id = frame_id;
+            entry.timestamp_us = timestamp_us;
+            entry.first_record = records_;
+            entry.n_records = result.n_objects > 0 ? result.n_objects : 1;
+            entry.stream_id = stream_id;
+
+            record_t r;
+            for (unsigned int i = 0; i < entry.n_records; i++)
+            {
+                memset(&r, 0, sizeof(r));
+                if (result.n_objects > 0)
+                {
+                    to_record(result, i, r);
+                }
+                else
+                {
+                    r.model_type = result.model_type;
+                }
+                r.frame_id = frame_id;
+                r.timestamp_us = timestamp_us;
+                r.stream_id = stream_id;
+                fwrite(&r, sizeof(r), 1, fp_);
+            }
+            records_ += entry.n_records;
+            pending_.push_back(entry);
+            if (pending_.size() >= index_batch)
+            {
+                flush();
+            }
+            return ax_error_code_success;
+        }
+
+        void flush()
+        {
+            // 记录写入文件之后才写对应的索引项，索引不会指向不存在的记录
+            if (fp_ != nullptr)
+            {
+                fflush(fp_);
+                if (!pending_.empty())
+                {
+                    fwrite(pending_.data(), sizeof(index_entry_t), pending_.size(), idx_fp_);
+                    pending_.clear();
+                }
+                fflush(idx_fp_);
+            }
+        }
+
+        void close()
+        {
+            flush();
+            if (fp_ != nullptr)
+            {
+                fclose(fp_);
+                fp_ = nullptr;
+            }
+            if (idx_fp_ != nullptr)
+            {
+                fclose(idx_fp_);
+                idx_fp_ = nullptr;
+            }
+        }
+
+        static long long wall_us()
+        {
+            struct timespec ts;
+            clock_gettime(CLOCK_REALTIME, &ts);
+            return ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+        }
+
+    private:
+        /**
+         * @brief: 追加前修正已有日志：数据文件截到最后一个完整帧，索引截到与记录一致的前缀
+         * @param[out] missing: 索引中缺少的帧，由调用方追加到索引末尾
+         */
+        int recover(const std::string &path, std::vector<index_entry_t> &missing)
+        {
+            size_t size = 0;
+            const char *data = map_file(path, &size);
+            if (data == nullptr)
+            {
+                return ax_error_code_fail;
+            }
+            const record_t *records = (const record_t *)(data + sizeof(file_header_t));
+            size_t n_records = complete_records(records, (size - sizeof(file_header_t)) / sizeof(record_t));
+
+            size_t idx_size = 0;
+            const char *idx = map_file(index_path(path), &idx_size);
+            size_t keep = idx ? valid_index_prefix((const index_entry_t *)idx, idx_size / sizeof(index_entry_t), n_records) : 0;
+            size_t covered = keep ? ((const index_entry_t *)idx)[keep - 1].first_record + ((const index_entry_t *)idx)[keep - 1].n_records : 0;
+            rebuild_index(records, covered, n_records, missing);
+            if (idx != nullptr)
+            {
+                munmap((void *)idx, idx_size);
+            }
+            munmap((void *)data, size);
+
+            if (truncate(path.c_str(), sizeof(file_header_t) + n_records * sizeof(record_t)) != 0 ||
+                (idx != nullptr && truncate(index_path(path).c_str(), keep * sizeof(index_entry_t)) != 0))
+            {
+                return ax_error_code_fail;
+            }
+            records_ = n_records;
+            return ax_error_code_success;
+        }
+
+        FILE *fp_ = nullptr;
+        FILE *idx_fp_ = nullptr;
+        unsigned long long records_ = 0;
+        std::vector<index_entry_t> pending_; // 记录尚未 fflush 的索引项
+    };
+
+    class reader
+    {
+    public:
+        reader() {}
+        ~reader() { close(); }
+
+        reader(const reader &) = delete;
+        reader &operator=(const reader &) = delete;
+
+        /**
+         * @brief: mmap 打开日志和索引
+         * @return 0 成功，非零表示文件不存在或格式不兼容
+         */
+        int open(const std::string &path)
+        {
+            close();
+            size_t size = 0;
+            data_ = map_file(path, &size);
+            if (data_ == nullptr)
+            {
+                return ax_error_code_fail;
+            }
+            size_ = size;
+            const file_header_t *header = (const file_header_t *)data_;
+            if (size < sizeof(file_header_t) || memcmp(header->magic, magic, sizeof(magic)) != 0 ||
+                header->version != version || header->record_size != sizeof(record_t))
+            {
+                close();
+                return ax_error_code_fail;
+            }
+            records_ = (const record_t *)(data_ + header->header_size);
+            n_records_ = (size - header->header_size) / sizeof(record_t);
+
+            size_t idx_size = 0;
+            idx_data_ = map_file(index_path(path), &idx_size);
+            idx_size_ = idx_size;
+            frames_ = (const index_entry_t *)idx_data_;
+            // 丢掉与记录不一致的索引项，然后补齐索引之后的帧
+            n_frames_ = idx_data_ ? valid_index_prefix(frames_, idx_size / sizeof(index_entry_t), n_records_) : 0;
+            size_t covered = n_frames_ ? frames_[n_frames_ - 1].first_record + frames_[n_frames_ - 1].n_records : 0;
+            if (covered < n_records_)
+            {
+                rebuilt_.assign(frames_, frames_ + n_frames_);
+                rebuild_index(records_, covered, n_records_, rebuilt_);
+                frames_ = rebuilt_.data();
+                n_frames_ = rebuilt_.size();
+            }
+            return ax_error_code_success;
+        }
+
+        void close()
+        {
+            if (data_ != nullptr)
+            {
+                munmap((void *)data_, size_);
+                data_ = nullptr;
+            }
+            if (idx_data_ != nullptr)
+            {
+                munmap((void *)idx_data_, idx_size_);
+                idx_data_ = nullptr;
+            }
+            rebuilt_.clear();
+            records_ = nullptr;
+            frames_ = nullptr;
+            n_records_ = n_frames_ = 0;
+        }
+
+        const file_header_t &header() const { return *(const file_header_t *)data_; }
+
+        size_t n_records() const { return n_records_; }
+        const record_t &record(size_t i) const { return records_[i]; }
+        const record_t *records() const { return records_; }
+
+        size_t n_frames() const { return n_frames_; }
+        const index_entry_t &frame(size_t i) const { return frames_[i]; }
+
+        // 第 i 帧的记录，没有目标的帧返回的记录 n_objects = 0
+        const record_t *frame_records(size_t i, size_t *n) const
+        {
+            *n = frames_[i].n_records;
+            return records_ + frames_[i].first_record;
+        }
+
+        void frame_result(size_t i, ax_result_t *result) const
+        {
+            size_t n;
+            const record_t *r = frame_records(i, &n);
+            to_result(r, n, result);
+        }
+
+        /**
+         * @brief: 时间戳不小于 timestamp_us 的第一帧，要求写入时时间戳不递减
+         * @return 帧下标，没有时返回 n_frames()
+         */
+        size_t lower_bound(long long timestamp_us) const
+        {
+            size_t lo = 0, hi = n_frames_;
+            while (lo < hi)
+            {
+                size_t mid = (lo + hi) / 2;
+                if (frames_[mid].timestamp_us < timestamp_us)
+                {
+                    lo = mid + 1;
+                }
+                else
+                {
+                    hi = mid;
+                }
+            }
+            return lo;
+        }
+
+    private:
+        const char *data_ = nullptr;
+        size_t size_ = 0;
+        const char *idx_data_ = nullptr;
+        size_t idx_size_ = 0;
+        const record_t *records_ = nullptr;
+        size_t n_records_ = 0;
+        const index_entry_t *frames_ = nullptr;
+        size_t n_frames_ = 0;
+        std::vector<index_entry_t> rebuilt_;
+    };
+}
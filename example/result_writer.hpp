@@ -0,0 +1,166 @@
+#pragma once
+#include <sys/types.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "ax_algorithm_sdk.h"
+
+/**
+ * 流式输出 COCO 检测结果：运行时每个检测框追加一行 JSON(JSON Lines)，经缓冲后顺序写文件，
+ * 不在内存中保存历史结果；结束时 finalize 把 JSONL 逐行转成 COCO 结果数组。
+ * 程序中途退出时 JSONL 中已刷盘的行仍然有效。
+ */
+namespace result_writer
+{
+    class jsonl_writer
+    {
+    public:
+        jsonl_writer() {}
+        ~jsonl_writer() { close(); }
+
+        jsonl_writer(const jsonl_writer &) = delete;
+        jsonl_writer &operator=(const jsonl_writer &) = delete;
+
+        /**
+         * @brief: 创建(截断)输出文件
+         * @param[in] path: JSONL 文件路径
+         * @param[in] buffer_size: 缓冲区满时写文件
+         * @return 0 成功，非零表示失败。
+         */
+        int open(const std::string &path, size_t buffer_size = 1 << 20)
+        {
+            close();
+            fp_ = fopen(path.c_str(), "wb");
+            if (fp_ == nullptr)
+            {
+                return ax_error_code_fail;
+            }
+            path_ = path;
+            buffer_size_ = buffer_size;
+            buffer_.reserve(buffer_size + 256);
+            records_ = 0;
+            return ax_error_code_success;
+        }
+
+        bool is_open() const { return fp_ != nullptr; }
+        const std::string &path() const { return path_; }
+        unsigned long long records() const { return records_; }
+
+        /**
+         * @brief: 追加一条 COCO 结果 {"image_id", "category_id", "bbox", "score"}。
+         *         浮点数按 %.9g 输出，可以无损还原 float
+         */
+        void write(long long image_id, int category_id, const ax_bbox_t &bbox, float score)
+        {
+            char line[256];
+            int n = snprintf(line, sizeof(line), "{\"image_id\":%lld,\"category_id\":%d,\"bbox\":[%.9g,%.9g,%.9g,%.9g],\"score\":%.9g}\n",
+                             image_id, category_id, bbox.x, bbox.y, bbox.w, bbox.h, score);
+            append(line, n);
+            records_++;
+        }
+
+        // 写入一帧所有目标的检测结果，类别取 label
+        void write(long long image_id, const ax_result_t &result)
+        {
+            for (int i = 0; i < result.n_objects; i++)
+            {
+                write(image_id, result.objects[i].label, result.objects[i].bbox, result.objects[i].score);
+            }
+        }
+
+        // 追加一行任意 JSON，调用方保证是单行合法 JSON
+        void write_line(const std::string &json)
+        {
+            append(json.c_str(), json.size());
+            append("\n", 1);
+            records_++;
+        }
+
+        void flush()
+        {
+            if (fp_ != nullptr && !buffer_.empty())
+            {
+                fwrite(buffer_.data(), 1, buffer_.size(), fp_);
+                buffer_.clear();
+                fflush(fp_);
+            }
+        }
+
+        void close()
+        {
+            if (fp_ != nullptr)
+            {
+                flush();
+                fclose(fp_);
+                fp_ = nullptr;
+            }
+        }
+
+    private:
+        void append(const char *data, size_t n)
+        {
+            if (fp_ == nullptr)
+            {
+                return;
+            }
+            buffer_.append(data, n);
+            if (buffer_.size() >= buffer_size_)
+            {
+                flush();
+            }
+        }
+
+        FILE *fp_ = nullptr;
+        std::string path_;
+        std::string buffer_;
+        size_t buffer_size_ = 0;
+        unsigned long long records_ = 0;
+    };
+
+    /**
+     * @brief: 把 JSONL 转成 COCO 结果数组(JSON 列表)，逐行流式处理，内存占用与文件大小无关
+     * @param[in] jsonl_path: jsonl_writer 写出的文件
+     * @param[in] json_path: 输出的 COCO 结果文件
+     * @return 0 成功，非零表示失败。
+     */
+    static int finalize(const std::string &jsonl_path, const std::string &json_path)
+    {
+        FILE *in = fopen(jsonl_path.c_str(), "rb");
+        if (in == nullptr)
+        {
+            return ax_error_code_fail;
+        }
+        FILE *out = fopen(json_path.c_str(), "wb");
+        if (out == nullptr)
+        {
+            fclose(in);
+            return ax_error_code_fail;
+        }
+        char *line = nullptr;
+        size_t cap = 0;
+        ssize_t n;
+        bool first = true;
+        fputs("[\n", out);
+        while ((n = getline(&line, &cap, in)) > 0)
+        {
+            while (n > 0 && (line[n - 1] == '\n' || line[n - 1] == '\r'))
+            {
+                n--;
+            }
+            if (n == 0)
+            {
+                continue;
+            }
+            fputs(first ? "    " : ",\n    ", out);
+            fwrite(line, 1, n, out);
+            first = false;
+        }
+        fputs(first ? "]\n" : "\n]\n", out);
+        free(line);
+        fclose(in);
+        return fclose(out) == 0 ? ax_error_code_success : ax_error_code_fail;
+    }
+}
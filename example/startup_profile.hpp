@@ -0,0 +1,305 @@
+#pragma once
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "ax_algorithm_sdk.h"
+
+/**
+ * 启动耗时分解与加速：
+ * - profiler 记录各阶段的起止时间(相对进程启动)，并行阶段按实际重叠显示，最后打印到首次检测的总耗时
+ * - prefetch 把模型文件一次性读入页缓存，同一批初始化的多个句柄只读一次磁盘；初始化完成后 release_prefetch 解除映射，
+ *   模型文件不再计入进程 RSS。之后再初始化句柄时没有映射保护，依赖页缓存中剩下的文件页，内存紧张被回收时会重新读盘
+ * - init_all 在多个线程中同时调用 ax_algorithm_init
+ * License 校验和引擎加载都在 ax_algorithm_init 内部，无法从外部拆开，合并为一个阶段。
+ */
+namespace startup_profile
+{
+    typedef struct _phase_t
+    {
+        std::string name;
+        double start_ms; // 相对进程启动
+        double end_ms;
+    } phase_t;
+
+    class profiler
+    {
+    public:
+        profiler()
+        {
+            origin_ = std::chrono::steady_clock::now();
+            since_start_ms_ = process_age_ms();
+            if (since_start_ms_ >= 0)
+            {
+                phases_.push_back({"process start -> main", 0, since_start_ms_});
+            }
+            else
+            {
+                since_start_ms_ = 0;
+            }
+        }
+
+        double now_ms() const
+        {
+            return since_start_ms_ + std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - origin_).count();
+        }
+
+        // 返回阶段编号，传给 end
+        int begin(const std::string &name)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            phases_.push_back({name, now_ms(), -1});
+            return phases_.size() - 1;
+        }
+
+        void end(int id)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            phases_[id].end_ms = now_ms();
+        }
+
+        // 时间点，例如首次检测完成
+        void mark(const std::string &name)
+        {
+            double t = now_ms();
+            std::lock_guard<std::mutex> lock(mutex_);
+            phases_.push_back({name, t, t});
+        }
+
+        std::vector<phase_t> phases() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return phases_;
+        }
+
+        void print() const
+        {
+            auto phases = this->phases();
+            printf("startup breakdown (ms from process start):\n");
+            printf("  %-36s %10s %10s %10s\n", "phase", "start", "end", "duration");
+            double last = 0;
+            for (auto &p : phases)
+            {
+                double end = p.end_ms < 0 ? now_ms() : p.end_ms;
+                printf("  %-36s %10.1f %10.1f %10.1f\n", p.name.c_str(), p.start_ms, end, end - p.start_ms);
+                last = std::max(last, end);
+            }
+            printf("  %-36s %32.1f\n", "total", last);
+        }
+
+    private:
+        // /proc/self/stat 的 starttime 与 /proc/uptime 之差，精度为一个 clock tick
+        static double process_age_ms()
+        {
+            std::ifstream stat_file("/proc/self/stat");
+            std::ifstream uptime_file("/proc/uptime");
+            std::string stat;
+            double uptime = 0;
+            if (!std::getline(stat_file, stat) || !(uptime_file >> uptime))
+            {
+                return -1;
+            }
+            // comm 可能包含空格，从最后一个 ')' 之后数字段，starttime 是第 22 个字段
+            size_t pos = stat.rfind(')');
+            if (pos == std::string::npos)
+            {
+                return -1;
+            }
+            const char *p = stat.c_str() + pos + 2;
+            for (int field = 3; field < 22 && p; field++)
+            {
+                p = strchr(p, ' ');
+                p = p ? p + 1 : nullptr;
+            }
+            if (p == nullptr)
+            {
+                return -1;
+            }
+            double start_s = strtoull(p, nullptr, 10) / (double)sysconf(_SC_CLK_TCK);
+            return (uptime - start_s) * 1000;
+        }
+
+        std::chrono::steady_clock::time_point origin_;
+        double since_start_ms_ = 0;
+        mutable std::mutex mutex_;
+        std::vector<phase_t> phases_;
+    };
+
+    class scoped_phase
+    {
+    public:
+        scoped_phase(profiler *prof, const std::string &name) : prof_(prof), id_(prof ? prof->begin(name) : -1) {}
+        ~scoped_phase()
+        {
+            if (prof_)
+            {
+                prof_->end(id_);
+            }
+        }
+
+    private:
+        profiler *prof_;
+        int id_;
+    };
+
+    namespace detail
+    {
+        struct mapping_t
+        {
+            void *addr;
+            size_t size;
+        };
+        static std::mutex g_prefetch_mutex;
+        static std::unordered_map<std::string, mapping_t> g_prefetched;
+    }
+
+    /**
+     * @brief: 把文件读入页缓存并保持映射到 release_prefetch，之后 SDK 按路径读取时不再访问磁盘；同一路径只读一次
+     * @return 文件字节数，失败返回 -1
+     */
+    static long long prefetch(const std::string &path)
+    {
+        std::lock_guard<std::mutex> lock(detail::g_prefetch_mutex);
+        auto &mapped = detail::g_prefetched;
+        auto it = mapped.find(path);
+        if (it != mapped.end())
+        {
+            return it->second.size;
+        }
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return -1;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+        {
+            close(fd);
+            return -1;
+        }
+        void *addr = nullptr;
+        if (st.st_size > 0)
+        {
+            // MAP_POPULATE 同步读入所有页，阶段耗时即磁盘读取时间
+            addr = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED | MAP_POPULATE, fd, 0);
+            if (addr == MAP_FAILED)
+            {
+                close(fd);
+                return -1;
+            }
+        }
+        close(fd);
+        mapped[path] = {addr, (size_t)st.st_size};
+        return st.st_size;
+    }
+
+    /**
+     * @brief: 解除 prefetch 的映射，在使用该文件的 ax_algorithm_init 全部完成后调用；文件页仍在页缓存中，之后的读取不访问磁盘
+     */
+    static void release_prefetch(const std::string &path)
+    {
+        std::lock_guard<std::mutex> lock(detail::g_prefetch_mutex);
+        auto it = detail::g_prefetched.find(path);
+        if (it == detail::g_prefetched.end())
+        {
+            return;
+        }
+        if (it->second.addr != nullptr)
+        {
+            munmap(it->second.addr, it->second.size);
+        }
+        detail::g_prefetched.erase(it);
+    }
+
+    static const char *model_type_name(ax_model_type_e type)
+    {
+        switch (type)
+        {
+        case ax_model_type_person_detection:
+            return "person_detection";
+        case ax_model_type_person_attr:
+            return "person_attr";
+        case ax_model_type_lpr:
+            return "lpr";
+        case ax_model_type_face_detection:
+            return "face_detection";
+        case ax_model_type_face_recognition:
+            return "face_recognition";
+        case ax_model_type_fire_smoke:
+            return "fire_smoke";
+        default:
+            return "unknown";
+        }
+    }
+
+    /**
+     * @brief: 初始化多个句柄
+     * @param[in] infos: 各句柄的初始化信息
+     * @param[out] handles: 与 infos 一一对应
+     * @param[in] prof: 记录每个句柄的初始化阶段，可为空
+     * @param[in] parallel: true 时每个句柄一个线程同时初始化
+     * @return 0 全部成功；否则返回第一个失败的错误码，已成功的句柄会被释放
+     */
+    static int init_all(std::vector<ax_algorithm_init_t> &infos, std::vector<ax_algorithm_handle_t> &handles, profiler *prof, bool parallel = true)
+    {
+        handles.assign(infos.size(), nullptr);
+        std::vector<int> rets(infos.size(), ax_error_code_success);
+        auto init_one = [&](size_t i)
+        {
+            scoped_phase phase(prof, std::string("ax_algorithm_init ") + model_type_name(infos[i].model_type));
+            rets[i] = ax_algorithm_init(&infos[i], &handles[i]);
+        };
+        if (parallel)
+        {
+            std::vector<std::thread> threads;
+            for (size_t i = 1; i < infos.size(); i++)
+            {
+                threads.emplace_back(init_one, i);
+            }
+            if (!infos.empty())
+            {
+                init_one(0);
+            }
+            for (auto &th : threads)
+            {
+                th.join();
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < infos.size(); i++)
+            {
+                init_one(i);
+            }
+        }
+
+        for (size_t i = 0; i < infos.size(); i++)
+        {
+            if (rets[i] != ax_error_code_success)
+            {
+                for (size_t j = 0; j < infos.size(); j++)
+                {
+                    if (rets[j] == ax_error_code_success && handles[j] != nullptr)
+                    {
+                        ax_algorithm_deinit(handles[j]);
+                    }
+                    handles[j] = nullptr;
+                }
+                return rets[i];
+            }
+        }
+        return ax_error_code_success;
+    }
+}
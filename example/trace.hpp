@@ -0,0 +1,255 @@
+#pragma once
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ax_algorithm_sdk.h"
+
+/**
+ * 可选的流水线跟踪，输出 Chrome Trace Event JSON，可直接用 chrome://tracing 或 Perfetto 打开。
+ * 每个线程一个无锁单生产者环形缓冲区，后台线程定期取出并写文件，记录线程不会阻塞；
+ * 缓冲区满时丢弃事件并计数。未调用 trace::start 时所有记录接口只有一次原子读的开销。
+ */
+namespace trace
+{
+    typedef struct _event_t
+    {
+        const char *name; // 必须是静态字符串
+        double ts_us;
+        double dur_us;
+        int stream_id;
+        long long frame_id;
+    } event_t;
+
+    static inline double now_us()
+    {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    namespace detail
+    {
+        enum
+        {
+            ring_size = 1 << 14,
+        };
+
+        struct ring_t
+        {
+            ring_t() : tid((int)syscall(SYS_gettid)), head(0), tail(0), dropped(0) {}
+
+            bool push(const event_t &e)
+            {
+                unsigned int h = head.load(std::memory_order_relaxed);
+                if (h - tail.load(std::memory_order_acquire) >= ring_size)
+                {
+                    dropped.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                events[h & (ring_size - 1)] = e;
+                head.store(h + 1, std::memory_order_release);
+                return true;
+            }
+
+            template <typename F>
+            void drain(F fn)
+            {
+                unsigned int t = tail.load(std::memory_order_relaxed);
+                unsigned int h = head.load(std::memory_order_acquire);
+                for (; t != h; t++)
+                {
+                    fn(events[t & (ring_size - 1)]);
+                }
+                tail.store(t, std::memory_order_release);
+            }
+
+            int tid;
+            std::atomic<unsigned int> head;
+            std::atomic<unsigned int> tail;
+            std::atomic<unsigned long long> dropped;
+            event_t events[ring_size];
+        };
+
+        struct tracer_t
+        {
+            std::atomic<bool> enabled{false};
+            std::mutex mutex; // 保护文件，后台线程写文件期间持有
+            // 线程第一次记录时在这里注册缓冲区，与写文件用不同的锁，注册不会等待磁盘 I/O
+            std::mutex rings_mutex;
+            std::vector<std::shared_ptr<ring_t>> rings;
+            FILE *fp = nullptr;
+            bool first = true;
+            std::thread flusher;
+            std::mutex wake_mutex;
+            std::condition_variable wake;
+            bool stop = false;
+
+            std::vector<std::shared_ptr<ring_t>> snapshot_rings()
+            {
+                std::lock_guard<std::mutex> lock(rings_mutex);
+                return rings;
+            }
+
+            // 调用方已持有 mutex
+            void flush_locked()
+            {
+                for (auto &ring : snapshot_rings())
+                {
+                    ring->drain([&](const event_t &e)
+                                {
+                        fprintf(fp, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"stream\":%d,\"frame\":%lld}}",
+                                first ? "" : ",\n", e.name, (int)getpid(), ring->tid, e.ts_us, e.dur_us, e.stream_id, e.frame_id);
+                        first = false; });
+                }
+                fflush(fp);
+            }
+        };
+
+        static tracer_t &tracer()
+        {
+            static tracer_t t;
+            return t;
+        }
+
+        static ring_t *local_ring()
+        {
+            thread_local std::shared_ptr<ring_t> ring;
+            if (!ring)
+            {
+                ring = std::make_shared<ring_t>();
+                tracer_t &t = tracer();
+                std::lock_guard<std::mutex> lock(t.rings_mutex);
+                t.rings.push_back(ring);
+            }
+            return ring.get();
+        }
+    }
+
+    static inline bool enabled()
+    {
+        return detail::tracer().enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief: 开始记录，事件写入 path
+     * @param[in] path: 输出文件
+     * @param[in] flush_ms: 后台线程写文件的周期
+     * @return 0 成功，非零表示失败。
+     */
+    static int start(const std::string &path, int flush_ms = 200)
+    {
+        detail::tracer_t &t = detail::tracer();
+        std::lock_guard<std::mutex> lock(t.mutex);
+        if (t.fp != nullptr)
+        {
+            return ax_error_code_fail;
+        }
+        t.fp = fopen(path.c_str(), "w");
+        if (t.fp == nullptr)
+        {
+            return ax_error_code_fail;
+        }
+        fprintf(t.fp, "{\"traceEvents\":[\n");
+        t.first = true;
+        t.stop = false;
+        t.flusher = std::thread([&t, flush_ms]()
+                                {
+            std::unique_lock<std::mutex> wake_lock(t.wake_mutex);
+            while (!t.stop)
+            {
+                t.wake.wait_for(wake_lock, std::chrono::milliseconds(flush_ms));
+                std::lock_guard<std::mutex> lock(t.mutex);
+                t.flush_locked();
+            } });
+        t.enabled.store(true);
+        return ax_error_code_success;
+    }
+
+    /**
+     * @brief: 停止记录，写出剩余事件并关闭文件
+     * @return 因缓冲区满丢弃的事件数
+     */
+    static unsigned long long stop()
+    {
+        detail::tracer_t &t = detail::tracer();
+        t.enabled.store(false);
+        {
+            std::lock_guard<std::mutex> wake_lock(t.wake_mutex);
+            t.stop = true;
+        }
+        t.wake.notify_all();
+        if (t.flusher.joinable())
+        {
+            t.flusher.join();
+        }
+
+        std::lock_guard<std::mutex> lock(t.mutex);
+        unsigned long long dropped = 0;
+        if (t.fp != nullptr)
+        {
+            t.flush_locked();
+            fprintf(t.fp, "\n]}\n");
+            fclose(t.fp);
+            t.fp = nullptr;
+        }
+        for (auto &ring : t.snapshot_rings())
+        {
+            dropped += ring->dropped.exchange(0);
+        }
+        return dropped;
+    }
+
+    static inline void record(const char *name, double ts_us, double dur_us, int stream_id, long long frame_id)
+    {
+        if (!enabled())
+        {
+            return;
+        }
+        event_t e = {name, ts_us, dur_us, stream_id, frame_id};
+        detail::local_ring()->push(e);
+    }
+
+    /**
+     * 作用域计时，析构时记录一个事件
+     */
+    class scope
+    {
+    public:
+        scope(const char *name, int stream_id = -1, long long frame_id = -1)
+            : name_(name), stream_id_(stream_id), frame_id_(frame_id), ts_(enabled() ? now_us() : 0) {}
+
+        ~scope()
+        {
+            if (ts_ > 0)
+            {
+                record(name_, ts_, now_us() - ts_, stream_id_, frame_id_);
+            }
+        }
+
+    private:
+        const char *name_;
+        int stream_id_;
+        long long frame_id_;
+        double ts_;
+    };
+
+    static int create_image(int width, int height, int stride, ax_color_space_e color, ax_image_t *image, int stream_id = -1, long long frame_id = -1)
+    {
+        scope s("ax_create_image", stream_id, frame_id);
+        return ax_create_image(width, height, stride, color, image);
+    }
+
+    static void release_image(ax_image_t *image, int stream_id = -1, long long frame_id = -1)
+    {
+        scope s("ax_release_image", stream_id, frame_id);
+        ax_release_image(image);
+    }
+}
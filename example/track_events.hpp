@@ -0,0 +1,231 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <unordered_map>
+
+#include "ax_algorithm_sdk.h"
+
+/**
+ * 把逐帧的 ax_result_t 转换成轨迹生命周期事件：
+ * 新建、显著变化、丢失、结束。下游只需要处理事件，而不必逐帧比对完整结果。
+ */
+namespace track_events
+{
+    typedef enum _event_type_e
+    {
+        event_created = 0, // 新出现的 track_id
+        event_updated,     // 位置/分数/类别发生显著变化，或丢失后重新出现
+        event_lost,        // 本帧未出现
+        event_ended,       // 连续 lost_frames 帧未出现，轨迹结束
+    } event_type_e;
+
+    typedef struct _event_t
+    {
+        event_type_e type;
+        unsigned long int track_id;
+        long long timestamp;
+        /**
+         * index: 对应 result.objects 的下标，lost/ended 事件为 -1
+         * bbox/score/label: lost/ended 事件为最后一次出现时的值
+         */
+        int index;
+        ax_bbox_t bbox;
+        float score;
+        int label;
+    } event_t;
+
+    typedef struct _param_t
+    {
+        /**
+         * iou_threshold: 与上次上报的框 IoU 低于该值时上报 updated
+         * score_delta: 分数变化超过该值时上报 updated，<= 0 表示不关心分数
+         * lost_frames: 连续未出现多少帧后上报 ended
+         */
+        float iou_threshold;
+        float score_delta;
+        int lost_frames;
+    } param_t;
+
+    static param_t get_default_param()
+    {
+        param_t param;
+        param.iou_threshold = 0.7f;
+        param.score_delta = 0.2f;
+        param.lost_frames = 25;
+        return param;
+    }
+
+    static inline float iou(const ax_bbox_t &a, const ax_bbox_t &b)
+    {
+        float x0 = std::fmax(a.x, b.x);
+        float y0 = std::fmax(a.y, b.y);
+        float x1 = std::fmin(a.x + a.w, b.x + b.w);
+        float y1 = std::fmin(a.y + a.h, b.y + b.h);
+        if (x1 <= x0 || y1 <= y0)
+        {
+            return 0.f;
+        }
+        float inter = (x1 - x0) * (y1 - y0);
+        return inter / (a.w * a.h + b.w * b.h - inter);
+    }
+
+    class emitter
+    {
+    public:
+        emitter() : param_(get_default_param()), frame_(0) {}
+        explicit emitter(const param_t &param) : param_(param), frame_(0) {}
+
+        void set_param(const param_t &param)
+        {
+            param_ = param;
+        }
+
+        /**
+         * @brief: 输入一帧跟踪结果，追加本帧产生的事件
+         * @param[in] result: ax_algorithm_track 的结果，track_id 为 0 的目标被忽略
+         * @param[in] timestamp: 帧时间戳，单位由调用者决定
+         * @param[out] events: 本帧事件追加到末尾
+         * @return 本帧产生的事件数
+         */
+        int update(const ax_result_t *result, long long timestamp, std::vector<event_t> &events)
+        {
+            size_t n_before = events.size();
+            frame_++;
+
+            for (int i = 0; i < result->n_objects; i++)
+            {
+                auto &obj = result->objects[i];
+                if (obj.track_id == 0)
+                {
+                    continue;
+                }
+
+                auto it = tracks_.find(obj.track_id);
+                if (it == tracks_.end())
+                {
+                    track_t &t = tracks_[obj.track_id];
+                    t.bbox = obj.bbox;
+                    t.score = obj.score;
+                    t.label = obj.label;
+                    t.last_frame = frame_;
+                    t.lost = false;
+                    push(events, event_created, obj.track_id, timestamp, i, t);
+                    continue;
+                }
+
+                track_t &t = it->second;
+                bool significant = t.lost || obj.label != t.label ||
+                                   iou(obj.bbox, t.bbox) < param_.iou_threshold ||
+                                   (param_.score_delta > 0 && std::fabs(obj.score - t.score) > param_.score_delta);
+                t.last_frame = frame_;
+                t.lost = false;
+                if (significant)
+                {
+                    t.bbox = obj.bbox;
+                    t.score = obj.score;
+                    t.label = obj.label;
+                    push(events, event_updated, obj.track_id, timestamp, i, t);
+                }
+            }
+
+            size_t n_seen = events.size();
+            for (auto it = tracks_.begin(); it != tracks_.end();)
+            {
+                track_t &t = it->second;
+                long long missed = frame_ - t.last_frame;
+                if (missed == 0)
+                {
+                    ++it;
+                    continue;
+                }
+                if (!t.lost)
+                {
+                    t.lost = true;
+                    push(events, event_lost, it->first, timestamp, -1, t);
+                }
+                if (missed >= param_.lost_frames)
+                {
+                    push(events, event_ended, it->first, timestamp, -1, t);
+                    it = tracks_.erase(it);
+                    continue;
+                }
+                ++it;
+            }
+            sort_by_track_id(events, n_seen);
+
+            return (int)(events.size() - n_before);
+        }
+
+        /**
+         * @brief: 结束所有存活的轨迹，例如视频流关闭时
+         */
+        int flush(long long timestamp, std::vector<event_t> &events)
+        {
+            size_t n_before = events.size();
+            for (auto &kv : tracks_)
+            {
+                push(events, event_ended, kv.first, timestamp, -1, kv.second);
+            }
+            sort_by_track_id(events, n_before);
+            tracks_.clear();
+            return (int)(events.size() - n_before);
+        }
+
+        size_t active_tracks() const
+        {
+            return tracks_.size();
+        }
+
+    private:
+        struct track_t
+        {
+            ax_bbox_t bbox;
+            float score;
+            int label;
+            long long last_frame;
+            bool lost;
+        };
+
+        static void push(std::vector<event_t> &events, event_type_e type, unsigned long int track_id, long long timestamp, int index, const track_t &t)
+        {
+            event_t e;
+            e.type = type;
+            e.track_id = track_id;
+            e.timestamp = timestamp;
+            e.index = index;
+            e.bbox = t.bbox;
+            e.score = t.score;
+            e.label = t.label;
+            events.push_back(e);
+        }
+
+        // tracks_ 的遍历顺序不确定，从 begin 开始的事件按 track_id 排序，同一目标的 lost 保持在 ended 之前
+        static void sort_by_track_id(std::vector<event_t> &events, size_t begin)
+        {
+            std::stable_sort(events.begin() + begin, events.end(), [](const event_t &a, const event_t &b)
+                             { return a.track_id < b.track_id; });
+        }
+
+        param_t param_;
+        long long frame_;
+        std::unordered_map<unsigned long int, track_t> tracks_;
+    };
+
+    static const char *event_type_str(event_type_e type)
+    {
+        switch (type)
+        {
+        case event_created:
+            return "created";
+        case event_updated:
+            return "updated";
+        case event_lost:
+            return "lost";
+        case event_ended:
+            return "ended";
+        default:
+            return "unknown";
+        }
+    }
+}
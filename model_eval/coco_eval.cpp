@@ -0,0 +1,681 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <map>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "cmdline.hpp"
+#include "json_lite.hpp"
+
+/**
+ * COCO bbox 评估，与 pycocotools COCOeval(iouType="bbox") 的默认参数和算法逐步对应：
+ * loadRes -> evaluate(按图像、类别匹配) -> accumulate(按类别、面积、maxDets 汇总 PR) -> summarize。
+ * evaluate 按 (类别, 图像块) 并行，accumulate 按 (类别, 面积, maxDets) 并行，结果与线程数无关。
+ */
+
+static const int n_iou = 10;
+static const int n_rec = 101;
+static const int max_dets[] = {1, 10, 100};
+static const int n_max_dets = 3;
+static const double area_rng[][2] = {{0, 1e10}, {0, 32 * 32}, {32 * 32, 96 * 96}, {96 * 96, 1e10}};
+static const char *area_lbl[] = {"all", "small", "medium", "large"};
+static const int n_area = 4;
+
+// numpy 对 float64 求和使用的成对求和
+static double pairwise_sum(const double *a, size_t n)
+{
+    if (n < 8)
+    {
+        double res = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            res += a[i];
+        }
+        return res;
+    }
+    if (n <= 128)
+    {
+        double r[8];
+        for (int j = 0; j < 8; j++)
+        {
+            r[j] = a[j];
+        }
+        size_t i;
+        for (i = 8; i < n - (n % 8); i += 8)
+        {
+            for (int j = 0; j < 8; j++)
+            {
+                r[j] += a[i + j];
+            }
+        }
+        double res = ((r[0] + r[1]) + (r[2] + r[3])) + ((r[4] + r[5]) + (r[6] + r[7]));
+        for (; i < n; i++)
+        {
+            res += a[i];
+        }
+        return res;
+    }
+    size_t n2 = n / 2;
+    n2 -= n2 % 8;
+    return pairwise_sum(a, n2) + pairwise_sum(a + n2, n - n2);
+}
+
+struct ann_t
+{
+    long long id;
+    long long image_id;
+    long long category_id;
+    double bbox[4];
+    double area;
+    double score;
+    bool iscrowd;
+};
+
+struct dataset_t
+{
+    std::vector<long long> img_ids; // 升序
+    std::vector<long long> cat_ids; // 升序
+    std::map<long long, std::string> cat_names;
+    std::vector<ann_t> gts;
+    std::vector<ann_t> dts;
+};
+
+// 单个 (类别, 图像, 面积) 的匹配结果，对应 evaluateImg 的返回值
+struct eval_img_t
+{
+    bool valid = false;
+    std::vector<double> scores;        // 按分数降序，截断到 maxDets[-1]
+    std::vector<unsigned char> matched; // n_iou x D
+    std::vector<unsigned char> ignore;  // n_iou x D
+    int npig = 0;                       // 不忽略的真值数
+};
+
+struct params_t
+{
+    double iou_thrs[n_iou];
+    double rec_thrs[n_rec];
+
+    params_t()
+    {
+        // 与 np.linspace 的计算方式一致
+        double step = (0.95 - 0.5) / (n_iou - 1);
+        for (int i = 0; i < n_iou; i++)
+        {
+            iou_thrs[i] = i * step + 0.5;
+        }
+        iou_thrs[n_iou - 1] = 0.95;
+        step = 1.0 / (n_rec - 1);
+        for (int i = 0; i < n_rec; i++)
+        {
+            rec_thrs[i] = i * step;
+        }
+        rec_thrs[n_rec - 1] = 1.0;
+    }
+};
+
+static bool parse_ann(const json_lite::value &v, ann_t &a, bool result)
+{
+    const json_lite::value &bbox = v["bbox"];
+    if (bbox.size() != 4)
+    {
+        return false;
+    }
+    for (int i = 0; i < 4; i++)
+    {
+        a.bbox[i] = bbox.at(i).number();
+    }
+    a.id = (long long)v.get("id", 0);
+    a.image_id = (long long)v.get("image_id", 0);
+    a.category_id = (long long)v.get("category_id", 0);
+    a.score = v.get("score", 0);
+    // loadRes 中结果的面积是 w*h，iscrowd 为 0；真值使用文件中的 area
+    a.area = result ? a.bbox[2] * a.bbox[3] : v.get("area", a.bbox[2] * a.bbox[3]);
+    a.iscrowd = result ? false : v.get("iscrowd", 0) != 0;
+    return true;
+}
+
+static bool load_dataset(const std::string &gt_path, const std::string &dt_path, dataset_t &ds)
+{
+    json_lite::value gt, dt;
+    std::string error;
+    if (!json_lite::parse_file(gt_path, gt, &error) || !json_lite::parse_file(dt_path, dt, &error))
+    {
+        printf("%s\n", error.c_str());
+        return false;
+    }
+
+    for (auto &img : gt["images"].array())
+    {
+        ds.img_ids.push_back((long long)img.get("id", 0));
+    }
+    for (auto &cat : gt["categories"].array())
+    {
+        long long id = (long long)cat.get("id", 0);
+        ds.cat_ids.push_back(id);
+        ds.cat_names[id] = cat["name"].str();
+    }
+    std::sort(ds.img_ids.begin(), ds.img_ids.end());
+    ds.img_ids.erase(std::unique(ds.img_ids.begin(), ds.img_ids.end()), ds.img_ids.end());
+    std::sort(ds.cat_ids.begin(), ds.cat_ids.end());
+    ds.cat_ids.erase(std::unique(ds.cat_ids.begin(), ds.cat_ids.end()), ds.cat_ids.end());
+
+    for (auto &v : gt["annotations"].array())
+    {
+        ann_t a;
+        if (parse_ann(v, a, false))
+        {
+            ds.gts.push_back(a);
+        }
+    }
+
+    // 结果可以是列表，也可以是带 annotations 的 COCO 文件
+    const json_lite::value &res = dt.is_object() ? dt["annotations"] : dt;
+    if (!res.is_array())
+    {
+        printf("%s: results must be an array\n", dt_path.c_str());
+        return false;
+    }
+    for (auto &v : res.array())
+    {
+        ann_t a;
+        if (parse_ann(v, a, true))
+        {
+            a.id = ds.dts.size() + 1;
+            if (!std::binary_search(ds.img_ids.begin(), ds.img_ids.end(), a.image_id))
+            {
+                printf("Results do not correspond to current coco set\n");
+                return false;
+            }
+            ds.dts.push_back(a);
+        }
+    }
+    return true;
+}
+
+// maskUtils.iou 的 bbox 版本，crowd 真值的并集取检测框面积
+static double box_iou(const double *d, const double *g, bool crowd)
+{
+    double w = std::min(d[0] + d[2], g[0] + g[2]) - std::max(d[0], g[0]);
+    if (w <= 0)
+    {
+        return 0;
+    }
+    double h = std::min(d[1] + d[3], g[1] + g[3]) - std::max(d[1], g[1]);
+    if (h <= 0)
+    {
+        return 0;
+    }
+    double inter = w * h;
+    double uni = crowd ? d[2] * d[3] : d[2] * d[3] + g[2] * g[3] - inter;
+    return inter / uni;
+}
+
+class evaluator
+{
+public:
+    evaluator(const dataset_t &ds, int threads) : ds_(ds), threads_(threads) {}
+
+    void evaluate()
+    {
+        // 每个类别下有真值或检测的图像，按图像 id 升序，每张图内保持文件中的顺序
+        std::unordered_map<long long, int> cat_index;
+        for (size_t k = 0; k < ds_.cat_ids.size(); k++)
+        {
+            cat_index[ds_.cat_ids[k]] = k;
+        }
+        std::vector<std::map<long long, cell_t>> cells(ds_.cat_ids.size());
+        for (size_t i = 0; i < ds_.gts.size(); i++)
+        {
+            const ann_t &a = ds_.gts[i];
+            auto it = cat_index.find(a.category_id);
+            if (it != cat_index.end() && std::binary_search(ds_.img_ids.begin(), ds_.img_ids.end(), a.image_id))
+            {
+                cells[it->second][a.image_id].gts.push_back(i);
+            }
+        }
+        for (size_t i = 0; i < ds_.dts.size(); i++)
+        {
+            const ann_t &a = ds_.dts[i];
+            auto it = cat_index.find(a.category_id);
+            if (it != cat_index.end())
+            {
+                cells[it->second][a.image_id].dts.push_back(i);
+            }
+        }
+
+        cells_.resize(cells.size());
+        evals_.resize(cells.size());
+        std::vector<std::pair<int, int>> tasks; // (类别, 起始位置)
+        const int chunk = 256;
+        for (size_t k = 0; k < cells.size(); k++)
+        {
+            for (auto &kv : cells[k])
+            {
+                cells_[k].push_back(kv.second);
+            }
+            evals_[k].resize(cells_[k].size() * n_area);
+            for (size_t s = 0; s < cells_[k].size(); s += chunk)
+            {
+                tasks.push_back(std::make_pair((int)k, (int)s));
+            }
+        }
+        parallel_for(tasks.size(), [&](size_t t)
+                     {
+            int k = tasks[t].first;
+            size_t end = std::min(cells_[k].size(), (size_t)tasks[t].second + chunk);
+            for (size_t c = tasks[t].second; c < end; c++)
+            {
+                evaluate_cell(cells_[k][c], &evals_[k][c * n_area]);
+            } });
+    }
+
+    void accumulate()
+    {
+        size_t K = ds_.cat_ids.size();
+        precision_.assign((size_t)n_iou * n_rec * K * n_area * n_max_dets, -1);
+        recall_.assign((size_t)n_iou * K * n_area * n_max_dets, -1);
+        parallel_for(K * n_area * n_max_dets, [&](size_t t)
+                     { accumulate_one(t / (n_area * n_max_dets), t / n_max_dets % n_area, t % n_max_dets); });
+    }
+
+    /**
+     * @brief: 与 COCOeval._summarize 相同，cat < 0 时对所有类别取平均。
+     *         取值顺序和求和方式与 numpy 一致，保证打印的三位小数在进位边界上也相同
+     */
+    double summarize(bool ap, double iou_thr, int area, int max_det, int cat = -1) const
+    {
+        int m = std::find(max_dets, max_dets + n_max_dets, max_det) - max_dets;
+        int K = ds_.cat_ids.size();
+        std::vector<double> values;
+        for (int t = 0; t < n_iou; t++)
+        {
+            if (iou_thr >= 0 && params_.iou_thrs[t] != iou_thr)
+            {
+                continue;
+            }
+            for (int r = 0; r < (ap ? n_rec : 1); r++)
+            {
+                for (int k = 0; k < K; k++)
+                {
+                    if (cat >= 0 && k != cat)
+                    {
+                        continue;
+                    }
+                    double v = ap ? precision(t, r, k, area, m) : recall(t, k, area, m);
+                    if (v > -1)
+                    {
+                        values.push_back(v);
+                    }
+                }
+            }
+        }
+        return values.empty() ? -1 : pairwise_sum(values.data(), values.size()) / values.size();
+    }
+
+    double precision(int t, int r, int k, int a, int m) const
+    {
+        size_t K = ds_.cat_ids.size();
+        return precision_[(((size_t)t * n_rec + r) * K + k) * n_area * n_max_dets + a * n_max_dets + m];
+    }
+
+    double recall(int t, int k, int a, int m) const
+    {
+        size_t K = ds_.cat_ids.size();
+        return recall_[((size_t)t * K + k) * n_area * n_max_dets + a * n_max_dets + m];
+    }
+
+    const params_t &params() const { return params_; }
+
+private:
+    struct cell_t
+    {
+        std::vector<int> gts;
+        std::vector<int> dts;
+    };
+
+    template <typename F>
+    void parallel_for(size_t n, F fn)
+    {
+        std::atomic<size_t> next{0};
+        auto work = [&]()
+        {
+            for (size_t i = next++; i < n; i = next++)
+            {
+                fn(i);
+            }
+        };
+        std::vector<std::thread> pool;
+        for (int i = 1; i < threads_ && (size_t)i < n; i++)
+        {
+            pool.emplace_back(work);
+        }
+        work();
+        for (auto &th : pool)
+        {
+            th.join();
+        }
+    }
+
+    // computeIoU + 对每个面积范围的 evaluateImg
+    void evaluate_cell(const cell_t &cell, eval_img_t *out)
+    {
+        const int max_det = max_dets[n_max_dets - 1];
+        std::vector<int> dts = cell.dts;
+        std::stable_sort(dts.begin(), dts.end(), [&](int a, int b)
+                         { return ds_.dts[a].score > ds_.dts[b].score; });
+        if ((int)dts.size() > max_det)
+        {
+            dts.resize(max_det);
+        }
+        size_t D = dts.size();
+        size_t G = cell.gts.size();
+        std::vector<double> ious(D * G);
+        for (size_t d = 0; d < D; d++)
+        {
+            for (size_t g = 0; g < G; g++)
+            {
+                const ann_t &ga = ds_.gts[cell.gts[g]];
+                ious[d * G + g] = box_iou(ds_.dts[dts[d]].bbox, ga.bbox, ga.iscrowd);
+            }
+        }
+
+        for (int a = 0; a < n_area; a++)
+        {
+            eval_img_t &e = out[a];
+            e.valid = true;
+            // 忽略的真值排在后面
+            std::vector<int> gt_order;
+            std::vector<unsigned char> gt_ig(G);
+            for (size_t g = 0; g < G; g++)
+            {
+                const ann_t &ga = ds_.gts[cell.gts[g]];
+                gt_ig[g] = ga.iscrowd || ga.area < area_rng[a][0] || ga.area > area_rng[a][1];
+            }
+            for (int pass = 0; pass < 2; pass++)
+            {
+                for (size_t g = 0; g < G; g++)
+                {
+                    if (gt_ig[g] == pass)
+                    {
+                        gt_order.push_back(g);
+                    }
+                }
+            }
+            e.npig = 0;
+            for (size_t g = 0; g < G; g++)
+            {
+                e.npig += gt_ig[g] == 0;
+            }
+
+            e.scores.resize(D);
+            e.matched.assign(n_iou * D, 0);
+            e.ignore.assign(n_iou * D, 0);
+            for (size_t d = 0; d < D; d++)
+            {
+                e.scores[d] = ds_.dts[dts[d]].score;
+            }
+            std::vector<long long> gtm(n_iou * G, 0);
+            std::vector<long long> dtm(n_iou * D, 0);
+            if (D > 0 && G > 0)
+            {
+                for (int t = 0; t < n_iou; t++)
+                {
+                    for (size_t d = 0; d < D; d++)
+                    {
+                        double iou = std::min(params_.iou_thrs[t], 1 - 1e-10);
+                        int m = -1;
+                        for (size_t gi = 0; gi < G; gi++)
+                        {
+                            int g = gt_order[gi];
+                            bool crowd = ds_.gts[cell.gts[g]].iscrowd;
+                            if (gtm[t * G + gi] > 0 && !crowd)
+                            {
+                                continue;
+                            }
+                            if (m > -1 && gt_ig[gt_order[m]] == 0 && gt_ig[g] == 1)
+                            {
+                                break;
+                            }
+                            if (ious[d * G + g] < iou)
+                            {
+                                continue;
+                            }
+                            iou = ious[d * G + g];
+                            m = gi;
+                        }
+                        if (m == -1)
+                        {
+                            continue;
+                        }
+                        e.ignore[t * D + d] = gt_ig[gt_order[m]];
+                        dtm[t * D + d] = ds_.gts[cell.gts[gt_order[m]]].id;
+                        gtm[t * G + m] = ds_.dts[dts[d]].id;
+                    }
+                }
+            }
+            for (int t = 0; t < n_iou; t++)
+            {
+                for (size_t d = 0; d < D; d++)
+                {
+                    // 与 pycocotools 一样用匹配到的真值 id 判断是否匹配
+                    e.matched[t * D + d] = dtm[t * D + d] != 0;
+                    const ann_t &da = ds_.dts[dts[d]];
+                    bool out_of_range = da.area < area_rng[a][0] || da.area > area_rng[a][1];
+                    e.ignore[t * D + d] = e.ignore[t * D + d] || (!e.matched[t * D + d] && out_of_range);
+                }
+            }
+        }
+    }
+
+    void accumulate_one(int k, int a, int m)
+    {
+        const int max_det = max_dets[m];
+        std::vector<const eval_img_t *> evals;
+        int npig = 0;
+        for (size_t c = 0; c < cells_[k].size(); c++)
+        {
+            const eval_img_t &e = evals_[k][c * n_area + a];
+            if (e.valid)
+            {
+                evals.push_back(&e);
+                npig += e.npig;
+            }
+        }
+        if (evals.empty() || npig == 0)
+        {
+            return;
+        }
+
+        struct det_t
+        {
+            double score;
+            const eval_img_t *e;
+            int d;
+        };
+        std::vector<det_t> dets;
+        for (auto *e : evals)
+        {
+            int n = std::min((int)e->scores.size(), max_det);
+            for (int d = 0; d < n; d++)
+            {
+                dets.push_back({e->scores[d], e, d});
+            }
+        }
+        std::stable_sort(dets.begin(), dets.end(), [](const det_t &x, const det_t &y)
+                         { return x.score > y.score; });
+
+        size_t K = ds_.cat_ids.size();
+        size_t nd = dets.size();
+        std::vector<double> rc(nd), pr(nd);
+        for (int t = 0; t < n_iou; t++)
+        {
+            double tp = 0, fp = 0;
+            for (size_t i = 0; i < nd; i++)
+            {
+                size_t D = dets[i].e->scores.size();
+                bool matched = dets[i].e->matched[t * D + dets[i].d];
+                bool ignore = dets[i].e->ignore[t * D + dets[i].d];
+                tp += matched && !ignore;
+                fp += !matched && !ignore;
+                rc[i] = tp / npig;
+                pr[i] = tp / (fp + tp + std::numeric_limits<double>::epsilon());
+            }
+            recall_[((size_t)t * K + k) * n_area * n_max_dets + a * n_max_dets + m] = nd ? rc[nd - 1] : 0;
+
+            for (size_t i = nd > 0 ? nd - 1 : 0; i > 0; i--)
+            {
+                if (pr[i] > pr[i - 1])
+                {
+                    pr[i - 1] = pr[i];
+                }
+            }
+            for (int r = 0; r < n_rec; r++)
+            {
+                size_t pi = std::lower_bound(rc.begin(), rc.end(), params_.rec_thrs[r]) - rc.begin();
+                double q = pi < nd ? pr[pi] : 0;
+                precision_[(((size_t)t * n_rec + r) * K + k) * n_area * n_max_dets + a * n_max_dets + m] = q;
+            }
+        }
+    }
+
+    const dataset_t &ds_;
+    int threads_;
+    params_t params_;
+    std::vector<std::vector<cell_t>> cells_;
+    std::vector<std::vector<eval_img_t>> evals_; // [类别][图像 * n_area + 面积]
+    std::vector<double> precision_;              // [T][R][K][A][M]，-1 表示没有真值
+    std::vector<double> recall_;                 // [T][K][A][M]
+};
+
+static double print_line(const evaluator &ev, bool ap, double iou_thr, int area, int max_det)
+{
+    double v = ev.summarize(ap, iou_thr, area, max_det);
+    char iou_str[32];
+    if (iou_thr < 0)
+    {
+        snprintf(iou_str, sizeof(iou_str), "%0.2f:%0.2f", ev.params().iou_thrs[0], ev.params().iou_thrs[n_iou - 1]);
+    }
+    else
+    {
+        snprintf(iou_str, sizeof(iou_str), "%0.2f", iou_thr);
+    }
+    printf(" %-18s %s @[ IoU=%-9s | area=%6s | maxDets=%3d ] = %0.3f\n",
+           ap ? "Average Precision" : "Average Recall", ap ? "(AP)" : "(AR)", iou_str, area_lbl[area], max_det, v);
+    return v;
+}
+
+static void write_pr_json(const std::string &path, const dataset_t &ds, const evaluator &ev)
+{
+    FILE *fp = fopen(path.c_str(), "w");
+    if (fp == nullptr)
+    {
+        printf("open %s failed\n", path.c_str());
+        return;
+    }
+    // 每个类别：AP、AP50、AP75、AR100，以及 IoU=0.5/0.75 时在 101 个召回率点上的精度
+    fprintf(fp, "{\n    \"recall_thresholds\": [");
+    for (int r = 0; r < n_rec; r++)
+    {
+        fprintf(fp, "%s%.2f", r ? ", " : "", ev.params().rec_thrs[r]);
+    }
+    fprintf(fp, "],\n    \"categories\": [");
+    for (size_t k = 0; k < ds.cat_ids.size(); k++)
+    {
+        long long id = ds.cat_ids[k];
+        fprintf(fp, "%s\n        {\n            \"id\": %lld,\n            \"name\": \"%s\",\n", k ? "," : "", id, ds.cat_names.at(id).c_str());
+        fprintf(fp, "            \"ap\": %.6f,\n            \"ap50\": %.6f,\n            \"ap75\": %.6f,\n            \"ar100\": %.6f",
+                ev.summarize(true, -1, 0, 100, k), ev.summarize(true, 0.5, 0, 100, k), ev.summarize(true, 0.75, 0, 100, k), ev.summarize(false, -1, 0, 100, k));
+        for (int t : {0, 5})
+        {
+            fprintf(fp, ",\n            \"pr%d\": [", t == 0 ? 50 : 75);
+            for (int r = 0; r < n_rec; r++)
+            {
+                fprintf(fp, "%s%.6f", r ? ", " : "", ev.precision(t, r, k, 0, n_max_dets - 1));
+            }
+            fprintf(fp, "]");
+        }
+        fprintf(fp, "\n        }");
+    }
+    fprintf(fp, "\n    ]\n}\n");
+    fclose(fp);
+}
+
+static double elapsed_s(std::chrono::steady_clock::time_point t0)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+int main(int argc, char *argv[])
+{
+    cmdline::parser parser;
+    parser.add<std::string>("gt", 'g', "ground truth coco json", false, "output_coco.json");
+    parser.add<std::string>("dt", 'd', "detection results json", false, "model_out.json");
+    parser.add<int>("threads", 'j', "worker threads, 0 means all cores", false, 0);
+    parser.add("per_class", 'c', "print per category AP");
+    parser.add<std::string>("pr_json", 'p', "write per category AP and PR curves to this json", false, "");
+    parser.parse_check(argc, argv);
+
+    int threads = parser.get<int>("threads");
+    if (threads <= 0)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    dataset_t ds;
+    if (!load_dataset(parser.get<std::string>("gt"), parser.get<std::string>("dt"), ds))
+    {
+        return -1;
+    }
+    printf("loaded %zu images, %zu categories, %zu ground truths, %zu detections (t=%.2fs)\n",
+           ds.img_ids.size(), ds.cat_ids.size(), ds.gts.size(), ds.dts.size(), elapsed_s(t0));
+
+    evaluator ev(ds, threads);
+    t0 = std::chrono::steady_clock::now();
+    ev.evaluate();
+    printf("evaluate DONE (t=%.2fs, %d threads)\n", elapsed_s(t0), threads);
+    t0 = std::chrono::steady_clock::now();
+    ev.accumulate();
+    printf("accumulate DONE (t=%.2fs)\n", elapsed_s(t0));
+
+    print_line(ev, true, -1, 0, 100);
+    print_line(ev, true, 0.5, 0, 100);
+    print_line(ev, true, 0.75, 0, 100);
+    print_line(ev, true, -1, 1, 100);
+    print_line(ev, true, -1, 2, 100);
+    print_line(ev, true, -1, 3, 100);
+    print_line(ev, false, -1, 0, 1);
+    print_line(ev, false, -1, 0, 10);
+    print_line(ev, false, -1, 0, 100);
+    print_line(ev, false, -1, 1, 100);
+    print_line(ev, false, -1, 2, 100);
+    print_line(ev, false, -1, 3, 100);
+
+    if (parser.exist("per_class"))
+    {
+        printf("%-6s %-20s %8s %8s %8s %8s\n", "id", "name", "AP", "AP50", "AP75", "AR100");
+        for (size_t k = 0; k < ds.cat_ids.size(); k++)
+        {
+            long long id = ds.cat_ids[k];
+            printf("%-6lld %-20s %8.3f %8.3f %8.3f %8.3f\n", id, ds.cat_names[id].c_str(),
+                   ev.summarize(true, -1, 0, 100, k), ev.summarize(true, 0.5, 0, 100, k),
+                   ev.summarize(true, 0.75, 0, 100, k), ev.summarize(false, -1, 0, 100, k));
+        }
+    }
+
+    std::string pr_json = parser.get<std::string>("pr_json");
+    if (!pr_json.empty())
+    {
+        write_pr_json(pr_json, ds, ev);
+        printf("pr curves: %s\n", pr_json.c_str());
+    }
+    return 0;
+}
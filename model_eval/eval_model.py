@@ -1,3 +1,4 @@
+# 大数据集请用 C++ 版本(结果与本脚本一致)：make && ./coco_eval -g output_coco.json -d model_out.json
 from pycocotools.coco import COCO
 from pycocotools.cocoeval import COCOeval
 
@@ -0,0 +1,205 @@
+import os
+import sys
+import json
+import random
+import argparse
+import subprocess
+
+# 性能回归测试。仓库中不附带基线，基线与硬件、模型文件绑定，先在目标板(或 make HOST=1 的参考后端)上记录一次：
+#   python3 perf_eval.py run --model <model> --update-baseline
+# 之后每次运行与 perf_baseline.json 比较，任何指标退化、基线中的负载失败或缺失都返回非零。
+# 有负载失败时不会写入基线。
+
+# 固定的测试负载：模型类型 x 图像集
+MODEL_TYPES = {
+    0: "person_detection",
+    2: "lpr",
+    3: "face_detection",
+    5: "fire_smoke",
+}
+
+IMAGE_SETS = {
+    "src_img": None,          # model_eval/img/src_img
+    "1080p": (1920, 1080),    # 合成图像
+    "4k": (3840, 2160),
+}
+
+# 每项指标：(报告中的路径, 越大越好)
+METRICS = {
+    "fps": (("fps",), True),
+    "total_p50_us": (("stages", "total", "p50_us"), False),
+    "total_p99_us": (("stages", "total", "p99_us"), False),
+    "track_p50_us": (("stages", "ax_algorithm_track", "p50_us"), False),
+    "track_p99_us": (("stages", "ax_algorithm_track", "p99_us"), False),
+    "init_ms": (("init_ms",), False),
+    "handle_cmm_bytes": (("memory", "handle_cmm_bytes"), False),
+    "rss_peak": (("memory", "rss_peak"), False),
+}
+
+MEMORY_METRICS = ("handle_cmm_bytes", "rss_peak")
+
+CUR_DIR = os.path.dirname(os.path.abspath(__file__))
+DEFAULT_BASELINE = os.path.join(CUR_DIR, "perf_baseline.json")
+
+
+def write_synthetic_set(folder, width, height, count=4):
+    # 生成 PPM 图像，opencv 可以直接解码，内容固定便于复现
+    os.makedirs(folder, exist_ok=True)
+    rng = random.Random(width * height)
+    for i in range(count):
+        path = os.path.join(folder, "synthetic_%02d.ppm" % i)
+        if os.path.exists(path):
+            continue
+        row = bytearray()
+        for x in range(width):
+            row += bytes(((x * 255 // width + i * 40) % 256, rng.randrange(256), (i * 60) % 256))
+        with open(path, "wb") as f:
+            f.write(b"P6\n%d %d\n255\n" % (width, height))
+            for y in range(height):
+                f.write(row[(y % width) * 3:] + row[:(y % width) * 3])
+
+
+def image_set_dir(name, work_dir):
+    size = IMAGE_SETS[name]
+    if size is None:
+        return os.path.join(CUR_DIR, "img", "src_img")
+    folder = os.path.join(work_dir, name)
+    write_synthetic_set(folder, size[0], size[1])
+    return folder
+
+
+def get_metric(report, path):
+    value = report
+    for key in path:
+        if not isinstance(value, dict) or key not in value:
+            return None
+        value = value[key]
+    return value
+
+
+def run_suite(args):
+    os.makedirs(args.work_dir, exist_ok=True)
+    suite = {}
+    for model_type, model_name in MODEL_TYPES.items():
+        for set_name in IMAGE_SETS:
+            name = "%s/%s" % (model_name, set_name)
+            report_path = os.path.join(args.work_dir, "%s_%s.json" % (model_name, set_name))
+            cmd = [args.benchmark, "-m", args.model, "-t", str(model_type),
+                   "-i", image_set_dir(set_name, args.work_dir),
+                   "-w", str(args.warmup), "-n", str(args.iterations), "-r", report_path]
+            print("run %s: %s" % (name, " ".join(cmd)))
+            if os.path.exists(report_path):
+                os.remove(report_path)
+            ret = subprocess.call(cmd, stdout=subprocess.DEVNULL)
+            if ret != 0 or not os.path.exists(report_path):
+                print("  failed, ret: %d" % ret)
+                suite[name] = {"failed": ret}
+                continue
+            with open(report_path) as f:
+                report = json.load(f)
+            suite[name] = {k: get_metric(report, p) for k, (p, _) in METRICS.items()}
+    return suite
+
+
+def failed_workloads(suite):
+    return sorted(name for name, metrics in suite.items() if "failed" in metrics)
+
+
+def compare(base, new, tolerance, memory_tolerance):
+    # 返回 [(workload, metric, base, new, 变化比例, 是否退化)]
+    # 基线中有值而本次失败或缺失的指标算作退化
+    rows = []
+    for name in sorted(set(base) | set(new)):
+        if "failed" in new.get(name, {}) or (name in base and name not in new):
+            rows.append((name, "failed" if name in new else "missing", None, None, None, True))
+            continue
+        for metric, (_, higher_better) in METRICS.items():
+            b = base.get(name, {}).get(metric)
+            n = new.get(name, {}).get(metric)
+            if b is not None and n is None:
+                rows.append((name, metric, b, n, None, True))
+                continue
+            if b is None or n is None or b <= 0:
+                rows.append((name, metric, b, n, None, False))
+                continue
+            change = (n - b) / b
+            tol = memory_tolerance if metric in MEMORY_METRICS else tolerance
+            regressed = change < -tol if higher_better else change > tol
+            rows.append((name, metric, b, n, change, regressed))
+    return rows
+
+
+def print_rows(rows):
+    print("%-28s %-18s %14s %14s %9s" % ("workload", "metric", "base", "new", "change"))
+    for name, metric, b, n, change, regressed in rows:
+        fmt = lambda v: "-" if v is None else ("%.2f" % v if isinstance(v, float) else str(v))
+        print("%-28s %-18s %14s %14s %9s %s" % (name, metric, fmt(b), fmt(n),
+              "-" if change is None else "%+.1f%%" % (change * 100), "REGRESSED" if regressed else ""))
+
+
+def load(path):
+    with open(path) as f:
+        return json.load(f)
+
+
+def save(path, data):
+    with open(path, "w") as f:
+        json.dump(data, f, indent=4, sort_keys=True)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="performance regression suite for ax_algorithm")
+    sub = parser.add_subparsers(dest="command")
+
+    run = sub.add_parser("run", help="run the suite and check it against the baseline")
+    run.add_argument("--benchmark", default="../example/main_benchmark", help="main_benchmark executable")
+    run.add_argument("--model", required=True, help="model file")
+    run.add_argument("--work-dir", default="perf_work", help="synthetic images and raw reports")
+    run.add_argument("--warmup", type=int, default=20)
+    run.add_argument("--iterations", type=int, default=300)
+    run.add_argument("--output", default="perf_report.json", help="suite report path")
+    run.add_argument("--baseline", default=DEFAULT_BASELINE)
+    run.add_argument("--tolerance", type=float, default=0.05, help="allowed latency/throughput regression")
+    run.add_argument("--memory-tolerance", type=float, default=0.10, help="allowed memory regression")
+    run.add_argument("--update-baseline", action="store_true", help="store this run as the new baseline")
+
+    diff = sub.add_parser("diff", help="print two suite reports side by side")
+    diff.add_argument("base")
+    diff.add_argument("new")
+    diff.add_argument("--tolerance", type=float, default=0.05)
+    diff.add_argument("--memory-tolerance", type=float, default=0.10)
+
+    args = parser.parse_args()
+    if args.command == "run":
+        suite = run_suite(args)
+        save(args.output, suite)
+        print("suite report saved to %s" % args.output)
+        failed = failed_workloads(suite)
+        for name in failed:
+            print("workload %s failed" % name)
+        if args.update_baseline and failed:
+            print("%d workload(s) failed, baseline not updated" % len(failed))
+            return 1
+        if args.update_baseline:
+            save(args.baseline, suite)
+            print("baseline updated: %s" % args.baseline)
+            return 0
+        if not os.path.exists(args.baseline):
+            print("no baseline at %s, record one first: python3 perf_eval.py run --model %s --update-baseline"
+                  % (args.baseline, args.model))
+            return 1
+        rows = compare(load(args.baseline), suite, args.tolerance, args.memory_tolerance)
+        print_rows(rows)
+        regressions = [r for r in rows if r[5]]
+        print("%d regression(s)" % len(regressions))
+        return 1 if regressions or failed else 0
+    elif args.command == "diff":
+        rows = compare(load(args.base), load(args.new), args.tolerance, args.memory_tolerance)
+        print_rows(rows)
+        return 0
+    parser.print_help()
+    return 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
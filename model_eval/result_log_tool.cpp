@@ -0,0 +1,252 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <set>
+#include <string>
+
+#include "cmdline.hpp"
+#include "result_log.hpp"
+#include "result_writer.hpp"
+
+/**
+ * result_log 二进制结果日志工具：
+ *   info    打印文件头、帧数、记录数、时间范围和各路视频的目标数
+ *   jsonl   每条记录转成一行 JSON，保留所有字段
+ *   coco    转成 COCO 检测结果数组，image_id 取帧号，category_id 取 label
+ *   track   列出 track_id 出现过的所有帧
+ *   frames  按时间范围列出帧，使用帧索引二分查找
+ */
+
+static void record_json(const result_log::record_t &r, std::string &line)
+{
+    char buf[512];
+    int n = snprintf(buf, sizeof(buf),
+                     "{\"stream_id\":%d,\"frame_id\":%llu,\"timestamp_us\":%lld,\"model_type\":%d,\"n_objects\":%d",
+                     r.stream_id, r.frame_id, r.timestamp_us, r.model_type, r.n_objects);
+    line.assign(buf, n);
+    if (r.n_objects == 0)
+    {
+        line += "}";
+        return;
+    }
+    n = snprintf(buf, sizeof(buf), ",\"obj_index\":%d,\"track_id\":%llu,\"label\":%d,\"bbox\":[%.9g,%.9g,%.9g,%.9g],\"score\":%.9g",
+                 r.obj_index, r.track_id, r.label, r.bbox.x, r.bbox.y, r.bbox.w, r.bbox.h, r.score);
+    line.append(buf, n);
+    switch (r.model_type)
+    {
+    case ax_model_type_face_detection:
+    case ax_model_type_face_recognition:
+        n = snprintf(buf, sizeof(buf), ",\"quality\":%.9g,\"points\":[", r.info.face.quality);
+        line.append(buf, n);
+        for (int k = 0; k < AX_ALGORITHM_FACE_POINT_LEN; k++)
+        {
+            n = snprintf(buf, sizeof(buf), "%s%.9g,%.9g", k ? "," : "", r.info.face.points[k].x, r.info.face.points[k].y);
+            line.append(buf, n);
+        }
+        line += "]";
+        break;
+    case ax_model_type_person_detection:
+        n = snprintf(buf, sizeof(buf), ",\"status\":%d", r.info.person.status);
+        line.append(buf, n);
+        break;
+    case ax_model_type_fire_smoke:
+        n = snprintf(buf, sizeof(buf), ",\"fire_smoke_label\":%d", r.info.fire_smoke.label);
+        line.append(buf, n);
+        break;
+    case ax_model_type_lpr:
+    {
+        n = snprintf(buf, sizeof(buf), ",\"cartype\":%d,\"b_is_track_plate\":%d,\"plate_id\":[",
+                     r.info.vehicle.cartype, r.info.vehicle.b_is_track_plate);
+        line.append(buf, n);
+        int len = std::min<int>(std::max<int>(r.info.vehicle.len_plate_id, 0), result_log::max_plate_len);
+        for (int k = 0; k < len; k++)
+        {
+            n = snprintf(buf, sizeof(buf), "%s%d", k ? "," : "", r.info.vehicle.plate_id[k]);
+            line.append(buf, n);
+        }
+        line += "]";
+    }
+    break;
+    default:
+        break;
+    }
+    line += "}";
+}
+
+static int cmd_info(const result_log::reader &log)
+{
+    auto &h = log.header();
+    printf("version: %u, record size: %u, created: %lld us\n", h.version, h.record_size, h.created_us);
+    printf("frames: %zu, records: %zu\n", log.n_frames(), log.n_records());
+    if (log.n_frames() == 0)
+    {
+        return 0;
+    }
+    printf("time: %lld us - %lld us (%.1f s)\n", log.frame(0).timestamp_us, log.frame(log.n_frames() - 1).timestamp_us,
+           (log.frame(log.n_frames() - 1).timestamp_us - log.frame(0).timestamp_us) / 1e6);
+
+    std::map<int, std::pair<size_t, size_t>> streams; // stream_id -> (帧数, 目标数)
+    std::set<std::pair<int, unsigned long long>> tracks;
+    for (size_t i = 0; i < log.n_frames(); i++)
+    {
+        auto &s = streams[log.frame(i).stream_id];
+        s.first++;
+        size_t n;
+        const result_log::record_t *r = log.frame_records(i, &n);
+        for (size_t j = 0; j < n; j++)
+        {
+            if (r[j].n_objects > 0)
+            {
+                s.second++;
+                tracks.insert(std::make_pair(r[j].stream_id, r[j].track_id));
+            }
+        }
+    }
+    for (auto &s : streams)
+    {
+        printf("stream %d: %zu frames, %zu objects\n", s.first, s.second.first, s.second.second);
+    }
+    printf("distinct tracks: %zu\n", tracks.size());
+    return 0;
+}
+
+static int cmd_jsonl(const result_log::reader &log, const std::string &output)
+{
+    result_writer::jsonl_writer writer;
+    if (writer.open(output) != 0)
+    {
+        fprintf(stderr, "open %s failed\n", output.c_str());
+        return -1;
+    }
+    std::string line;
+    for (size_t i = 0; i < log.n_records(); i++)
+    {
+        record_json(log.record(i), line);
+        writer.write_line(line);
+    }
+    writer.close();
+    printf("%llu lines -> %s\n", writer.records(), output.c_str());
+    return 0;
+}
+
+static int cmd_coco(const result_log::reader &log, const std::string &output)
+{
+    std::string jsonl = output + "l";
+    result_writer::jsonl_writer writer;
+    if (writer.open(jsonl) != 0)
+    {
+        fprintf(stderr, "open %s failed\n", jsonl.c_str());
+        return -1;
+    }
+    for (size_t i = 0; i < log.n_records(); i++)
+    {
+        auto &r = log.record(i);
+        if (r.n_objects > 0)
+        {
+            writer.write(r.frame_id, r.label, r.bbox, r.score);
+        }
+    }
+    writer.close();
+    int ret = result_writer::finalize(jsonl, output);
+    remove(jsonl.c_str());
+    if (ret != 0)
+    {
+        fprintf(stderr, "write %s failed\n", output.c_str());
+        return -1;
+    }
+    printf("%llu detections -> %s\n", writer.records(), output.c_str());
+    return 0;
+}
+
+static void print_record(const result_log::record_t &r)
+{
+    printf("stream %d frame %llu t=%lld track %llu label %d score %.3f bbox [%.1f %.1f %.1f %.1f]\n",
+           r.stream_id, r.frame_id, r.timestamp_us, r.track_id, r.label, r.score, r.bbox.x, r.bbox.y, r.bbox.w, r.bbox.h);
+}
+
+static int cmd_track(const result_log::reader &log, unsigned long long track_id, int stream_id)
+{
+    // 定长记录顺序扫描，不需要解析
+    size_t hits = 0;
+    const result_log::record_t *r = log.records();
+    for (size_t i = 0; i < log.n_records(); i++)
+    {
+        if (r[i].n_objects > 0 && r[i].track_id == track_id && (stream_id < 0 || r[i].stream_id == stream_id))
+        {
+            print_record(r[i]);
+            hits++;
+        }
+    }
+    printf("track %llu: %zu frames\n", track_id, hits);
+    return 0;
+}
+
+static int cmd_frames(const result_log::reader &log, long long from_us, long long to_us, int stream_id)
+{
+    size_t frames = 0;
+    for (size_t i = log.lower_bound(from_us); i < log.n_frames() && log.frame(i).timestamp_us <= to_us; i++)
+    {
+        auto &f = log.frame(i);
+        if (stream_id >= 0 && f.stream_id != stream_id)
+        {
+            continue;
+        }
+        size_t n;
+        const result_log::record_t *r = log.frame_records(i, &n);
+        printf("stream %d frame %llu t=%lld objects %d\n", f.stream_id, f.frame_id, f.timestamp_us, r[0].n_objects);
+        for (size_t j = 0; j < n && r[0].n_objects > 0; j++)
+        {
+            printf("  ");
+            print_record(r[j]);
+        }
+        frames++;
+    }
+    printf("%zu frames\n", frames);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    cmdline::parser parser;
+    parser.add<std::string>("input", 'i', "result log file", true, "");
+    parser.add<std::string>("command", 'm', "command", false, "info", cmdline::oneof<std::string>("info", "jsonl", "coco", "track", "frames"));
+    parser.add<std::string>("output", 'o', "output file of jsonl/coco", false, "");
+    parser.add<long long>("track", 't', "track id of track command", false, 0);
+    parser.add<int>("stream", 's', "only this stream, -1 means all", false, -1);
+    parser.add<long long>("from", 0, "start timestamp (us) of frames command", false, 0);
+    parser.add<long long>("to", 0, "end timestamp (us) of frames command", false, 0x7fffffffffffffffLL);
+    parser.parse_check(argc, argv);
+
+    auto t0 = std::chrono::steady_clock::now();
+    result_log::reader log;
+    if (log.open(parser.get<std::string>("input")) != 0)
+    {
+        fprintf(stderr, "open %s failed or not a result log (version %d)\n", parser.get<std::string>("input").c_str(), result_log::version);
+        return -1;
+    }
+
+    std::string command = parser.get<std::string>("command");
+    std::string output = parser.get<std::string>("output");
+    if ((command == "jsonl" || command == "coco") && output.empty())
+    {
+        fprintf(stderr, "%s needs --output\n", command.c_str());
+        return -1;
+    }
+
+    int ret = 0;
+    if (command == "info")
+        ret = cmd_info(log);
+    else if (command == "jsonl")
+        ret = cmd_jsonl(log, output);
+    else if (command == "coco")
+        ret = cmd_coco(log, output);
+    else if (command == "track")
+        ret = cmd_track(log, parser.get<long long>("track"), parser.get<int>("stream"));
+    else if (command == "frames")
+        ret = cmd_frames(log, parser.get<long long>("from"), parser.get<long long>("to"), parser.get<int>("stream"));
+
+    fprintf(stderr, "%s done in %.3f s\n", command.c_str(),
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+    return ret;
+}
@@ -0,0 +1,473 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cmdline.hpp"
+#include "json_lite.hpp"
+#include "result_log.hpp"
+
+/**
+ * 阈值扫描：main_executable --sweep_cache 以最低阈值运行一次推理并缓存所有候选框，
+ * 本工具从缓存计算任意阈值组合的工作点(TP/FP/FN、precision、recall、F1、AP50)，不需要重新推理。
+ * - 匹配与 COCOeval 相同：每张图每个类别内按分数从高到低贪心匹配 IoU 最大的未匹配真值，匹配到 crowd 的检测忽略
+ * - 贪心匹配中低分框不影响高分框的匹配，所以 det_threshold 的结果是同一次匹配按分数截断的前缀，
+ *   一次匹配得到所有 det_threshold 的结果；quality_threshold 会去掉任意位置的框，每个取值单独匹配
+ * - lpr_threshold 作用于车牌识别置信度，ax_result_t 中没有这个值，无法离线扫描
+ */
+
+struct gt_t
+{
+    long long image_id;
+    long long category_id;
+    double bbox[4];
+    bool crowd;
+};
+
+struct dt_t
+{
+    long long image_id;
+    long long category_id;
+    double bbox[4];
+    float score;
+    float quality;
+};
+
+// 一次匹配后每个检测框的结果
+struct match_t
+{
+    float score;
+    bool tp;
+};
+
+struct point_t
+{
+    float det_threshold;
+    float quality_threshold;
+    long long dets = 0, tp = 0, fp = 0, fn = 0;
+    double precision = 0, recall = 0, f1 = 0, ap50 = 0;
+};
+
+static double box_iou(const double *d, const double *g, bool crowd)
+{
+    double w = std::min(d[0] + d[2], g[0] + g[2]) - std::max(d[0], g[0]);
+    if (w <= 0)
+    {
+        return 0;
+    }
+    double h = std::min(d[1] + d[3], g[1] + g[3]) - std::max(d[1], g[1]);
+    if (h <= 0)
+    {
+        return 0;
+    }
+    double inter = w * h;
+    double uni = crowd ? d[2] * d[3] : d[2] * d[3] + g[2] * g[3] - inter;
+    return inter / uni;
+}
+
+template <typename F>
+static void parallel_for(size_t n, int threads, F fn)
+{
+    std::atomic<size_t> next{0};
+    auto work = [&]()
+    {
+        for (size_t i = next++; i < n; i = next++)
+        {
+            fn(i);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads && (size_t)i < n; i++)
+    {
+        pool.emplace_back(work);
+    }
+    work();
+    for (auto &th : pool)
+    {
+        th.join();
+    }
+}
+
+// "0.1:0.9:0.05" 或 "0.3,0.5,0.7"
+static bool parse_grid(const std::string &spec, std::vector<float> &values)
+{
+    values.clear();
+    float start, stop, step;
+    if (sscanf(spec.c_str(), "%f:%f:%f", &start, &stop, &step) == 3)
+    {
+        if (step <= 0 || stop < start)
+        {
+            return false;
+        }
+        for (int i = 0; start + i * step <= stop + step * 1e-3f; i++)
+        {
+            values.push_back(roundf((start + i * step) * 1e4f) / 1e4f);
+        }
+        return true;
+    }
+    size_t pos = 0;
+    while (pos <= spec.size())
+    {
+        size_t comma = spec.find(',', pos);
+        std::string item = spec.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+        char *stop_ptr = nullptr;
+        float v = strtof(item.c_str(), &stop_ptr);
+        if (item.empty() || *stop_ptr != 0)
+        {
+            return false;
+        }
+        values.push_back(v);
+        if (comma == std::string::npos)
+        {
+            break;
+        }
+        pos = comma + 1;
+    }
+    std::sort(values.begin(), values.end());
+    return !values.empty();
+}
+
+static bool load_gt(const std::string &path, std::vector<long long> &img_ids, std::vector<gt_t> &gts)
+{
+    json_lite::value gt;
+    std::string error;
+    if (!json_lite::parse_file(path, gt, &error))
+    {
+        printf("%s\n", error.c_str());
+        return false;
+    }
+    for (auto &img : gt["images"].array())
+    {
+        img_ids.push_back((long long)img.get("id", 0));
+    }
+    std::sort(img_ids.begin(), img_ids.end());
+    img_ids.erase(std::unique(img_ids.begin(), img_ids.end()), img_ids.end());
+    for (auto &v : gt["annotations"].array())
+    {
+        const json_lite::value &bbox = v["bbox"];
+        if (bbox.size() < 4)
+        {
+            continue;
+        }
+        gt_t g;
+        g.image_id = (long long)v.get("image_id", 0);
+        g.category_id = (long long)v.get("category_id", 0);
+        for (int k = 0; k < 4; k++)
+        {
+            g.bbox[k] = bbox.at(k).number();
+        }
+        g.crowd = v.get("iscrowd", 0) != 0;
+        gts.push_back(g);
+    }
+    return true;
+}
+
+/**
+ * @brief: 一张图一个类别内的贪心匹配，忽略的检测框(匹配到 crowd)不输出
+ * @param[in] dets: 已按分数从高到低排序
+ */
+static void match_cell(const std::vector<const dt_t *> &dets, const std::vector<const gt_t *> &gts, double iou_thr, std::vector<match_t> &out)
+{
+    // 与 COCOeval 相同，非 crowd 真值排在前面，匹配到非 crowd 后不再换成 crowd
+    std::vector<const gt_t *> order;
+    for (auto g : gts)
+        if (!g->crowd)
+            order.push_back(g);
+    for (auto g : gts)
+        if (g->crowd)
+            order.push_back(g);
+    std::vector<bool> used(order.size(), false);
+    for (auto d : dets)
+    {
+        double best = std::min(iou_thr, 1 - 1e-10);
+        int m = -1;
+        for (size_t j = 0; j < order.size(); j++)
+        {
+            if (used[j] && !order[j]->crowd)
+            {
+                continue;
+            }
+            if (m >= 0 && !order[m]->crowd && order[j]->crowd)
+            {
+                break;
+            }
+            double iou = box_iou(d->bbox, order[j]->bbox, order[j]->crowd);
+            if (iou < best)
+            {
+                continue;
+            }
+            best = iou;
+            m = j;
+        }
+        if (m >= 0 && order[m]->crowd)
+        {
+            continue;
+        }
+        if (m >= 0)
+        {
+            used[m] = true;
+        }
+        out.push_back({d->score, m >= 0});
+    }
+}
+
+// COCO 101 点插值 AP，matches 按分数从高到低，只取前 n 个
+static double ap_101(const std::vector<match_t> &matches, size_t n, long long npig)
+{
+    if (npig == 0)
+    {
+        return -1;
+    }
+    std::vector<double> rc(n), pr(n);
+    long long tp = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        tp += matches[i].tp;
+        rc[i] = (double)tp / npig;
+        pr[i] = (double)tp / (i + 1);
+    }
+    for (size_t i = n; i-- > 1;)
+    {
+        pr[i - 1] = std::max(pr[i - 1], pr[i]);
+    }
+    double sum = 0;
+    for (int r = 0; r <= 100; r++)
+    {
+        size_t i = std::lower_bound(rc.begin(), rc.end(), r / 100.0) - rc.begin();
+        sum += i < n ? pr[i] : 0;
+    }
+    return sum / 101;
+}
+
+int main(int argc, char *argv[])
+{
+    cmdline::parser parser;
+    parser.add<std::string>("gt", 'g', "ground truth coco json", false, "output_coco.json");
+    parser.add<std::string>("cache", 'c', "raw candidate cache written by main_executable --sweep_cache", true, "");
+    parser.add<std::string>("det", 'd', "det_threshold grid, start:stop:step or comma list", false, "0.05:0.95:0.05");
+    parser.add<std::string>("quality", 'q', "quality_threshold grid of face models", false, "0");
+    parser.add<double>("iou", 0, "IoU threshold of a true positive", false, 0.5);
+    parser.add<int>("threads", 'j', "worker threads, 0 means all cores", false, 0);
+    parser.add<std::string>("csv", 0, "also write the table to this csv", false, "");
+    parser.parse_check(argc, argv);
+
+    int threads = parser.get<int>("threads");
+    if (threads <= 0)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    std::vector<float> det_grid, quality_grid;
+    if (!parse_grid(parser.get<std::string>("det"), det_grid) || !parse_grid(parser.get<std::string>("quality"), quality_grid))
+    {
+        printf("invalid threshold grid\n");
+        return -1;
+    }
+    double iou_thr = parser.get<double>("iou");
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<long long> img_ids;
+    std::vector<gt_t> gts;
+    if (!load_gt(parser.get<std::string>("gt"), img_ids, gts))
+    {
+        return -1;
+    }
+
+    result_log::reader cache;
+    if (cache.open(parser.get<std::string>("cache")) != 0)
+    {
+        printf("open %s failed\n", parser.get<std::string>("cache").c_str());
+        return -1;
+    }
+    std::vector<dt_t> dts;
+    int model_type = -1;
+    size_t full_frames = 0, unknown_frames = 0;
+    for (size_t i = 0; i < cache.n_frames(); i++)
+    {
+        size_t n;
+        const result_log::record_t *r = cache.frame_records(i, &n);
+        if (!std::binary_search(img_ids.begin(), img_ids.end(), (long long)r[0].frame_id))
+        {
+            unknown_frames++;
+            continue;
+        }
+        full_frames += r[0].n_objects >= AX_ALGORITHM_MAX_OBJ_NUM;
+        for (size_t j = 0; j < n && r[0].n_objects > 0; j++)
+        {
+            dt_t d;
+            d.image_id = r[j].frame_id;
+            d.category_id = r[j].label;
+            d.bbox[0] = r[j].bbox.x;
+            d.bbox[1] = r[j].bbox.y;
+            d.bbox[2] = r[j].bbox.w;
+            d.bbox[3] = r[j].bbox.h;
+            d.score = r[j].score;
+            d.quality = r[j].info.face.quality;
+            model_type = r[j].model_type;
+            dts.push_back(d);
+        }
+    }
+    bool face = model_type == ax_model_type_face_detection || model_type == ax_model_type_face_recognition;
+    if (!face)
+    {
+        quality_grid.assign(1, -INFINITY);
+    }
+    printf("loaded %zu images, %zu ground truths, %zu candidates (%.2fs)\n", img_ids.size(), gts.size(), dts.size(),
+           std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+    if (unknown_frames)
+    {
+        printf("warning: %zu cached frames are not in the ground truth and were skipped\n", unknown_frames);
+    }
+    if (full_frames)
+    {
+        printf("warning: %zu frames hit %d candidates, results near sweep_floor may be truncated\n", full_frames, AX_ALGORITHM_MAX_OBJ_NUM);
+    }
+
+    // (图像, 类别) 分组，检测框组内按分数从高到低
+    std::map<std::pair<long long, long long>, std::pair<std::vector<const gt_t *>, std::vector<const dt_t *>>> cells;
+    std::map<long long, long long> npig; // 类别 -> 非 crowd 真值数
+    for (auto &g : gts)
+    {
+        cells[std::make_pair(g.image_id, g.category_id)].first.push_back(&g);
+        if (!g.crowd)
+        {
+            npig[g.category_id]++;
+        }
+    }
+    for (auto &d : dts)
+    {
+        cells[std::make_pair(d.image_id, d.category_id)].second.push_back(&d);
+        npig[d.category_id] += 0;
+    }
+    std::vector<long long> cell_cat;
+    std::vector<decltype(&cells.begin()->second)> cell_data;
+    for (auto &c : cells)
+    {
+        std::stable_sort(c.second.second.begin(), c.second.second.end(), [](const dt_t *a, const dt_t *b)
+                         { return a->score > b->score; });
+        cell_cat.push_back(c.first.second);
+        cell_data.push_back(&c.second);
+    }
+    std::vector<long long> cat_ids;
+    for (auto &c : npig)
+    {
+        cat_ids.push_back(c.first);
+    }
+
+    // 每个 quality 取值一次匹配，(quality, 类别) 的匹配结果按分数合并排序
+    t0 = std::chrono::steady_clock::now();
+    size_t Q = quality_grid.size(), K = cat_ids.size();
+    std::vector<std::vector<match_t>> matches(Q * K);
+    parallel_for(Q * K, threads, [&](size_t t)
+                 {
+        float q = quality_grid[t / K];
+        long long cat = cat_ids[t % K];
+        std::vector<const dt_t *> dets;
+        auto &out = matches[t];
+        for (size_t c = 0; c < cell_data.size(); c++)
+        {
+            if (cell_cat[c] != cat)
+            {
+                continue;
+            }
+            dets.clear();
+            for (auto d : cell_data[c]->second)
+            {
+                if (!face || d->quality >= q)
+                {
+                    dets.push_back(d);
+                }
+            }
+            match_cell(dets, cell_data[c]->first, iou_thr, out);
+        }
+        std::stable_sort(out.begin(), out.end(), [](const match_t &a, const match_t &b)
+                         { return a.score > b.score; }); });
+
+    // 每个 (quality, det) 工作点：分数截断后的前缀
+    std::vector<point_t> points(Q * det_grid.size());
+    parallel_for(points.size(), threads, [&](size_t t)
+                 {
+        size_t qi = t / det_grid.size();
+        point_t &p = points[t];
+        p.quality_threshold = quality_grid[qi];
+        p.det_threshold = det_grid[t % det_grid.size()];
+        double ap_sum = 0;
+        int ap_n = 0;
+        for (size_t k = 0; k < K; k++)
+        {
+            auto &m = matches[qi * K + k];
+            size_t n = std::partition_point(m.begin(), m.end(), [&](const match_t &x)
+                                            { return x.score >= p.det_threshold; }) - m.begin();
+            long long tp = 0;
+            for (size_t i = 0; i < n; i++)
+            {
+                tp += m[i].tp;
+            }
+            long long np = npig[cat_ids[k]];
+            p.dets += n;
+            p.tp += tp;
+            p.fp += n - tp;
+            p.fn += np - tp;
+            double ap = ap_101(m, n, np);
+            if (ap >= 0)
+            {
+                ap_sum += ap;
+                ap_n++;
+            }
+        }
+        p.precision = p.dets ? (double)p.tp / p.dets : 0;
+        p.recall = p.tp + p.fn ? (double)p.tp / (p.tp + p.fn) : 0;
+        p.f1 = p.precision + p.recall > 0 ? 2 * p.precision * p.recall / (p.precision + p.recall) : 0;
+        p.ap50 = ap_n ? ap_sum / ap_n : -1; });
+    double sweep_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    size_t best = 0;
+    for (size_t i = 1; i < points.size(); i++)
+    {
+        if (points[i].f1 > points[best].f1)
+        {
+            best = i;
+        }
+    }
+
+    FILE *csv = nullptr;
+    std::string csv_path = parser.get<std::string>("csv");
+    if (!csv_path.empty())
+    {
+        csv = fopen(csv_path.c_str(), "w");
+        if (csv == nullptr)
+        {
+            printf("open %s failed\n", csv_path.c_str());
+            return -1;
+        }
+        fprintf(csv, "det_threshold,quality_threshold,dets,tp,fp,fn,precision,recall,f1,ap%g\n", iou_thr * 100);
+    }
+    printf("%8s %8s %9s %9s %9s %9s %9s %9s %9s %9s\n", "det_thr", face ? "qual_thr" : "", "dets", "TP", "FP", "FN",
+           "precision", "recall", "F1", "AP");
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        auto &p = points[i];
+        char quality[16] = "";
+        if (face)
+        {
+            snprintf(quality, sizeof(quality), "%.3f", p.quality_threshold);
+        }
+        printf("%8.3f %8s %9lld %9lld %9lld %9lld %9.4f %9.4f %9.4f %9.4f%s\n", p.det_threshold, quality, p.dets, p.tp, p.fp, p.fn,
+               p.precision, p.recall, p.f1, p.ap50, i == best ? "  <- best F1" : "");
+        if (csv)
+        {
+            fprintf(csv, "%g,%s,%lld,%lld,%lld,%lld,%.6f,%.6f,%.6f,%.6f\n", p.det_threshold, quality, p.dets, p.tp, p.fp, p.fn,
+                    p.precision, p.recall, p.f1, p.ap50);
+        }
+    }
+    if (csv)
+    {
+        fclose(csv);
+    }
+    printf("%zu operating points, IoU %.2f (%.2fs, %d threads)\n", points.size(), iou_thr, sweep_s, threads);
+    return 0;
+}
@@ -0,0 +1,1016 @@
+#include <dirent.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cmdline.hpp"
+
+/**
+ * xml2coco.py 的 C++ 版本，输出与 Python 版逐字节相同：
+ * - 文件按 natural_key 排序(ASCII 小写，数字段按整数比较，相等时保持目录读取顺序，与 Python 稳定排序一致)
+ * - 各 XML 在线程池中并行解析，解析结果按排序顺序合并，image_id、annotation_id、类别 id 与并行度无关
+ * - 单个文件出错时与 Python 的 try/except 行为一致：出错之前已追加的 image、类别和标注保留，image_id 不递增
+ * - 输出格式与 json.dump(indent=4, ensure_ascii=True) 相同
+ * 只支持 UTF-8/ASCII/ISO-8859-1 编码的 XML。以下输入 Python 版可以处理而这里无法保证结果相同，
+ * 遇到时列出文件并退出，不写输出文件：
+ * - DOCTYPE 中声明了实体(ElementTree 会展开)
+ * - 整数字段超出 ±2^30，或含非 ASCII 数字/空白(Python 的 int() 接受)
+ * 排序只把 ASCII 0-9 当作数字段，文件名含其它 Unicode 数字时顺序可能与 Python 不同。
+ */
+
+// ---------------------------------------------------------------- XML
+
+struct xml_node_t
+{
+    std::string name;
+    std::string text; // 第一个子元素之前的文本，等同 ElementTree 的 .text
+    bool has_text = false;
+    bool has_child = false;
+    int first_child = -1;
+    int last_child = -1;
+    int next_sibling = -1;
+};
+
+// 单遍解析成扁平节点数组，0 号为根元素，只保留 .text 需要的文本
+class xml_parser
+{
+public:
+    bool parse(std::string &buf, std::vector<xml_node_t> &nodes, std::string &error)
+    {
+        nodes.clear();
+        if (!decode(buf, error))
+        {
+            return false;
+        }
+        begin_ = p_ = buf.data();
+        end_ = buf.data() + buf.size();
+        std::vector<int> stack;
+        bool root_done = false;
+        while (p_ < end_)
+        {
+            if (*p_ != '<')
+            {
+                const char *run = p_;
+                while (p_ < end_ && *p_ != '<')
+                {
+                    p_++;
+                }
+                if (stack.empty())
+                {
+                    for (const char *c = run; c < p_; c++)
+                    {
+                        if (!is_space(*c))
+                        {
+                            return fail(c, root_done ? "junk after document element" : "syntax error", error);
+                        }
+                    }
+                    continue;
+                }
+                if (!char_data(run, p_, nodes[stack.back()], error))
+                {
+                    return false;
+                }
+                continue;
+            }
+            const char *tag = p_;
+            if (starts_with("<?"))
+            {
+                if (!skip_past("?>"))
+                    return fail(tag, "unclosed token", error);
+            }
+            else if (starts_with("<!--"))
+            {
+                if (!skip_past("-->"))
+                    return fail(tag, "unclosed token", error);
+            }
+            else if (starts_with("<![CDATA["))
+            {
+                if (stack.empty())
+                    return fail(tag, "syntax error", error);
+                const char *data = p_ + 9;
+                if (!skip_past("]]>"))
+                    return fail(tag, "unclosed CDATA section", error);
+                append_text(nodes[stack.back()], data, p_ - 3 - data);
+            }
+            else if (starts_with("<!DOCTYPE"))
+            {
+                if (!nodes.empty() || !skip_doctype())
+                    return fail(tag, "syntax error", error);
+                entity_decl_ = std::string(tag, p_).find("<!ENTITY") != std::string::npos;
+            }
+            else if (starts_with("</"))
+            {
+                p_ += 2;
+                const char *name = p_;
+                while (p_ < end_ && is_name_char(*p_))
+                {
+                    p_++;
+                }
+                size_t len = p_ - name;
+                while (p_ < end_ && is_space(*p_))
+                {
+                    p_++;
+                }
+                if (p_ >= end_ || *p_ != '>')
+                    return fail(tag, "unclosed token", error);
+                p_++;
+                if (stack.empty() || nodes[stack.back()].name.compare(0, std::string::npos, name, len) != 0)
+                    return fail(name, "mismatched tag", error);
+                stack.pop_back();
+                root_done = stack.empty();
+            }
+            else
+            {
+                p_++;
+                const char *name = p_;
+                while (p_ < end_ && is_name_char(*p_))
+                {
+                    p_++;
+                }
+                if (p_ == name)
+                    return fail(tag, "not well-formed (invalid token)", error);
+                if (root_done)
+                    return fail(tag, "junk after document element", error);
+                int id = nodes.size();
+                nodes.emplace_back();
+                nodes.back().name.assign(name, p_ - name);
+                if (!stack.empty())
+                {
+                    xml_node_t &parent = nodes[stack.back()];
+                    if (parent.last_child >= 0)
+                        nodes[parent.last_child].next_sibling = id;
+                    else
+                        parent.first_child = id;
+                    parent.last_child = id;
+                    parent.has_child = true;
+                }
+                bool empty = false;
+                if (!skip_attributes(&empty))
+                    return fail(tag, "not well-formed (invalid token)", error);
+                if (!empty)
+                {
+                    stack.push_back(id);
+                }
+                else
+                {
+                    root_done = stack.empty();
+                }
+            }
+        }
+        if (nodes.empty())
+            return fail(p_, "no element found", error);
+        if (!stack.empty())
+            return fail(p_, "no element found", error);
+        return true;
+    }
+
+    // DOCTYPE 中声明了实体
+    bool entity_decl() const { return entity_decl_; }
+
+private:
+    static bool is_space(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+    static bool is_name_char(char c)
+    {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '-' ||
+               c == '.' || c == ':' || (unsigned char)c >= 0x80;
+    }
+
+    bool starts_with(const char *s) const
+    {
+        size_t n = strlen(s);
+        return (size_t)(end_ - p_) >= n && memcmp(p_, s, n) == 0;
+    }
+
+    bool skip_past(const char *s)
+    {
+        size_t n = strlen(s);
+        const char *hit = (const char *)memmem(p_, end_ - p_, s, n);
+        if (hit == nullptr)
+        {
+            return false;
+        }
+        p_ = hit + n;
+        return true;
+    }
+
+    bool skip_doctype()
+    {
+        int bracket = 0;
+        char quote = 0;
+        for (p_ += 9; p_ < end_; p_++)
+        {
+            char c = *p_;
+            if (quote)
+            {
+                quote = c == quote ? 0 : quote;
+            }
+            else if (c == '"' || c == '\'')
+            {
+                quote = c;
+            }
+            else if (c == '[')
+            {
+                bracket++;
+            }
+            else if (c == ']')
+            {
+                bracket--;
+            }
+            else if (c == '>' && bracket == 0)
+            {
+                p_++;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool skip_attributes(bool *empty)
+    {
+        while (p_ < end_)
+        {
+            char c = *p_;
+            if (c == '>')
+            {
+                p_++;
+                return true;
+            }
+            if (c == '/')
+            {
+                if (p_ + 1 < end_ && p_[1] == '>')
+                {
+                    p_ += 2;
+                    *empty = true;
+                    return true;
+                }
+                return false;
+            }
+            if (c == '"' || c == '\'')
+            {
+                const char *close = (const char *)memchr(p_ + 1, c, end_ - p_ - 1);
+                if (close == nullptr || memchr(p_ + 1, '<', close - p_ - 1) != nullptr)
+                {
+                    return false;
+                }
+                p_ = close + 1;
+                continue;
+            }
+            if (c == '<')
+            {
+                return false;
+            }
+            p_++;
+        }
+        return false;
+    }
+
+    // 实体和字符引用解码后追加到 .text；已有子元素时是上一个子元素的 tail，丢弃
+    bool char_data(const char *b, const char *e, xml_node_t &node, std::string &error)
+    {
+        if (node.has_child)
+        {
+            return check_entities(b, e, error);
+        }
+        node.has_text = true;
+        for (const char *c = b; c < e;)
+        {
+            const char *amp = (const char *)memchr(c, '&', e - c);
+            if (amp == nullptr)
+            {
+                node.text.append(c, e - c);
+                break;
+            }
+            node.text.append(c, amp - c);
+            const char *semi = (const char *)memchr(amp, ';', e - amp);
+            if (semi == nullptr || !entity(amp + 1, semi, node.text))
+            {
+                return fail(amp, "undefined entity", error);
+            }
+            c = semi + 1;
+        }
+        return true;
+    }
+
+    bool check_entities(const char *b, const char *e, std::string &error)
+    {
+        std::string scratch;
+        for (const char *amp = (const char *)memchr(b, '&', e - b); amp != nullptr; amp = (const char *)memchr(amp + 1, '&', e - amp - 1))
+        {
+            const char *semi = (const char *)memchr(amp, ';', e - amp);
+            if (semi == nullptr || !entity(amp + 1, semi, scratch))
+            {
+                return fail(amp, "undefined entity", error);
+            }
+        }
+        return true;
+    }
+
+    static bool entity(const char *b, const char *e, std::string &out)
+    {
+        std::string name(b, e);
+        if (name == "lt")
+            out += '<';
+        else if (name == "gt")
+            out += '>';
+        else if (name == "amp")
+            out += '&';
+        else if (name == "quot")
+            out += '"';
+        else if (name == "apos")
+            out += '\'';
+        else if (name.size() > 1 && name[0] == '#')
+        {
+            bool hex = name[1] == 'x';
+            const char *digits = name.c_str() + (hex ? 2 : 1);
+            if (*digits == 0)
+                return false;
+            char *stop = nullptr;
+            unsigned long cp = strtoul(digits, &stop, hex ? 16 : 10);
+            if (*stop != 0 || cp == 0 || cp > 0x10FFFF || (cp >= 0xD800 && cp < 0xE000) ||
+                (cp < 0x20 && cp != '\t' && cp != '\n' && cp != '\r'))
+                return false;
+            append_utf8(out, cp);
+        }
+        else
+            return false;
+        return true;
+    }
+
+    static void append_text(xml_node_t &node, const char *data, size_t n)
+    {
+        if (!node.has_child)
+        {
+            node.has_text = true;
+            node.text.append(data, n);
+        }
+    }
+
+    static void append_utf8(std::string &s, unsigned long cp)
+    {
+        if (cp < 0x80)
+        {
+            s += (char)cp;
+        }
+        else if (cp < 0x800)
+        {
+            s += (char)(0xC0 | (cp >> 6));
+            s += (char)(0x80 | (cp & 0x3F));
+        }
+        else if (cp < 0x10000)
+        {
+            s += (char)(0xE0 | (cp >> 12));
+            s += (char)(0x80 | ((cp >> 6) & 0x3F));
+            s += (char)(0x80 | (cp & 0x3F));
+        }
+        else
+        {
+            s += (char)(0xF0 | (cp >> 18));
+            s += (char)(0x80 | ((cp >> 12) & 0x3F));
+            s += (char)(0x80 | ((cp >> 6) & 0x3F));
+            s += (char)(0x80 | (cp & 0x3F));
+        }
+    }
+
+    // 去掉 BOM，按声明的编码转成 UTF-8，换行统一成 \n(与 expat 相同)，并检查 UTF-8 合法性
+    bool decode(std::string &buf, std::string &error)
+    {
+        if (buf.compare(0, 3, "\xEF\xBB\xBF") == 0)
+        {
+            buf.erase(0, 3);
+        }
+        if (buf.compare(0, 5, "<?xml") == 0)
+        {
+            size_t end = buf.find("?>");
+            size_t enc = buf.find("encoding", 0);
+            if (end != std::string::npos && enc != std::string::npos && enc < end)
+            {
+                size_t q = buf.find_first_of("\"'", enc);
+                size_t q2 = q == std::string::npos ? q : buf.find(buf[q], q + 1);
+                if (q2 != std::string::npos && q2 < end)
+                {
+                    std::string name = buf.substr(q + 1, q2 - q - 1);
+                    for (auto &c : name)
+                        c = tolower(c);
+                    if (name == "iso-8859-1" || name == "latin-1" || name == "latin1")
+                    {
+                        std::string utf8;
+                        utf8.reserve(buf.size());
+                        for (unsigned char c : buf)
+                            append_utf8(utf8, c);
+                        buf.swap(utf8);
+                    }
+                    else if (name != "utf-8" && name != "utf8" && name != "us-ascii" && name != "ascii")
+                    {
+                        error = "unsupported encoding " + name;
+                        return false;
+                    }
+                }
+            }
+        }
+        if (buf.find('\r') != std::string::npos)
+        {
+            size_t w = 0;
+            for (size_t r = 0; r < buf.size(); r++)
+            {
+                if (buf[r] == '\r')
+                {
+                    buf[w++] = '\n';
+                    if (r + 1 < buf.size() && buf[r + 1] == '\n')
+                        r++;
+                }
+                else
+                    buf[w++] = buf[r];
+            }
+            buf.resize(w);
+        }
+        const unsigned char *s = (const unsigned char *)buf.data();
+        for (size_t i = 0; i < buf.size();)
+        {
+            unsigned char c = s[i];
+            int n = c < 0x80 ? 0 : (c >> 5) == 6 ? 1 : (c >> 4) == 14 ? 2 : (c >> 3) == 30 ? 3 : -1;
+            if (n < 0 || i + n >= buf.size() + (n == 0))
+            {
+                begin_ = buf.data();
+                return fail(buf.data() + i, "not well-formed (invalid token)", error);
+            }
+            for (int k = 1; k <= n; k++)
+            {
+                if ((s[i + k] & 0xC0) != 0x80)
+                {
+                    begin_ = buf.data();
+                    return fail(buf.data() + i, "not well-formed (invalid token)", error);
+                }
+            }
+            if (n == 0 && c < 0x20 && c != '\t' && c != '\n')
+            {
+                begin_ = buf.data();
+                return fail(buf.data() + i, "not well-formed (invalid token)", error);
+            }
+            i += n + 1;
+        }
+        return true;
+    }
+
+    bool fail(const char *at, const char *msg, std::string &error)
+    {
+        int line = 1, column = 0;
+        for (const char *c = begin_; c < at; c++)
+        {
+            if (*c == '\n')
+            {
+                line++;
+                column = 0;
+            }
+            else
+            {
+                column++;
+            }
+        }
+        char buf[128];
+        snprintf(buf, sizeof(buf), "%s: line %d, column %d", msg, line, column);
+        error = buf;
+        return false;
+    }
+
+    const char *begin_ = nullptr;
+    const char *p_ = nullptr;
+    const char *end_ = nullptr;
+    bool entity_decl_ = false;
+};
+
+// Element.find：第一个名字匹配的直接子元素
+static const xml_node_t *find(const std::vector<xml_node_t> &nodes, const xml_node_t *parent, const char *name)
+{
+    if (parent == nullptr)
+    {
+        return nullptr;
+    }
+    for (int c = parent->first_child; c >= 0; c = nodes[c].next_sibling)
+    {
+        if (nodes[c].name == name)
+        {
+            return &nodes[c];
+        }
+    }
+    return nullptr;
+}
+
+// ---------------------------------------------------------------- 与 Python 语义对应的提取
+
+// 整数字段绝对值的上限，宽高和面积的计算不会溢出 long long
+static const long long max_int_field = 1LL << 30;
+
+// Python 的 int(str)：去掉首尾空白，可选符号，数字之间允许单个下划线
+// 返回 false 且 unsupported 为 true 表示 Python 能解析而这里不支持：超出 max_int_field，或含非 ASCII 字符
+static bool py_int(const std::string &text, long long &value, bool &unsupported)
+{
+    unsupported = false;
+    for (unsigned char c : text)
+    {
+        if (c >= 0x80)
+        {
+            unsupported = true;
+            break;
+        }
+    }
+    const char *ws = " \t\n\r\v\f\x1c\x1d\x1e\x1f";
+    size_t b = text.find_first_not_of(ws);
+    if (b == std::string::npos)
+    {
+        return false;
+    }
+    size_t e = text.find_last_not_of(ws) + 1;
+    bool neg = false;
+    if (text[b] == '+' || text[b] == '-')
+    {
+        neg = text[b] == '-';
+        b++;
+    }
+    if (b >= e || !isdigit((unsigned char)text[b]) || !isdigit((unsigned char)text[e - 1]))
+    {
+        return false;
+    }
+    long long v = 0;
+    for (size_t i = b; i < e; i++)
+    {
+        if (text[i] == '_' && text[i - 1] != '_')
+        {
+            continue;
+        }
+        if (!isdigit((unsigned char)text[i]))
+        {
+            return false;
+        }
+        v = v > max_int_field ? v : v * 10 + (text[i] - '0');
+    }
+    if (v > max_int_field)
+    {
+        unsupported = true;
+        return false;
+    }
+    value = neg ? -v : v;
+    return true;
+}
+
+struct object_t
+{
+    bool name_null = false;
+    std::string name;
+    bool has_bbox = false; // false 表示 name 之后出错：类别已登记，没有标注
+    long long xmin = 0, ymin = 0, xmax = 0, ymax = 0;
+};
+
+struct file_result_t
+{
+    bool has_image = false;
+    bool filename_null = false;
+    std::string filename;
+    long long width = 0, height = 0;
+    std::vector<object_t> objects;
+    std::string error; // 非空表示出错，已提取的部分仍然合并
+    std::string unsupported; // 非空表示无法保证与 Python 结果相同
+};
+
+static const char *none_attr_text = "'NoneType' object has no attribute 'text'";
+static const char *none_attr_find = "'NoneType' object has no attribute 'find'";
+static const char *none_int = "int() argument must be a string, a bytes-like object or a real number, not 'NoneType'";
+
+// int(elem.find(name).text)
+static bool int_field(const std::vector<xml_node_t> &nodes, const xml_node_t *parent, const char *name, long long &value, file_result_t &out)
+{
+    const xml_node_t *n = find(nodes, parent, name);
+    if (n == nullptr)
+    {
+        out.error = none_attr_text;
+        return false;
+    }
+    if (!n->has_text)
+    {
+        out.error = none_int;
+        return false;
+    }
+    bool unsupported = false;
+    if (!py_int(n->text, value, unsupported))
+    {
+        if (unsupported)
+        {
+            out.unsupported = std::string(name) + " '" + n->text + "' is out of range or not ASCII";
+        }
+        else
+        {
+            out.error = "invalid literal for int() with base 10: '" + n->text + "'";
+        }
+        return false;
+    }
+    return true;
+}
+
+// 与 Python OSError 的格式相同
+static std::string os_error(int err, const std::string &path)
+{
+    char buf[64];
+    snprintf(buf, sizeof(buf), "[Errno %d] ", err);
+    return buf + std::string(strerror(err)) + ": '" + path + "'";
+}
+
+static void convert_file(const std::string &path, file_result_t &out)
+{
+    std::string buf;
+    FILE *fp = fopen(path.c_str(), "rb");
+    if (fp == nullptr)
+    {
+        out.error = os_error(errno, path);
+        return;
+    }
+    char chunk[1 << 16];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), fp)) > 0)
+    {
+        buf.append(chunk, n);
+    }
+    int read_errno = ferror(fp) ? errno : 0;
+    fclose(fp);
+    if (read_errno != 0)
+    {
+        out.error = os_error(read_errno, path);
+        return;
+    }
+
+    std::vector<xml_node_t> nodes;
+    xml_parser parser;
+    bool parsed = parser.parse(buf, nodes, out.error);
+    if (parser.entity_decl())
+    {
+        out.unsupported = "DOCTYPE declares entities";
+    }
+    if (!parsed || !out.unsupported.empty())
+    {
+        return;
+    }
+    const xml_node_t *root = &nodes[0];
+
+    const xml_node_t *filename = find(nodes, root, "filename");
+    if (filename == nullptr)
+    {
+        out.error = none_attr_text;
+        return;
+    }
+    const xml_node_t *size = find(nodes, root, "size");
+    if (size == nullptr)
+    {
+        out.error = none_attr_find;
+        return;
+    }
+    if (!int_field(nodes, size, "width", out.width, out) || !int_field(nodes, size, "height", out.height, out))
+    {
+        return;
+    }
+    out.has_image = true;
+    out.filename_null = !filename->has_text;
+    out.filename = filename->text;
+
+    for (int c = root->first_child; c >= 0; c = nodes[c].next_sibling)
+    {
+        const xml_node_t *obj = &nodes[c];
+        if (obj->name != "object")
+        {
+            continue;
+        }
+        const xml_node_t *name = find(nodes, obj, "name");
+        if (name == nullptr)
+        {
+            out.error = none_attr_text;
+            return;
+        }
+        out.objects.emplace_back();
+        object_t &o = out.objects.back();
+        o.name_null = !name->has_text;
+        o.name = name->text;
+        const xml_node_t *bndbox = find(nodes, obj, "bndbox");
+        if (bndbox == nullptr)
+        {
+            out.error = none_attr_find;
+            return;
+        }
+        if (!int_field(nodes, bndbox, "xmin", o.xmin, out) || !int_field(nodes, bndbox, "ymin", o.ymin, out) ||
+            !int_field(nodes, bndbox, "xmax", o.xmax, out) || !int_field(nodes, bndbox, "ymax", o.ymax, out))
+        {
+            return;
+        }
+        o.has_bbox = true;
+    }
+}
+
+// ---------------------------------------------------------------- 排序
+
+// re.split(r'(\d+)', name) 之后文本段小写、数字段转整数的比较
+static bool natural_less(const std::string &a, const std::string &b)
+{
+    size_t i = 0, j = 0;
+    while (true)
+    {
+        // 文本段
+        size_t ie = i, je = j;
+        while (ie < a.size() && !isdigit((unsigned char)a[ie]))
+            ie++;
+        while (je < b.size() && !isdigit((unsigned char)b[je]))
+            je++;
+        for (; i < ie && j < je; i++, j++)
+        {
+            unsigned char ca = tolower((unsigned char)a[i]), cb = tolower((unsigned char)b[j]);
+            if (ca != cb)
+                return ca < cb;
+        }
+        if (i < ie || j < je)
+            return i == ie;
+        // 两边文本段相同；一边结束时列表较短的更小
+        if (i == a.size() || j == b.size())
+            return i == a.size() && j < b.size();
+        // 数字段：去掉前导零后先比长度再逐位比较
+        while (ie < a.size() && isdigit((unsigned char)a[ie]))
+            ie++;
+        while (je < b.size() && isdigit((unsigned char)b[je]))
+            je++;
+        size_t za = i, zb = j;
+        while (za + 1 < ie && a[za] == '0')
+            za++;
+        while (zb + 1 < je && b[zb] == '0')
+            zb++;
+        if (ie - za != je - zb)
+            return ie - za < je - zb;
+        int cmp = a.compare(za, ie - za, b, zb, je - zb);
+        if (cmp != 0)
+            return cmp < 0;
+        i = ie;
+        j = je;
+    }
+}
+
+// ---------------------------------------------------------------- JSON 输出
+
+// json.dumps(ensure_ascii=True) 的字符串转义
+static void json_string(std::string &out, const std::string &s)
+{
+    out += '"';
+    const unsigned char *p = (const unsigned char *)s.data();
+    const unsigned char *e = p + s.size();
+    char buf[16];
+    while (p < e)
+    {
+        unsigned int c = *p;
+        if (c < 0x80)
+        {
+            p++;
+            switch (c)
+            {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            case '\r':
+                out += "\\r";
+                break;
+            case '\t':
+                out += "\\t";
+                break;
+            case '\b':
+                out += "\\b";
+                break;
+            case '\f':
+                out += "\\f";
+                break;
+            default:
+                if (c < 0x20 || c == 0x7F)
+                {
+                    snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                }
+                else
+                {
+                    out += (char)c;
+                }
+            }
+            continue;
+        }
+        // 输入已经过 UTF-8 检查
+        int n = (c >> 5) == 6 ? 1 : (c >> 4) == 14 ? 2 : 3;
+        unsigned int cp = c & (0x3F >> n);
+        for (int k = 1; k <= n; k++)
+        {
+            cp = (cp << 6) | (p[k] & 0x3F);
+        }
+        p += n + 1;
+        if (cp >= 0x10000)
+        {
+            cp -= 0x10000;
+            snprintf(buf, sizeof(buf), "\\u%04x\\u%04x", 0xD800 | (cp >> 10), 0xDC00 | (cp & 0x3FF));
+        }
+        else
+        {
+            snprintf(buf, sizeof(buf), "\\u%04x", cp);
+        }
+        out += buf;
+    }
+    out += '"';
+}
+
+static void json_name(std::string &out, bool null, const std::string &s)
+{
+    if (null)
+        out += "null";
+    else
+        json_string(out, s);
+}
+
+static void json_int(std::string &out, long long v)
+{
+    char buf[32];
+    out.append(buf, snprintf(buf, sizeof(buf), "%lld", v));
+}
+
+// ---------------------------------------------------------------- main
+
+static double elapsed_s(std::chrono::steady_clock::time_point t0)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+int main(int argc, char *argv[])
+{
+    cmdline::parser parser;
+    parser.add<std::string>("xml_folder", 'x', "VOC xml folder", false, "./img/dst_img");
+    parser.add<std::string>("output", 'o', "output coco json", false, "output_coco.json");
+    parser.add<int>("threads", 'j', "worker threads, 0 means all cores", false, 0);
+    parser.parse_check(argc, argv);
+
+    std::string xml_folder = parser.get<std::string>("xml_folder");
+    std::string output_json = parser.get<std::string>("output");
+    int threads = parser.get<int>("threads");
+    if (threads <= 0)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    DIR *dir = opendir(xml_folder.c_str());
+    if (dir == nullptr)
+    {
+        fprintf(stderr, "open %s failed\n", xml_folder.c_str());
+        return -1;
+    }
+    std::vector<std::string> xml_files;
+    while (struct dirent *ent = readdir(dir))
+    {
+        size_t len = strlen(ent->d_name);
+        if (len >= 4 && strcmp(ent->d_name + len - 4, ".xml") == 0)
+        {
+            xml_files.push_back(ent->d_name);
+        }
+    }
+    closedir(dir);
+    std::stable_sort(xml_files.begin(), xml_files.end(), natural_less);
+
+    std::vector<file_result_t> results(xml_files.size());
+    std::atomic<size_t> next{0};
+    auto work = [&]()
+    {
+        for (size_t i = next++; i < xml_files.size(); i = next++)
+        {
+            convert_file(xml_folder + "/" + xml_files[i], results[i]);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads && (size_t)i < xml_files.size(); i++)
+    {
+        pool.emplace_back(work);
+    }
+    work();
+    for (auto &th : pool)
+    {
+        th.join();
+    }
+    double parse_s = elapsed_s(t0);
+
+    size_t n_unsupported = 0;
+    for (size_t i = 0; i < xml_files.size(); i++)
+    {
+        if (!results[i].unsupported.empty())
+        {
+            fprintf(stderr, "unsupported input %s: %s\n", xml_files[i].c_str(), results[i].unsupported.c_str());
+            n_unsupported++;
+        }
+    }
+    if (n_unsupported > 0)
+    {
+        fprintf(stderr, "%zu file(s) cannot be converted identically to xml2coco.py, use xml2coco.py instead\n", n_unsupported);
+        return -1;
+    }
+
+    // 按排序顺序合并，编号规则与 Python 逐文件处理相同
+    std::string images, annotations, categories;
+    std::map<std::string, int> category_set;
+    int none_category = 0;
+    int n_categories = 0;
+    long long annotation_id = 1;
+    long long image_id = 1;
+    size_t n_images = 0, n_annotations = 0;
+    for (size_t i = 0; i < xml_files.size(); i++)
+    {
+        const file_result_t &r = results[i];
+        if (r.has_image)
+        {
+            images += n_images++ ? ",\n        {\n            \"id\": " : "\n        {\n            \"id\": ";
+            json_int(images, image_id);
+            images += ",\n            \"file_name\": ";
+            json_name(images, r.filename_null, r.filename);
+            images += ",\n            \"width\": ";
+            json_int(images, r.width);
+            images += ",\n            \"height\": ";
+            json_int(images, r.height);
+            images += "\n        }";
+        }
+        for (auto &o : r.objects)
+        {
+            int &category_id = o.name_null ? none_category : category_set[o.name];
+            if (category_id == 0)
+            {
+                category_id = ++n_categories;
+                categories += n_categories > 1 ? ",\n        {\n            \"id\": " : "\n        {\n            \"id\": ";
+                json_int(categories, category_id);
+                categories += ",\n            \"name\": ";
+                json_name(categories, o.name_null, o.name);
+                categories += "\n        }";
+            }
+            if (!o.has_bbox)
+            {
+                continue;
+            }
+            long long w = o.xmax - o.xmin, h = o.ymax - o.ymin;
+            annotations += n_annotations++ ? ",\n        {\n            \"id\": " : "\n        {\n            \"id\": ";
+            json_int(annotations, annotation_id++);
+            annotations += ",\n            \"image_id\": ";
+            json_int(annotations, image_id);
+            annotations += ",\n            \"category_id\": ";
+            json_int(annotations, category_id);
+            annotations += ",\n            \"bbox\": [\n                ";
+            json_int(annotations, o.xmin);
+            annotations += ",\n                ";
+            json_int(annotations, o.ymin);
+            annotations += ",\n                ";
+            json_int(annotations, w);
+            annotations += ",\n                ";
+            json_int(annotations, h);
+            annotations += "\n            ],\n            \"iscrowd\": 0,\n            \"area\": ";
+            json_int(annotations, w * h);
+            annotations += "\n        }";
+        }
+        if (!r.error.empty())
+        {
+            printf("Error processing file %s: %s\n", xml_files[i].c_str(), r.error.c_str());
+        }
+        else
+        {
+            image_id++;
+        }
+    }
+
+    FILE *fp = fopen(output_json.c_str(), "wb");
+    if (fp == nullptr)
+    {
+        printf("Error saving JSON file: [Errno 2] No such file or directory: '%s'\n", output_json.c_str());
+        return -1;
+    }
+    auto section = [&](const char *key, const std::string &items, const char *tail)
+    {
+        fprintf(fp, "    \"%s\": [", key);
+        fwrite(items.data(), 1, items.size(), fp);
+        fputs(items.empty() ? "]" : "\n    ]", fp);
+        fputs(tail, fp);
+    };
+    fputs("{\n", fp);
+    section("images", images, ",\n");
+    section("annotations", annotations, ",\n");
+    section("categories", categories, "\n}");
+    if (fclose(fp) != 0)
+    {
+        printf("Error saving JSON file: write %s failed\n", output_json.c_str());
+        return -1;
+    }
+    printf("Converted VOC to COCO format. Output saved to %s\n", output_json.c_str());
+    fprintf(stderr, "%zu files, %zu images, %zu annotations, %d categories: parse %.2fs (%d threads), total %.2fs\n",
+            xml_files.size(), n_images, n_annotations, n_categories, parse_s, threads, elapsed_s(t0));
+    return 0;
+}
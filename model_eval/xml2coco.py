@@ -1,3 +1,4 @@
+# 大量标注请用 C++ 并行版本(输出逐字节相同，遇到它不支持的输入会列出文件并退出)：make && ./xml2coco -x ./img/dst_img -o output_coco.json
 import os
 import json
 import xml.etree.ElementTree as ET
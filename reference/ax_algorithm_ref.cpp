@@ -0,0 +1,946 @@
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ax_algorithm_sdk.h"
+#include "json_lite.hpp"
+#include "plate_vocab.h"
+
+/**
+ * ax_algorithm_sdk.h 的 CPU 参考实现，用于在 x86 主机上编译、调试、压测 NPU 之外的代码。
+ * 不做任何真实推理：检测结果从 COCO 标注/结果文件按帧回放，没有回放文件时生成确定性的合成目标；
+ * 跟踪、车牌、人脸特征、人体属性都由确定性规则产生，同样的输入序列总是得到同样的输出。
+ *
+ * 环境变量：
+ *   AX_REF_REPLAY           回放文件(COCO 标注或结果列表)，model_file 以 .json 结尾时优先使用 model_file
+ *   AX_REF_LATENCY_US       每次 detect/track 的模拟 NPU 耗时，默认 0
+ *   AX_REF_ATTR_LATENCY_US  每次 get_body_attr/get_face_feature 的模拟耗时，默认 0
+ *   AX_REF_INIT_MS          ax_algorithm_init 的模拟耗时，默认 0
+ *   AX_REF_NPU_CORES        可同时执行的模拟推理数，模拟 NPU 的并发上限，0 表示不限，默认 1
+ * 模拟耗时用 sleep 实现，与真实 NPU 一样不占用 CPU。
+ */
+
+namespace
+{
+    std::atomic<int> g_log_level{ax_log_warn};
+
+    void log_print(int level, const char *fmt, ...)
+    {
+        if (level > g_log_level.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+        va_list ap;
+        va_start(ap, fmt);
+        fprintf(stderr, "[ax_algorithm_ref] ");
+        vfprintf(stderr, fmt, ap);
+        fprintf(stderr, "\n");
+        va_end(ap);
+    }
+
+    int env_int(const char *name, int def)
+    {
+        const char *v = getenv(name);
+        return (v != nullptr && *v) ? atoi(v) : def;
+    }
+
+    struct config_t
+    {
+        int latency_us;
+        int attr_latency_us;
+        int init_ms;
+        int npu_cores;
+        std::string replay;
+    };
+
+    const config_t &config()
+    {
+        static config_t c = []()
+        {
+            config_t c;
+            c.latency_us = env_int("AX_REF_LATENCY_US", 0);
+            c.attr_latency_us = env_int("AX_REF_ATTR_LATENCY_US", 0);
+            c.init_ms = env_int("AX_REF_INIT_MS", 0);
+            c.npu_cores = env_int("AX_REF_NPU_CORES", 1);
+            const char *replay = getenv("AX_REF_REPLAY");
+            c.replay = replay ? replay : "";
+            return c;
+        }();
+        return c;
+    }
+
+    // 模拟 NPU：最多 npu_cores 个推理同时进行，其余排队
+    class npu_t
+    {
+    public:
+        void run(int us)
+        {
+            if (us <= 0)
+            {
+                return;
+            }
+            int cores = config().npu_cores;
+            if (cores > 0)
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [&]()
+                         { return busy_ < cores; });
+                busy_++;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(us));
+            if (cores > 0)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                busy_--;
+                cv_.notify_one();
+            }
+        }
+
+    private:
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        int busy_ = 0;
+    };
+
+    npu_t &npu()
+    {
+        static npu_t n;
+        return n;
+    }
+
+    inline unsigned long long mix(unsigned long long x)
+    {
+        // splitmix64
+        x += 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+    inline float unit(unsigned long long x)
+    {
+        return (mix(x) >> 40) / (float)(1 << 24);
+    }
+
+    float iou(const ax_bbox_t &a, const ax_bbox_t &b)
+    {
+        float x0 = std::max(a.x, b.x), y0 = std::max(a.y, b.y);
+        float x1 = std::min(a.x + a.w, b.x + b.w), y1 = std::min(a.y + a.h, b.y + b.h);
+        if (x1 <= x0 || y1 <= y0)
+        {
+            return 0;
+        }
+        float inter = (x1 - x0) * (y1 - y0);
+        return inter / (a.w * a.h + b.w * b.h - inter);
+    }
+
+    // 回放数据：每帧一组目标，坐标相对于 width x height 的原图
+    struct replay_object_t
+    {
+        ax_bbox_t bbox;
+        float score;
+        int label;
+    };
+
+    struct replay_frame_t
+    {
+        float width, height; // 0 表示未知，不缩放
+        std::vector<replay_object_t> objects;
+    };
+
+    typedef std::vector<replay_frame_t> replay_t;
+
+    void add_object(replay_frame_t &frame, const json_lite::value &v)
+    {
+        const json_lite::value &bbox = v["bbox"];
+        if (bbox.size() != 4)
+        {
+            return;
+        }
+        replay_object_t o;
+        o.bbox.x = bbox.at(0).number();
+        o.bbox.y = bbox.at(1).number();
+        o.bbox.w = bbox.at(2).number();
+        o.bbox.h = bbox.at(3).number();
+        o.score = v.get("score", 1.0);
+        o.label = (int)v.get("category_id", 0);
+        frame.objects.push_back(o);
+    }
+
+    /**
+     * 支持两种格式，帧按 image_id 升序排列：
+     * - COCO 标注 {"images": [...], "annotations": [...]}，images 中有 width/height 时按输入图像尺寸缩放
+     * - COCO 结果列表 [{"image_id", "category_id", "bbox", "score"}, ...]
+     */
+    bool load_replay(const std::string &path, replay_t &replay)
+    {
+        json_lite::value root;
+        std::string error;
+        if (!json_lite::parse_file(path, root, &error))
+        {
+            log_print(ax_log_error, "load replay failed: %s", error.c_str());
+            return false;
+        }
+
+        std::map<long long, replay_frame_t> frames;
+        const json_lite::value *annotations = &root;
+        if (root.is_object())
+        {
+            for (auto &img : root["images"].array())
+            {
+                replay_frame_t &f = frames[(long long)img.get("id", 0)];
+                f.width = img.get("width", 0);
+                f.height = img.get("height", 0);
+            }
+            annotations = &root["annotations"];
+        }
+        if (!annotations->is_array())
+        {
+            log_print(ax_log_error, "%s: no annotations", path.c_str());
+            return false;
+        }
+        for (auto &a : annotations->array())
+        {
+            add_object(frames[(long long)a.get("image_id", 0)], a);
+        }
+        for (auto &kv : frames)
+        {
+            replay.push_back(kv.second);
+        }
+        log_print(ax_log_info, "replay %s: %d frames", path.c_str(), (int)replay.size());
+        return true;
+    }
+
+    // 同一个回放文件被多个句柄共享，只解析一次
+    std::shared_ptr<const replay_t> get_replay(const std::string &path)
+    {
+        static std::mutex mutex;
+        static std::map<std::string, std::weak_ptr<const replay_t>> cache;
+        std::lock_guard<std::mutex> lock(mutex);
+        auto sp = cache[path].lock();
+        if (sp)
+        {
+            return sp;
+        }
+        auto replay = std::make_shared<replay_t>();
+        if (!load_replay(path, *replay))
+        {
+            return nullptr;
+        }
+        cache[path] = replay;
+        return replay;
+    }
+
+    struct track_t
+    {
+        unsigned long id;
+        ax_bbox_t bbox;
+        int label;
+        int lost;
+        bool plate_seen;
+    };
+
+    struct handle_t
+    {
+        ax_model_type_e model_type;
+        std::mutex mutex; // 保护以下所有成员
+        ax_algorithm_param_t param;
+        std::shared_ptr<const replay_t> replay;
+        long long frame = 0;
+        std::vector<track_t> tracks;
+        unsigned long next_track_id = 1;
+        bool save_debug = false;
+    };
+
+    enum
+    {
+        synthetic_objects = 4,
+        track_max_lost = 30,
+    };
+    const float track_iou = 0.3f;
+
+    handle_t *to_handle(ax_algorithm_handle_t handle)
+    {
+        return static_cast<handle_t *>(handle);
+    }
+
+    bool valid_image(const ax_image_t *image)
+    {
+        return image != nullptr && image->pVir != nullptr && image->nWidth > 0 && image->nHeight > 0 &&
+               image->eDtype >= ax_color_space_nv12 && image->eDtype <= ax_color_space_rgb;
+    }
+
+    int image_stride(const ax_image_t *image)
+    {
+        return image->tStride_W > 0 ? image->tStride_W : (int)image->nWidth;
+    }
+
+    // 图像 (x, y) 处的亮度，坐标会被截断到图像内
+    int luma(const ax_image_t *image, int x, int y)
+    {
+        x = std::min(std::max(x, 0), (int)image->nWidth - 1);
+        y = std::min(std::max(y, 0), (int)image->nHeight - 1);
+        const unsigned char *p = (const unsigned char *)image->pVir;
+        int stride = image_stride(image);
+        if (image->eDtype == ax_color_space_nv12 || image->eDtype == ax_color_space_nv21)
+        {
+            return p[(size_t)y * stride + x];
+        }
+        p += ((size_t)y * stride + x) * 3;
+        return (p[0] + 2 * p[1] + p[2]) >> 2;
+    }
+
+    // bbox 内 8x8 网格采样的亮度，用来让人脸特征、人体属性跟随图像内容
+    enum
+    {
+        patch_size = 8,
+    };
+
+    void sample_patch(const ax_image_t *image, const ax_bbox_t &bbox, float patch[patch_size * patch_size])
+    {
+        for (int j = 0; j < patch_size; j++)
+        {
+            for (int i = 0; i < patch_size; i++)
+            {
+                int x = (int)(bbox.x + bbox.w * (i + 0.5f) / patch_size);
+                int y = (int)(bbox.y + bbox.h * (j + 0.5f) / patch_size);
+                patch[j * patch_size + i] = luma(image, x, y);
+            }
+        }
+    }
+
+    float det_threshold(const handle_t *h)
+    {
+        switch (h->model_type)
+        {
+        case ax_model_type_person_detection:
+            return h->param.person_param.det_threshold;
+        case ax_model_type_lpr:
+            return h->param.vehicle_param.det_threshold;
+        case ax_model_type_face_detection:
+        case ax_model_type_face_recognition:
+            return h->param.face_param.det_threshold;
+        case ax_model_type_fire_smoke:
+            return h->param.fire_smoke_param.det_threshold;
+        default:
+            return 0;
+        }
+    }
+
+    /**
+     * 生成当前帧的原始检测结果(图像坐标)。
+     * 合成模式下固定几个目标在画面中缓慢移动，周期性消失再出现，便于观察跟踪和轨迹结束
+     */
+    void generate(handle_t *h, const ax_image_t *image, std::vector<replay_object_t> &objects)
+    {
+        long long frame = h->frame++;
+        objects.clear();
+        if (h->replay && !h->replay->empty())
+        {
+            const replay_frame_t &f = (*h->replay)[frame % h->replay->size()];
+            float sx = f.width > 0 ? image->nWidth / f.width : 1.0f;
+            float sy = f.height > 0 ? image->nHeight / f.height : 1.0f;
+            for (auto o : f.objects)
+            {
+                o.bbox.x *= sx;
+                o.bbox.w *= sx;
+                o.bbox.y *= sy;
+                o.bbox.h *= sy;
+                objects.push_back(o);
+            }
+        }
+        else
+        {
+            for (int k = 0; k < synthetic_objects; k++)
+            {
+                unsigned long long seed = (unsigned long long)h->model_type * 131 + k;
+                if ((frame / 50 + k) % 5 == 0)
+                {
+                    continue;
+                }
+                float w = 0.08f + 0.1f * unit(seed * 3 + 1);
+                float hh = h->model_type == ax_model_type_person_detection ? w * 2.5f : w;
+                float speed = 0.002f * (1 + k);
+                float cx = fmodf(unit(seed * 3 + 2) + speed * frame, 1.0f);
+                float cy = 0.2f + 0.6f * unit(seed * 3 + 3);
+                replay_object_t o;
+                o.bbox.w = w * image->nWidth;
+                o.bbox.h = std::min(hh * image->nWidth, image->nHeight * 0.5f);
+                o.bbox.x = (cx * (1 - w)) * image->nWidth;
+                o.bbox.y = std::min(cy * image->nHeight, image->nHeight - o.bbox.h);
+                o.score = 0.6f + 0.4f * unit(seed * 7 + frame);
+                o.label = h->model_type == ax_model_type_fire_smoke ? k % 2 : 0;
+                objects.push_back(o);
+            }
+        }
+
+        float threshold = det_threshold(h);
+        objects.erase(std::remove_if(objects.begin(), objects.end(), [&](const replay_object_t &o)
+                                     { return o.score < threshold; }),
+                      objects.end());
+        std::stable_sort(objects.begin(), objects.end(), [](const replay_object_t &a, const replay_object_t &b)
+                         { return a.score > b.score; });
+        if (objects.size() > AX_ALGORITHM_MAX_OBJ_NUM)
+        {
+            objects.resize(AX_ALGORITHM_MAX_OBJ_NUM);
+        }
+    }
+
+    // 贪心 IoU 匹配，返回每个检测对应的跟踪下标，新目标创建新的跟踪
+    std::vector<int> associate(handle_t *h, const std::vector<replay_object_t> &objects)
+    {
+        struct pair_t
+        {
+            float iou;
+            int det, track;
+        };
+        std::vector<pair_t> pairs;
+        for (int d = 0; d < (int)objects.size(); d++)
+        {
+            for (int t = 0; t < (int)h->tracks.size(); t++)
+            {
+                if (h->tracks[t].label != objects[d].label)
+                {
+                    continue;
+                }
+                float v = iou(objects[d].bbox, h->tracks[t].bbox);
+                if (v >= track_iou)
+                {
+                    pairs.push_back({v, d, t});
+                }
+            }
+        }
+        std::stable_sort(pairs.begin(), pairs.end(), [](const pair_t &a, const pair_t &b)
+                         { return a.iou > b.iou; });
+
+        std::vector<int> det_track(objects.size(), -1);
+        std::vector<bool> track_used(h->tracks.size(), false);
+        for (auto &p : pairs)
+        {
+            if (det_track[p.det] < 0 && !track_used[p.track])
+            {
+                det_track[p.det] = p.track;
+                track_used[p.track] = true;
+            }
+        }
+        for (size_t t = 0; t < track_used.size(); t++)
+        {
+            if (!track_used[t])
+            {
+                h->tracks[t].lost++;
+            }
+        }
+        for (size_t d = 0; d < objects.size(); d++)
+        {
+            if (det_track[d] < 0)
+            {
+                track_t t;
+                t.id = h->next_track_id++;
+                t.label = objects[d].label;
+                t.plate_seen = false;
+                det_track[d] = h->tracks.size();
+                h->tracks.push_back(t);
+            }
+            track_t &t = h->tracks[det_track[d]];
+            t.bbox = objects[d].bbox;
+            t.lost = 0;
+        }
+        return det_track;
+    }
+
+    // 删除丢失太久的跟踪，会使 associate 返回的下标失效
+    void prune_tracks(handle_t *h)
+    {
+        h->tracks.erase(std::remove_if(h->tracks.begin(), h->tracks.end(), [](const track_t &t)
+                                       { return t.lost > track_max_lost; }),
+                        h->tracks.end());
+    }
+
+    void make_plate(unsigned long long seed, int *plate_id, int *len)
+    {
+        plate_id[0] = mix(seed) % plate_vocab::n_province;
+        plate_id[1] = plate_vocab::first_letter + mix(seed + 1) % (plate_vocab::size - plate_vocab::first_letter);
+        for (int i = 2; i < 7; i++)
+        {
+            plate_id[i] = plate_vocab::first_digit + mix(seed + i) % (plate_vocab::size - plate_vocab::first_digit);
+        }
+        *len = 7;
+    }
+
+    void fill_object(handle_t *h, ax_result_t *result, int i, const replay_object_t &o, track_t *track, long long frame)
+    {
+        auto &obj = result->objects[i];
+        memset(&obj, 0, sizeof(obj));
+        obj.bbox = o.bbox;
+        obj.score = o.score;
+        obj.label = o.label;
+        obj.track_id = track ? track->id : 0;
+        // 没有跟踪时用帧号和序号作为属性的种子
+        unsigned long long seed = track ? track->id : mix(frame) + i;
+
+        switch (h->model_type)
+        {
+        case ax_model_type_face_detection:
+        case ax_model_type_face_recognition:
+        {
+            static const float pts[AX_ALGORITHM_FACE_POINT_LEN][2] = {{0.3f, 0.4f}, {0.7f, 0.4f}, {0.5f, 0.6f}, {0.35f, 0.8f}, {0.65f, 0.8f}};
+            obj.face_info.quality = 0.5f + 0.5f * unit(seed * 31 + frame / 25);
+            for (int p = 0; p < AX_ALGORITHM_FACE_POINT_LEN; p++)
+            {
+                obj.face_info.points[p].x = o.bbox.x + o.bbox.w * pts[p][0];
+                obj.face_info.points[p].y = o.bbox.y + o.bbox.h * pts[p][1];
+            }
+        }
+        break;
+        case ax_model_type_person_detection:
+            obj.person_info.status = mix(seed) % 3;
+            break;
+        case ax_model_type_fire_smoke:
+            obj.fire_smoke_info.label = o.label;
+            break;
+        case ax_model_type_lpr:
+        {
+            auto &v = obj.vehicle_info;
+            v.cartype = 1 + mix(seed * 17) % 5;
+            // 跟踪时每 4 帧有一帧"识别失败"，用来覆盖 b_is_track_plate 的路径
+            bool recognised = unit(seed * 13 + frame) >= 0.25f && o.score >= h->param.vehicle_param.lpr_threshold;
+            if (recognised || (track && track->plate_seen))
+            {
+                make_plate(seed * 1000003, v.plate_id, &v.len_plate_id);
+                v.b_is_track_plate = recognised ? 0 : 1;
+                if (track)
+                {
+                    track->plate_seen = true;
+                }
+            }
+        }
+        break;
+        default:
+            break;
+        }
+    }
+
+    void save_debug_image(const ax_image_t *image, long long frame)
+    {
+        char path[64];
+        bool yuv = image->eDtype == ax_color_space_nv12 || image->eDtype == ax_color_space_nv21;
+        snprintf(path, sizeof(path), "ax_ref_debug_%06lld.%s", frame, yuv ? "pgm" : "ppm");
+        FILE *fp = fopen(path, "wb");
+        if (fp == nullptr)
+        {
+            return;
+        }
+        int channels = yuv ? 1 : 3;
+        fprintf(fp, "P%d\n%u %u\n255\n", yuv ? 5 : 6, image->nWidth, image->nHeight);
+        const unsigned char *p = (const unsigned char *)image->pVir;
+        for (unsigned int y = 0; y < image->nHeight; y++)
+        {
+            fwrite(p + (size_t)y * image_stride(image) * channels, 1, (size_t)image->nWidth * channels, fp);
+        }
+        fclose(fp);
+    }
+
+    int run(ax_algorithm_handle_t handle, ax_image_t *image, ax_result_t *result, bool tracking)
+    {
+        handle_t *h = to_handle(handle);
+        if (h == nullptr || result == nullptr)
+        {
+            return ax_error_code_fail;
+        }
+        if (h->model_type == ax_model_type_person_attr)
+        {
+            return ax_error_code_run_type_not_match;
+        }
+        if (!valid_image(image))
+        {
+            return ax_error_code_run_fail;
+        }
+
+        npu().run(config().latency_us);
+
+        std::lock_guard<std::mutex> lock(h->mutex);
+        long long frame = h->frame;
+        std::vector<replay_object_t> objects;
+        generate(h, image, objects);
+        if (h->save_debug)
+        {
+            save_debug_image(image, frame);
+        }
+
+        std::vector<int> tracks;
+        if (tracking)
+        {
+            tracks = associate(h, objects);
+        }
+        memset(result, 0, sizeof(ax_result_t));
+        result->model_type = h->model_type;
+        result->n_objects = objects.size();
+        for (int i = 0; i < result->n_objects; i++)
+        {
+            fill_object(h, result, i, objects[i], tracking ? &h->tracks[tracks[i]] : nullptr, frame);
+        }
+        if (tracking)
+        {
+            prune_tracks(h);
+        }
+        return ax_error_code_success;
+    }
+
+    // 固定的 512x(64+1) 随机投影矩阵，最后一列是常数项，保证纯色图像也有非零特征
+    const std::vector<float> &projection()
+    {
+        static std::vector<float> m = []()
+        {
+            const int cols = patch_size * patch_size + 1;
+            std::vector<float> m((size_t)AX_ALGORITHM_FACE_FEATURE_LEN * cols);
+            for (size_t i = 0; i < m.size(); i++)
+            {
+                m[i] = unit(i) * 2 - 1;
+            }
+            return m;
+        }();
+        return m;
+    }
+}
+
+extern "C"
+{
+    int ax_algorithm_init(ax_algorithm_init_t *init_info, ax_algorithm_handle_t *handle)
+    {
+        if (init_info == nullptr || handle == nullptr)
+        {
+            return ax_error_code_init_fail;
+        }
+        if (init_info->model_type < 0 || init_info->model_type >= ax_model_type_end)
+        {
+            log_print(ax_log_error, "invalid model type %d", init_info->model_type);
+            return ax_error_code_init_fail;
+        }
+        struct stat st;
+        if (stat(init_info->model_file, &st) != 0)
+        {
+            log_print(ax_log_error, "model file %s not found", init_info->model_file);
+            return ax_error_code_init_model_fail;
+        }
+
+        std::unique_ptr<handle_t> h(new handle_t());
+        h->model_type = init_info->model_type;
+        h->param = init_info->param;
+
+        std::string model_file = init_info->model_file;
+        std::string replay = config().replay;
+        if (model_file.size() > 5 && model_file.compare(model_file.size() - 5, 5, ".json") == 0)
+        {
+            replay = model_file;
+        }
+        if (!replay.empty())
+        {
+            h->replay = get_replay(replay);
+            if (!h->replay)
+            {
+                return ax_error_code_init_model_fail;
+            }
+        }
+
+        if (config().init_ms > 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(config().init_ms));
+        }
+        log_print(ax_log_info, "init model type %d, %s", h->model_type, replay.empty() ? "synthetic" : replay.c_str());
+        *handle = h.release();
+        return ax_error_code_success;
+    }
+
+    void ax_algorithm_deinit(ax_algorithm_handle_t handle)
+    {
+        delete to_handle(handle);
+    }
+
+    int ax_algorithm_detect(ax_algorithm_handle_t handle, ax_image_t *image, ax_result_t *result)
+    {
+        return run(handle, image, result, false);
+    }
+
+    int ax_algorithm_track(ax_algorithm_handle_t handle, ax_image_t *image, ax_result_t *result)
+    {
+        return run(handle, image, result, true);
+    }
+
+    ax_model_type_e ax_algorithm_get_model_type(ax_algorithm_handle_t handle)
+    {
+        handle_t *h = to_handle(handle);
+        return h ? h->model_type : ax_model_type_end;
+    }
+
+    ax_algorithm_param_t ax_algorithm_get_param(ax_algorithm_handle_t handle)
+    {
+        handle_t *h = to_handle(handle);
+        if (h == nullptr)
+        {
+            return ax_algorithm_get_default_param();
+        }
+        std::lock_guard<std::mutex> lock(h->mutex);
+        return h->param;
+    }
+
+    void ax_algorithm_set_param(ax_algorithm_handle_t handle, ax_algorithm_param_t *param)
+    {
+        handle_t *h = to_handle(handle);
+        if (h == nullptr || param == nullptr)
+        {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(h->mutex);
+        h->param = *param;
+    }
+
+    ax_algorithm_param_t ax_algorithm_get_default_param()
+    {
+        ax_algorithm_param_t param;
+        param.face_param.det_threshold = 0.5f;
+        param.face_param.quality_threshold = 0.3f;
+        param.person_param.det_threshold = 0.5f;
+        param.vehicle_param.det_threshold = 0.5f;
+        param.vehicle_param.lpr_threshold = 0.5f;
+        param.fire_smoke_param.det_threshold = 0.4f;
+        return param;
+    }
+
+    void ax_algorithm_set_log_level(ax_log_level_e level)
+    {
+        g_log_level.store(level);
+    }
+
+    void ax_algorithm_save_debug_image(ax_algorithm_handle_t handle, int enable)
+    {
+        handle_t *h = to_handle(handle);
+        if (h == nullptr)
+        {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(h->mutex);
+        h->save_debug = enable != 0;
+    }
+
+    int ax_algorithm_get_plate_str(int *plate_id, int len, char *plate_str)
+    {
+        if (plate_id == nullptr || plate_str == nullptr || len < 0 || len > 16)
+        {
+            return ax_error_code_fail;
+        }
+        std::string s;
+        for (int i = 0; i < len; i++)
+        {
+            if (plate_id[i] < 0 || plate_id[i] >= plate_vocab::size)
+            {
+                plate_str[0] = 0;
+                return ax_error_code_fail;
+            }
+            s += plate_vocab::chars[plate_id[i]];
+        }
+        memcpy(plate_str, s.c_str(), s.size() + 1);
+        return ax_error_code_success;
+    }
+
+    int ax_algorithm_get_body_attr(ax_algorithm_handle_t handle, ax_image_t *image, ax_bbox_t *bbox, ax_body_attr_t *body_attr)
+    {
+        // 每个属性的取值个数，与 ax_body_attr_t 中的注释一致
+        static const unsigned char n_values[] = {3, 6, 3, 5, 3, 4, 4, 3, 3, 3, 3, 3, 3, 12, 10, 5, 4, 3, 3, 5, 12, 5, 3, 4, 5};
+        static_assert(sizeof(n_values) == offsetof(ax_body_attr_t, orientation) + 1 - offsetof(ax_body_attr_t, isHuman), "attribute count");
+
+        handle_t *h = to_handle(handle);
+        if (h == nullptr || bbox == nullptr || body_attr == nullptr)
+        {
+            return ax_error_code_fail;
+        }
+        if (h->model_type != ax_model_type_person_attr)
+        {
+            return ax_error_code_run_type_not_match;
+        }
+        if (!valid_image(image))
+        {
+            return ax_error_code_run_fail;
+        }
+        if (bbox->w < 1 || bbox->h < 1 || bbox->x >= image->nWidth || bbox->y >= image->nHeight || bbox->x + bbox->w <= 0 || bbox->y + bbox->h <= 0)
+        {
+            return ax_error_code_run_roi_fail;
+        }
+
+        npu().run(config().attr_latency_us);
+
+        // 有 track_id 时属性只由 track_id 决定(模拟历史状态平滑)，否则由图像内容决定
+        unsigned long long seed = body_attr->track_id;
+        if (seed == 0)
+        {
+            float patch[patch_size * patch_size];
+            sample_patch(image, *bbox, patch);
+            for (float v : patch)
+            {
+                seed = mix(seed ^ ((int)v >> 5));
+            }
+        }
+        unsigned char *attrs = &body_attr->isHuman;
+        for (size_t i = 0; i < sizeof(n_values); i++)
+        {
+            attrs[i] = 1 + mix(seed * 64 + i) % (n_values[i] - 1);
+        }
+        return ax_error_code_success;
+    }
+
+    int ax_algorithm_get_face_feature(ax_algorithm_handle_t handle, ax_image_t *image, ax_result_t *result, int idx, float feature[AX_ALGORITHM_FACE_FEATURE_LEN])
+    {
+        handle_t *h = to_handle(handle);
+        if (h == nullptr || result == nullptr || feature == nullptr)
+        {
+            return ax_error_code_fail;
+        }
+        if (h->model_type != ax_model_type_face_recognition)
+        {
+            return ax_error_code_run_type_not_match;
+        }
+        if (!valid_image(image))
+        {
+            return ax_error_code_run_fail;
+        }
+        if (idx == -1)
+        {
+            int ret = run(handle, image, result, false);
+            if (ret != ax_error_code_success)
+            {
+                return ret;
+            }
+            if (result->n_objects == 0)
+            {
+                return ax_error_code_run_det_fail;
+            }
+            idx = 0; // 按分数排序，取最可信的人脸
+        }
+        if (idx < 0 || idx >= result->n_objects)
+        {
+            return ax_error_code_run_invalid_index;
+        }
+        float quality_threshold = ax_algorithm_get_param(handle).face_param.quality_threshold;
+        if (result->objects[idx].face_info.quality < quality_threshold)
+        {
+            return ax_error_code_run_quality_fail;
+        }
+
+        npu().run(config().attr_latency_us);
+
+        // 人脸区域亮度去均值后做固定随机投影，相似的图像得到相近的特征
+        const int cols = patch_size * patch_size + 1;
+        float v[cols];
+        sample_patch(image, result->objects[idx].bbox, v);
+        float mean = 0;
+        for (int i = 0; i < cols - 1; i++)
+        {
+            mean += v[i];
+        }
+        mean /= cols - 1;
+        for (int i = 0; i < cols - 1; i++)
+        {
+            v[i] = (v[i] - mean) / 128.0f;
+        }
+        v[cols - 1] = 0.1f;
+
+        const std::vector<float> &m = projection();
+        float norm = 0;
+        for (int j = 0; j < AX_ALGORITHM_FACE_FEATURE_LEN; j++)
+        {
+            const float *row = m.data() + (size_t)j * cols;
+            float s = 0;
+            for (int i = 0; i < cols; i++)
+            {
+                s += row[i] * v[i];
+            }
+            feature[j] = s;
+            norm += s * s;
+        }
+        norm = sqrtf(norm);
+        for (int j = 0; j < AX_ALGORITHM_FACE_FEATURE_LEN; j++)
+        {
+            feature[j] /= norm;
+        }
+        return ax_error_code_success;
+    }
+
+    float ax_algorithm_face_compare(float a[AX_ALGORITHM_FACE_FEATURE_LEN], float b[AX_ALGORITHM_FACE_FEATURE_LEN])
+    {
+        float dot = 0, na = 0, nb = 0;
+        for (int i = 0; i < AX_ALGORITHM_FACE_FEATURE_LEN; i++)
+        {
+            dot += a[i] * b[i];
+            na += a[i] * a[i];
+            nb += b[i] * b[i];
+        }
+        return (na > 0 && nb > 0) ? dot / sqrtf(na * nb) : 0;
+    }
+
+    int ax_create_image(int width, int height, int stride, ax_color_space_e color, ax_image_t *image)
+    {
+        if (image == nullptr || width <= 0 || height <= 0)
+        {
+            return ax_error_code_fail;
+        }
+        if (stride < width)
+        {
+            stride = width;
+        }
+        size_t size;
+        switch (color)
+        {
+        case ax_color_space_nv12:
+        case ax_color_space_nv21:
+            size = (size_t)stride * height * 3 / 2;
+            break;
+        case ax_color_space_bgr:
+        case ax_color_space_rgb:
+            size = (size_t)stride * height * 3;
+            break;
+        default:
+            return ax_error_code_fail;
+        }
+        void *p = nullptr;
+        if (posix_memalign(&p, 128, size) != 0)
+        {
+            return ax_error_code_fail;
+        }
+        memset(image, 0, sizeof(ax_image_t));
+        image->pVir = p;
+        image->pPhy = (unsigned long long)(uintptr_t)p;
+        image->nSize = size;
+        image->nWidth = width;
+        image->nHeight = height;
+        image->eDtype = color;
+        image->tStride_W = stride;
+        return ax_error_code_success;
+    }
+
+    void ax_release_image(ax_image_t *image)
+    {
+        if (image == nullptr)
+        {
+            return;
+        }
+        free(image->pVir);
+        image->pVir = nullptr;
+        image->pPhy = 0;
+    }
+}
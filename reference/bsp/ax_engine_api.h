@@ -0,0 +1,22 @@
+#ifndef __AX_ENGINE_API_REF_H__
+#define __AX_ENGINE_API_REF_H__
+
+#include "ax_sys_api.h"
+
+typedef enum
+{
+    AX_ENGINE_VIRTUAL_NPU_DISABLE = 0,
+    AX_ENGINE_VIRTUAL_NPU_STD = 1,
+    AX_ENGINE_VIRTUAL_NPU_BIG_LITTLE = 2,
+} AX_ENGINE_NPU_MODE_T;
+
+typedef struct
+{
+    AX_ENGINE_NPU_MODE_T eHardMode;
+    unsigned int reserve[8];
+} AX_ENGINE_NPU_ATTR_T;
+
+static inline AX_S32 AX_ENGINE_Init(AX_ENGINE_NPU_ATTR_T *pNpuAttr) { return 0; }
+static inline AX_S32 AX_ENGINE_Deinit(void) { return 0; }
+
+#endif
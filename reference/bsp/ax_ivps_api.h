@@ -0,0 +1,9 @@
+#ifndef __AX_IVPS_API_REF_H__
+#define __AX_IVPS_API_REF_H__
+
+#include "ax_sys_api.h"
+
+static inline AX_S32 AX_IVPS_Init(void) { return 0; }
+static inline AX_S32 AX_IVPS_Deinit(void) { return 0; }
+
+#endif
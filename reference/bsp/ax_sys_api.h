@@ -0,0 +1,13 @@
+#ifndef __AX_SYS_API_REF_H__
+#define __AX_SYS_API_REF_H__
+
+/**
+ * 主机构建用的 BSP 替身，只提供 example 用到的接口，全部为空操作。
+ * 设备构建使用 SDK msp/out/include 中的真实头文件。
+ */
+typedef int AX_S32;
+
+static inline AX_S32 AX_SYS_Init(void) { return 0; }
+static inline AX_S32 AX_SYS_Deinit(void) { return 0; }
+
+#endif
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstring>
+#include <string>
+
+/**
+ * 参考后端使用的车牌字符表：0~30 省份简称，31~40 数字，41~64 字母(不含 I、O)。
+ * 设备上 libax_algorithm 的编号由模型决定，与这里不一定相同，主机侧只保证自洽。
+ */
+namespace plate_vocab
+{
+    enum
+    {
+        n_province = 31,
+        first_digit = 31,
+        first_letter = 41,
+        size = 65,
+    };
+
+    static const char *const chars[size] = {
+        "京", "津", "沪", "渝", "冀", "豫", "云", "辽", "黑", "湘", "皖", "鲁", "新", "苏", "浙", "赣",
+        "鄂", "桂", "甘", "晋", "蒙", "陕", "吉", "闽", "贵", "粤", "青", "藏", "川", "宁", "琼",
+        "0", "1", "2", "3", "4", "5", "6", "7", "8", "9",
+        "A", "B", "C", "D", "E", "F", "G", "H", "J", "K", "L", "M", "N", "P", "Q", "R",
+        "S", "T", "U", "V", "W", "X", "Y", "Z"};
+
+    // 从 text 开头匹配一个字符，返回编号并前移 text，无法识别时跳过一个 UTF-8 字符并返回 -1
+    static inline int next_id(const char *&text)
+    {
+        for (int i = 0; i < size; i++)
+        {
+            size_t n = strlen(chars[i]);
+            if (strncmp(text, chars[i], n) == 0)
+            {
+                text += n;
+                return i;
+            }
+        }
+        text++;
+        while ((*text & 0xC0) == 0x80)
+        {
+            text++;
+        }
+        return -1;
+    }
+}
@@ -0,0 +1,159 @@
+#include <cmath>
+#include <vector>
+
+#include "putTextPlate.h"
+#include "plate_vocab.h"
+
+/**
+ * putTextPlate.h 的参考实现：数字和字母用 5x7 点阵，省份汉字用 7x7 的确定性方块图案代替。
+ * 排版与 OpenCV putText 一致，org 为第一个字符的左下角；fontScale 为 1 时字高 21 像素。
+ * 3 通道图像直接写入 color，NV12/NV21 只写亮度平面。
+ */
+
+namespace
+{
+    enum
+    {
+        glyph_rows = 7,
+    };
+
+    // 按 plate_vocab 顺序的数字和字母，每行低 5 位，最高位在左
+    const unsigned char font_5x7[plate_vocab::size - plate_vocab::first_digit][glyph_rows] = {
+        {0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E}, // 0
+        {0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E}, // 1
+        {0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F}, // 2
+        {0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E}, // 3
+        {0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02}, // 4
+        {0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E}, // 5
+        {0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E}, // 6
+        {0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08}, // 7
+        {0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E}, // 8
+        {0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C}, // 9
+        {0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}, // A
+        {0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E}, // B
+        {0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E}, // C
+        {0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C}, // D
+        {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F}, // E
+        {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10}, // F
+        {0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F}, // G
+        {0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}, // H
+        {0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C}, // J
+        {0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11}, // K
+        {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F}, // L
+        {0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11}, // M
+        {0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11}, // N
+        {0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10}, // P
+        {0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D}, // Q
+        {0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11}, // R
+        {0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E}, // S
+        {0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04}, // T
+        {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}, // U
+        {0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04}, // V
+        {0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A}, // W
+        {0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11}, // X
+        {0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04}, // Y
+        {0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F}, // Z
+    };
+
+    // 取字形第 row 行，返回宽度(点数)
+    int glyph_row(int id, int row, unsigned int *bits)
+    {
+        if (id >= plate_vocab::first_digit)
+        {
+            *bits = font_5x7[id - plate_vocab::first_digit][row];
+            return 5;
+        }
+        // 省份：外框加上由编号决定的内部图案，不同省份可以区分
+        if (row == 0 || row == glyph_rows - 1)
+        {
+            *bits = 0x7F;
+        }
+        else
+        {
+            unsigned int h = (unsigned int)(id + 1) * 2654435761u >> (row * 4);
+            *bits = 0x41 | ((h & 0x1F) << 1);
+        }
+        return 7;
+    }
+
+    void fill_dot(ax_image_t *image, int x0, int y0, int size, unsigned char color[3])
+    {
+        int stride = image->tStride_W > 0 ? image->tStride_W : (int)image->nWidth;
+        bool yuv = image->eDtype == ax_color_space_nv12 || image->eDtype == ax_color_space_nv21;
+        unsigned char y_value = (color[0] + 2 * color[1] + color[2]) >> 2;
+        unsigned char *base = (unsigned char *)image->pVir;
+        for (int y = y0 < 0 ? 0 : y0; y < y0 + size && y < (int)image->nHeight; y++)
+        {
+            for (int x = x0 < 0 ? 0 : x0; x < x0 + size && x < (int)image->nWidth; x++)
+            {
+                if (yuv)
+                {
+                    base[(size_t)y * stride + x] = y_value;
+                }
+                else
+                {
+                    unsigned char *p = base + ((size_t)y * stride + x) * 3;
+                    p[0] = color[0];
+                    p[1] = color[1];
+                    p[2] = color[2];
+                }
+            }
+        }
+    }
+}
+
+extern "C"
+{
+    void putTextPlateID(ax_image_t *image, int *text_ids, int text_num, ax_point_t *org, unsigned char color[3], float fontScale)
+    {
+        if (image == nullptr || image->pVir == nullptr || text_ids == nullptr || org == nullptr || color == nullptr)
+        {
+            return;
+        }
+        int dot = (int)lroundf(3 * fontScale);
+        dot = dot < 1 ? 1 : dot;
+        int x = (int)org->x;
+        int top = (int)org->y - glyph_rows * dot;
+        for (int i = 0; i < text_num; i++)
+        {
+            int id = text_ids[i];
+            if (id < 0 || id >= plate_vocab::size)
+            {
+                continue;
+            }
+            int width = 0;
+            for (int row = 0; row < glyph_rows; row++)
+            {
+                unsigned int bits;
+                width = glyph_row(id, row, &bits);
+                for (int col = 0; col < width; col++)
+                {
+                    if (bits & (1u << (width - 1 - col)))
+                    {
+                        fill_dot(image, x + col * dot, top + row * dot, dot, color);
+                    }
+                }
+            }
+            x += (width + 1) * dot;
+        }
+    }
+
+    void putTextPlateStr(ax_image_t *image, char *text, ax_point_t *org, unsigned char color[3], float fontScale)
+    {
+        if (text == nullptr)
+        {
+            return;
+        }
+        std::vector<int> ids;
+        const char *p = text;
+        while (*p)
+        {
+            int id = plate_vocab::next_id(p);
+            if (id >= 0)
+            {
+                ids.push_back(id);
+            }
+        }
+        putTextPlateID(image, ids.data(), ids.size(), org, color, fontScale);
+    }
+}